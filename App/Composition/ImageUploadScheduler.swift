@@ -0,0 +1,181 @@
+//  ImageUploadScheduler.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import Foundation
+import os
+
+private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category: "ImageUploadScheduler")
+
+/**
+ Uploads a batch of images a few at a time, keeping one more image on the go than are allowed to upload at once so the next image is saved and resized while the others are sending.
+
+ How many upload at once adapts as the batch goes: it starts at two, grows by one after each quick upload (up to `maximumConcurrentUploads`), and halves after a slow one.
+
+ Imgur only allows so many uploads. Tell the scheduler how many are left with `updateRemainingUploads(_:)`, and it picks up more as uploads finish. If there aren't enough left for the rest of the batch, the batch fails without using any more.
+
+ The first error, or cancelling `progress`, fails the batch straight away and cancels whatever is still going.
+ */
+final class ImageUploadScheduler<Source> {
+
+    struct Uploaded {
+        let url: URL
+
+        /// How many more uploads Imgur will allow, if it said.
+        let remainingUploads: Int?
+    }
+
+    /// Starts uploading `source`, calls `didStartSending` (on any queue) once it's saved, resized, and actually going over the network, calls `completion` (on any queue) when done, and returns a cancellable progress that follows the upload.
+    typealias Upload = (_ source: Source, _ didStartSending: @escaping () -> Void, _ completion: @escaping (Result<Uploaded, Error>) -> Void) -> Progress
+
+    /// Covers the whole batch. Cancel it to cancel the batch.
+    let progress: Progress
+
+    /// One per source, in order, each following its image as it's sent.
+    let imageProgress: [Progress]
+
+    var maximumConcurrentUploads = 4
+
+    /// Uploads that take longer than this to send halve how many can upload at once. Saving, resizing, and waiting for a turn to send don't count.
+    var slowUploadDuration: TimeInterval = 15
+
+    private let sources: [Source]
+    private let upload: Upload
+    private let setConcurrentUploads: (Int) -> Void
+    private let queue = DispatchQueue(label: "com.awfulapp.Awful.ImageUploadScheduler")
+
+    // Only touched on `queue`.
+    private var completion: ((Result<[URL], Error>) -> Void)?
+    private var nextIndex = 0
+    private var inFlight: Set<Int> = []
+    private var sendDates: [Int: Date] = [:]
+    private var urls: [URL?]
+    private var concurrentUploads = 2
+    private var remainingUploads: Int?
+
+    /**
+     - Parameter upload: Uploads one image.
+     - Parameter setConcurrentUploads: Called whenever the number of images allowed to upload at once changes. Images past that number should still be saved and resized.
+     */
+    init(sources: [Source], upload: @escaping Upload, setConcurrentUploads: @escaping (Int) -> Void = { _ in }) {
+        self.sources = sources
+        self.upload = upload
+        self.setConcurrentUploads = setConcurrentUploads
+        urls = Array(repeating: nil, count: sources.count)
+
+        progress = Progress(totalUnitCount: Int64(sources.count))
+        imageProgress = sources.map { _ in Progress(totalUnitCount: 1) }
+        for child in imageProgress {
+            progress.addChild(child, withPendingUnitCount: 1)
+        }
+        progress.cancellationHandler = { [weak self] in
+            self?.queue.async {
+                self?.fail(CocoaError(.userCancelled))
+            }
+        }
+    }
+
+    /// - Parameter completion: Called once, on an arbitrary queue, with every uploaded URL in the same order as the sources.
+    func start(completion: @escaping (Result<[URL], Error>) -> Void) {
+        queue.async {
+            guard !self.progress.isCancelled else {
+                return completion(.failure(CocoaError(.userCancelled)))
+            }
+            guard !self.sources.isEmpty else {
+                return completion(.success([]))
+            }
+            self.completion = completion
+            self.startMore()
+        }
+    }
+
+    /// Tells the scheduler how many uploads Imgur will allow right now, e.g. after checking the rate limit.
+    func updateRemainingUploads(_ remaining: Int) {
+        queue.async {
+            self.remainingUploads = remaining
+            self.startMore()
+        }
+    }
+
+    private func startMore() {
+        guard completion != nil else { return }
+
+        if let remaining = remainingUploads {
+            let unstarted = sources.count - nextIndex
+            if remaining - inFlight.count < unstarted {
+                logger.error("only \(remaining) uploads left, not enough for \(unstarted) more images")
+                return fail(ImageUploadError.rateLimited)
+            }
+        }
+
+        let limit = max(1, min(concurrentUploads, maximumConcurrentUploads))
+        setConcurrentUploads(limit)
+
+        while nextIndex < sources.count, inFlight.count < limit + 1 {
+            let index = nextIndex
+            nextIndex += 1
+            inFlight.insert(index)
+
+            let uploadProgress = upload(sources[index], {
+                let now = Date()
+                self.queue.async {
+                    if self.inFlight.contains(index) {
+                        self.sendDates[index] = now
+                    }
+                }
+            }, { result in
+                self.queue.async {
+                    self.didFinishUpload(at: index, result)
+                }
+            })
+            imageProgress[index].addChild(uploadProgress, withPendingUnitCount: 1)
+        }
+    }
+
+    private func didFinishUpload(at index: Int, _ result: Result<Uploaded, Error>) {
+        guard completion != nil, inFlight.remove(index) != nil else { return }
+        let sendDate = sendDates.removeValue(forKey: index)
+
+        switch result {
+        case .success(let uploaded):
+            urls[index] = uploaded.url
+            if let remaining = uploaded.remainingUploads {
+                remainingUploads = remaining
+            }
+
+            // Without knowing when it started sending, there's nothing to go on.
+            if let sendDate {
+                let duration = Date().timeIntervalSince(sendDate)
+                if duration > slowUploadDuration {
+                    concurrentUploads = max(1, concurrentUploads / 2)
+                } else {
+                    concurrentUploads = min(concurrentUploads + 1, maximumConcurrentUploads)
+                }
+                logger.debug("sent image \(index) in \(duration)s, now uploading up to \(self.concurrentUploads) at once")
+            }
+
+            if nextIndex == sources.count, inFlight.isEmpty {
+                let completion = self.completion
+                self.completion = nil
+                completion?(.success(urls.compactMap { $0 }))
+            } else {
+                startMore()
+            }
+
+        case .failure(let error):
+            fail(error)
+        }
+    }
+
+    private func fail(_ error: Error) {
+        guard let completion = completion else { return }
+        self.completion = nil
+
+        for child in imageProgress where !child.isCancelled {
+            child.cancel()
+        }
+        inFlight.removeAll()
+        sendDates.removeAll()
+        completion(.failure(error))
+    }
+}
@@ -0,0 +1,143 @@
+//  SmilieSearchIndex.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import Foundation
+
+/**
+ Finds smilies by their text (e.g. `:rolleyes:`) or summary, ignoring case, diacritics, and the colons around the text, without a trip to Core Data.
+
+ Text and summaries are split into trigrams up front, so a search only has to check the smilies that have every trigram in the query. Queries shorter than a trigram check every smilie, which is still quick for the thousand or so there are.
+
+ Results are ranked: text matches come before summary matches, and matches at the start come before matches in the middle. Ties go to the shorter text.
+ */
+struct SmilieSearchIndex<Item> {
+
+    private struct Entry {
+        let item: Item
+        let originalText: String
+        let text: String
+        let summary: String
+    }
+
+    private let entries: [Entry]
+
+    /// Sorted indices into `entries` of everything containing each trigram.
+    private let postings: [UInt64: [Int]]
+
+    /**
+     - Parameter items: Smilies in the order they should appear when all else is equal. Only the first item with any given text is kept.
+     */
+    init<S: Sequence>(_ items: S, text: (Item) -> String, summary: (Item) -> String?) where S.Element == Item {
+        var seen: Set<String> = []
+        var entries: [Entry] = []
+        var postings: [UInt64: [Int]] = [:]
+        for item in items {
+            let originalText = text(item)
+            guard seen.insert(originalText).inserted else { continue }
+
+            let entry = Entry(
+                item: item,
+                originalText: originalText,
+                text: normalizeText(originalText),
+                summary: normalize(summary(item) ?? ""))
+            let index = entries.count
+            for trigram in trigrams(entry.text).union(trigrams(entry.summary)) {
+                postings[trigram, default: []].append(index)
+            }
+            entries.append(entry)
+        }
+        self.entries = entries
+        self.postings = postings
+    }
+
+    var count: Int { entries.count }
+
+    func search(_ query: String) -> [Item] {
+        let folded = normalize(query)
+        guard !folded.isEmpty else { return [] }
+
+        let query = normalizeText(folded)
+        guard !query.isEmpty else {
+            // Nothing but colons, which is how most smilie text starts.
+            return entries
+                .filter { $0.originalText.contains(folded) }
+                .sorted { ($0.originalText.count, $0.originalText) < ($1.originalText.count, $1.originalText) }
+                .map(\.item)
+        }
+
+        var ranked: [(rank: Int, entry: Entry)] = []
+        for index in candidates(for: query) {
+            let entry = entries[index]
+            if let rank = rank(entry, query: query) {
+                ranked.append((rank, entry))
+            }
+        }
+        ranked.sort { ($0.rank, $0.entry.text.count, $0.entry.originalText) < ($1.rank, $1.entry.text.count, $1.entry.originalText) }
+        return ranked.map(\.entry.item)
+    }
+
+    private func candidates(for query: String) -> [Int] {
+        let queryTrigrams = trigrams(query)
+        guard !queryTrigrams.isEmpty else { return Array(entries.indices) }
+
+        var lists: [[Int]] = []
+        for trigram in queryTrigrams {
+            guard let list = postings[trigram] else { return [] }
+            lists.append(list)
+        }
+        lists.sort { $0.count < $1.count }
+
+        var candidates = lists[0]
+        for list in lists.dropFirst() {
+            candidates = intersect(candidates, list)
+            if candidates.isEmpty { break }
+        }
+        return candidates
+    }
+
+    private func rank(_ entry: Entry, query: String) -> Int? {
+        if entry.text == query { return 0 }
+        if entry.text.hasPrefix(query) { return 1 }
+        if entry.text.contains(query) { return 2 }
+        if entry.summary.hasPrefix(query) || entry.summary.contains(" " + query) { return 3 }
+        if entry.summary.contains(query) { return 4 }
+        return nil
+    }
+}
+
+private func normalize(_ string: String) -> String {
+    string.folding(options: [.caseInsensitive, .diacriticInsensitive, .widthInsensitive], locale: nil)
+}
+
+/// Also trims the colons around smilie text, so searching `roll` ranks `:rolleyes:` as a prefix match.
+private func normalizeText(_ string: String) -> String {
+    normalize(string).trimmingCharacters(in: CharacterSet(charactersIn: ":"))
+}
+
+private func trigrams(_ string: String) -> Set<UInt64> {
+    let scalars = Array(string.unicodeScalars)
+    guard scalars.count >= 3 else { return [] }
+    var trigrams: Set<UInt64> = []
+    for i in 0 ... scalars.count - 3 {
+        trigrams.insert(UInt64(scalars[i].value) << 42 | UInt64(scalars[i + 1].value) << 21 | UInt64(scalars[i + 2].value))
+    }
+    return trigrams
+}
+
+private func intersect(_ a: [Int], _ b: [Int]) -> [Int] {
+    var result: [Int] = []
+    var i = a.startIndex, j = b.startIndex
+    while i < a.endIndex, j < b.endIndex {
+        if a[i] < b[j] {
+            i += 1
+        } else if a[i] > b[j] {
+            j += 1
+        } else {
+            result.append(a[i])
+            i += 1
+            j += 1
+        }
+    }
+    return result
+}
@@ -18,6 +18,7 @@ final class SmilieSearchViewModel: ObservableObject {
     
     private let dataStore: SmilieDataStore
     private var cancellables = Set<AnyCancellable>()
+    private var searchIndex: SmilieSearchIndex<Smilie>?
     
     struct SmilieSection {
         let title: String
@@ -28,18 +29,37 @@ final class SmilieSearchViewModel: ObservableObject {
         self.dataStore = dataStore
         
         setupSearchSubscription()
+        setupRefreshSubscription()
         loadSmilies()
     }
     
     private func setupSearchSubscription() {
+        // Searching the index is quick enough to do on every keystroke.
         $searchText
-            .debounce(for: .milliseconds(300), scheduler: DispatchQueue.main)
             .removeDuplicates()
             .sink { [weak self] searchText in
                 self?.performSearch(searchText)
             }
             .store(in: &cancellables)
     }
+
+    /// Rebuilds the search index (and the list of all smilies) when smilies get added, removed, or changed, e.g. by a `SmilieScrapeAndInsertNewSmiliesOperation`.
+    private func setupRefreshSubscription() {
+        guard let context = dataStore.managedObjectContext else { return }
+        NotificationCenter.default.publisher(for: .NSManagedObjectContextDidSave, object: context)
+            .filter { notification in
+                let keys = [NSInsertedObjectsKey, NSUpdatedObjectsKey, NSDeletedObjectsKey]
+                return keys.contains { key in
+                    (notification.userInfo?[key] as? Set<NSManagedObject>)?.contains { $0 is Smilie } ?? false
+                }
+            }
+            // Downloading image data saves once per smilie, so wait for a lull.
+            .debounce(for: .milliseconds(500), scheduler: DispatchQueue.main)
+            .sink { [weak self] _ in
+                Task { await self?.loadAllSmilies() }
+            }
+            .store(in: &cancellables)
+    }
     
     func loadSmilies() {
         Task {
@@ -149,8 +169,12 @@ final class SmilieSearchViewModel: ObservableObject {
                     return SmilieSection(title: sectionTitle, smilies: sortedSmilies)
                 }
                 
+                let index = SmilieSearchIndex(deduplicatedSmilies, text: { $0.text ?? "" }, summary: { $0.summary })
+                
                 Task { @MainActor in
                     self.allSmilies = sections
+                    self.searchIndex = index
+                    self.performSearch(self.searchText)
                 }
             } catch {
                 print("Error fetching all smilies: \(error)")
@@ -159,40 +183,12 @@ final class SmilieSearchViewModel: ObservableObject {
     }
     
     private func performSearch(_ searchText: String) {
-        guard !searchText.isEmpty else {
+        guard !searchText.isEmpty, let searchIndex else {
+            // Anything typed before the index is ready gets searched once it's built.
             searchResults = []
             return
         }
-        
-        Task {
-            guard let context = dataStore.managedObjectContext else { return }
-            await context.perform { [weak self] in
-                guard let self = self else { return }
-                
-                let fetchRequest = NSFetchRequest<Smilie>(entityName: "Smilie")
-                fetchRequest.predicate = NSPredicate(
-                    format: "text CONTAINS[cd] %@ OR summary CONTAINS[cd] %@",
-                    searchText, searchText
-                )
-                fetchRequest.sortDescriptors = [
-                    NSSortDescriptor(keyPath: \Smilie.text, ascending: true)
-                ]
-                fetchRequest.returnsObjectsAsFaults = false
-                
-                do {
-                    let results = try context.fetch(fetchRequest)
-                    
-                    Task { @MainActor in
-                        self.searchResults = results
-                    }
-                } catch {
-                    print("Error searching smilies: \(error)")
-                    Task { @MainActor in
-                        self.searchResults = []
-                    }
-                }
-            }
-        }
+        searchResults = searchIndex.search(searchText)
     }
     
     func updateLastUsedDate(for smilie: Smilie) {
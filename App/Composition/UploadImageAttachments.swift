@@ -12,29 +12,29 @@ import UIKit
 private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category: "UploadImageAttachments")
 
 enum ImageUploadError: Error, LocalizedError {
-    case missingIdentifiedAsset
     case authenticationRequired
     case authenticationFailed
+    case rateLimited
     
     var errorDescription: String? {
         switch self {
-        case .missingIdentifiedAsset:
-            return "Missing photo asset"
         case .authenticationRequired:
             return "Imgur Authentication Required"
         case .authenticationFailed:
             return "Imgur Authentication Failed"
+        case .rateLimited:
+            return "Imgur Upload Limit Reached"
         }
     }
     
     var failureReason: String? {
         switch self {
-        case .missingIdentifiedAsset:
-            return "Could not find the photo in your library."
         case .authenticationRequired:
             return "You need to log in to Imgur to upload images with your account."
         case .authenticationFailed:
             return "Could not log in to Imgur. Please try again or switch to anonymous uploads in settings."
+        case .rateLimited:
+            return "Imgur won't take this many images right now. Please try again later, or with fewer images."
         }
     }
 }
@@ -105,73 +105,61 @@ func uploadImages(attachedTo richText: NSAttributedString, completion: @escaping
     return progress
 }
 
+/// Uploads a few images at a time (see `ImageUploadScheduler`), keeping under Imgur's rate limit.
 private func uploadImages(fromSources sources: [ImageTag.Source], completion: @escaping (_ urls: [URL]?, _ error: Error?) -> Void) -> Progress {
-    let progress = Progress(totalUnitCount: Int64(sources.count))
-    
-    let group = DispatchGroup()
-    
-    var urls: [URL?] = Array(repeating: nil, count: sources.count)
-    for (i, source) in sources.enumerated() {
-        group.enter()
-        
-        func uploadComplete(_ url: URL?, error: Error?) {
-            defer { group.leave() }
-            
-            if let error = error {
-                if !progress.isCancelled { progress.cancel() }
-                return DispatchQueue.main.async {
-                    completion(nil, error)
-                }
+    let uploader = ImgurUploader.shared
+    let batch = ImgurUploader.UploadBatch()
+    let scheduler = ImageUploadScheduler(sources: sources, upload: { source, didStartSending, done in
+        let handleResult = { (result: ImgurUploader.Result<ImgurUploader.UploadResponse>) in
+            switch result {
+            case .success(let response):
+                done(.success(.init(
+                    url: response.link,
+                    remainingUploads: remainingUploads(response.postLimit, response.rateLimit))))
+            case .failure(let error):
+                logger.error("Could not upload \(String(describing: source)): \(error)")
+                done(.failure(error))
             }
-            
-            guard let url = url else { fatalError("no error should mean a URL!") }
-            urls[i] = url
         }
-        
-        progress.becomeCurrent(withPendingUnitCount: 1)
-        
+
         switch source {
         case .image(let image):
-            ImgurUploader.shared.upload(image, completion: { result in
-                switch result {
-                case .success(let response):
-                    uploadComplete(response.link, error: nil)
-                case .failure(let error):
-                    logger.error("Could not upload UIImage: \(error)")
-                    uploadComplete(nil, error: error)
+            return uploader.upload(image, batch: batch, willSend: didStartSending, completion: handleResult)
+        case .photoAsset(let asset):
+            return uploader.upload(asset, batch: batch, willSend: didStartSending, completion: handleResult)
+        }
+    }, setConcurrentUploads: { batch.maximumConcurrentUploads = $0 })
+
+    if sources.count > 1 {
+        // Doesn't use up any uploads. If it comes back after the batch is done, it's ignored.
+        uploader.checkRateLimitStatus { result in
+            switch result {
+            case .success(let rateLimit):
+                if let remaining = remainingUploads(nil, rateLimit) {
+                    scheduler.updateRemainingUploads(remaining)
                 }
-            })
-            
-        case .photoAsset(let assetIdentifier):
-            guard let asset = PHAsset.fetchAssets(withLocalIdentifiers: [assetIdentifier], options: nil).firstObject else {
-                logger.error("Could not find asset corresponding to local identifier \(assetIdentifier)")
-                uploadComplete(nil, error: ImageUploadError.missingIdentifiedAsset)
-                break
+            case .failure(let error):
+                logger.warning("Could not check Imgur rate limit, uploading anyway: \(error)")
             }
-            
-            ImgurUploader.shared.upload(asset, completion: { result in
-                switch result {
-                case .success(let response):
-                    uploadComplete(response.link, error: nil)
-                case .failure(let error):
-                    logger.error("Could not upload PHAsset: \(error)")
-                    uploadComplete(nil, error: error)
-                }
-            })
         }
-        
-        progress.resignCurrent()
     }
-    
-    group.notify(queue: DispatchQueue.global(qos: DispatchQoS.QoSClass.default)) { 
-        if progress.isCancelled {
-            completion(nil, NSError(domain: NSCocoaErrorDomain, code: NSUserCancelledError, userInfo: nil))
-        } else {
-            completion(urls.compactMap { $0 }, nil)
+
+    scheduler.start { result in
+        switch result {
+        case .success(let urls):
+            completion(urls, nil)
+        case .failure(let error):
+            completion(nil, error)
         }
     }
-    
-    return progress
+
+    return scheduler.progress
+}
+
+private func remainingUploads(_ postLimit: ImgurUploader.PostLimit?, _ rateLimit: ImgurUploader.RateLimit?) -> Int? {
+    return [postLimit?.remaining, rateLimit?.userRemaining, rateLimit?.clientRemaining]
+        .compactMap { $0 }
+        .min()
 }
 
 private struct ImageTag {
@@ -181,7 +169,7 @@ private struct ImageTag {
     
     enum Source {
         case image(UIImage)
-        case photoAsset(String)
+        case photoAsset(PHAsset)
     }
     
     init(_ attachment: TextAttachment, range: NSRange) {
@@ -191,7 +179,7 @@ private struct ImageTag {
             let assetIdentifier = attachment.photoAssetIdentifier,
             let asset = PHAsset.fetchAssets(withLocalIdentifiers: [assetIdentifier], options: nil).firstObject
         {
-            source = .photoAsset(assetIdentifier)
+            source = .photoAsset(asset)
             size = CGSize(width: asset.pixelWidth, height: asset.pixelHeight)
         } else if let image = attachment.image {
             source = .image(image)
@@ -22,41 +22,51 @@ extension HTMLDocument {
     /// Finds links that appear to be to Bluesky posts and adds a `data-bluesky-post` attribute to those links.
     func addAttributeToBlueskyLinks() {
         for a in nodes(matchingParsedSelector: .cached("a[href *= 'bsky.app']")) {
-            guard let href = a["href"],
-                  let url = URL(string: href),
-                  url.host?.caseInsensitiveCompare("bsky.app") == .orderedSame,
-                  url.pathComponents.contains(where: { $0.caseInsensitiveCompare("post") == .orderedSame }),
-                  a.textContent.hasPrefix("https:") // approximate raw-link check
-            else { continue }
-            a["data-bluesky-post"] = ""
+            Self.addAttributeToBlueskyLink(a)
         }
     }
 
+    static func addAttributeToBlueskyLink(_ a: HTMLElement) {
+        guard let href = a["href"],
+              href.contains("bsky.app"),
+              let url = URL(string: href),
+              url.host?.caseInsensitiveCompare("bsky.app") == .orderedSame,
+              url.pathComponents.contains(where: { $0.caseInsensitiveCompare("post") == .orderedSame }),
+              a.textContent.hasPrefix("https:") // approximate raw-link check
+        else { return }
+        a["data-bluesky-post"] = ""
+    }
+
     /// Finds links that appear to be to tweets and adds a `data-tweet-id` attribute to those links.
     func addAttributeToTweetLinks() {
         for a in nodes(matchingParsedSelector: .cached("a[href *= 'twitter.com'], a[href *= 'x.com']")) {
-            guard
-                let href = a["href"],
-                let url = URL(string: href),
-                let host = url.host,
-                (host.lowercased().hasSuffix("twitter.com") ||
-                 host.lowercased().hasSuffix(".x.com") ||
-                 host.lowercased() == "x.com") &&
-                a.textContent.hasPrefix("https:") // approximate raw-link check
-                else { continue }
-            
-            let pathComponents = url.pathComponents
-            guard
-                pathComponents.count >= 4,
-                pathComponents[2].lowercased().hasPrefix("status")
-                else { continue }
-            
-            let id = pathComponents[3]
-            guard id.unicodeScalars.allSatisfy(CharacterSet.decimalDigits.contains) else { continue }
-            
-            a["data-tweet-id"] = id
+            Self.addAttributeToTweetLink(a)
         }
     }
+
+    static func addAttributeToTweetLink(_ a: HTMLElement) {
+        guard
+            let href = a["href"],
+            href.contains("twitter.com") || href.contains("x.com"),
+            let url = URL(string: href),
+            let host = url.host,
+            (host.lowercased().hasSuffix("twitter.com") ||
+             host.lowercased().hasSuffix(".x.com") ||
+             host.lowercased() == "x.com") &&
+            a.textContent.hasPrefix("https:") // approximate raw-link check
+            else { return }
+
+        let pathComponents = url.pathComponents
+        guard
+            pathComponents.count >= 4,
+            pathComponents[2].lowercased().hasPrefix("status")
+            else { return }
+
+        let id = pathComponents[3]
+        guard id.unicodeScalars.allSatisfy(CharacterSet.decimalDigits.contains) else { return }
+
+        a["data-tweet-id"] = id
+    }
     
     /**
      Modifies the document in place, adding an additional class to quote blocks if the quoted post ID ends in 420.
@@ -68,13 +78,23 @@ extension HTMLDocument {
             h4.toggleClass("magic_cake")
         }
     }
+
+    static func isMagicCakeQuoteLink(_ element: HTMLElement) -> Bool {
+        return element.hasClass("quote_link") && element["href"]?.hasSuffix("420") == true
+    }
     
     /**
      Modifies the document in place, wrapping any occurrences of `username` in a post body within a `<span class="mention">` element. Additionally, if `isHighlighted` is `true`, the class `highlight` is added to the wrapping span elements.
      */
     func identifyMentionsOfUser(named username: String, shouldHighlight isHighlighted: Bool) {
         guard let body = bodyElement else { return }
-        
+
+        let textNodes = body.treeEnumerator().compactMap { $0 as? HTMLTextNode }
+        Self.identifyMentionsOfUser(named: username, shouldHighlight: isHighlighted, in: textNodes)
+    }
+
+    /// Like `identifyMentionsOfUser(named:shouldHighlight:)` but only looks at `textNodes`.
+    static func identifyMentionsOfUser(named username: String, shouldHighlight isHighlighted: Bool, in textNodes: [HTMLTextNode]) {
         let escapedUsername = NSRegularExpression.escapedPattern(for: username)
         let regex = try! NSRegularExpression(
             // Since usernames can contain what a regex thinks of as non-word characters, searching on word boundaries (`\b`) doesn't quite cut it for us. We also want to consider the start/end of the string, and beginning/ending on whitespace.
@@ -86,11 +106,7 @@ extension HTMLDocument {
         let classAttribute = "mention" + (isHighlighted ? " highlight" : "")
         
         var matches: [(HTMLTextNode, [NSTextCheckingResult])] = []
-        for node in body.treeEnumerator() {
-            guard let textNode = node as? HTMLTextNode else {
-                continue
-            }
-            
+        for textNode in textNodes {
             let results = regex.matches(in: textNode.data, range: NSRange(textNode.data.startIndex..., in: textNode.data))
             if !results.isEmpty {
                 matches.append((textNode, results))
@@ -131,8 +147,13 @@ extension HTMLDocument {
      Modifies the document in place, adding the `mention` class to the header above a quote if it says "username posted:". If `shouldHighlight` is `true`, also adds the `highlight` class.
      */
     func identifyQuotesCitingUser(named username: String, shouldHighlight isHighlighted: Bool) {
+        Self.identifyQuotesCitingUser(named: username, shouldHighlight: isHighlighted, in: nodes(matchingParsedSelector: .cached(".bbc-block h4")))
+    }
+
+    /// Like `identifyQuotesCitingUser(named:shouldHighlight:)` but only looks at `quoteHeaders`, which must be `h4` elements inside a `.bbc-block`.
+    static func identifyQuotesCitingUser(named username: String, shouldHighlight isHighlighted: Bool, in quoteHeaders: [HTMLElement]) {
         let loggedInUserPosted = "\(username) posted:"
-        for h4 in nodes(matchingParsedSelector: .cached(".bbc-block h4")) where h4.textContent == loggedInUserPosted {
+        for h4 in quoteHeaders where h4.textContent == loggedInUserPosted {
             var block = h4.parentElement
             while let next = block, !next.hasClass("bbc-block") {
                 block = next.parentElement
@@ -152,28 +173,40 @@ extension HTMLDocument {
      - Adds .awful-smile to smilie elements.
      - Rewrites URLs for some external image hosts that have changed domains and/or URL schemes.
      - Defers loading of post content images beyond the first 10 (lazy loading).
+     - Points post content images at `DownsampledImageURLSchemeHandler` (if downsampleImages == true), except GIFs. The original URL goes in `data-original-url`.
      */
-    func processImgTags(shouldLinkifyNonSmilies: Bool) {
+    func processImgTags(shouldLinkifyNonSmilies: Bool, downsampleImages: Bool = false) {
+        _ = Self.processImgTags(nodes(matchingParsedSelector: .cached("img")), shouldLinkifyNonSmilies: shouldLinkifyNonSmilies, downsampleImages: downsampleImages)
+    }
+
+    /// Like `processImgTags(shouldLinkifyNonSmilies:downsampleImages:)` but only looks at `imgs`. Returns the `imgs` that are still in the document afterwards.
+    static func processImgTags(_ imgs: [HTMLElement], shouldLinkifyNonSmilies: Bool, downsampleImages: Bool = false) -> [HTMLElement] {
         var postContentImageCount = 0
+        var remaining: [HTMLElement] = []
+        remaining.reserveCapacity(imgs.count)
 
-        for img in nodes(matchingParsedSelector: .cached("img")) {
+        for img in imgs {
             guard
                 let src = img["src"],
                 let url = URL(string: src)
-                else { continue }
+                else {
+                    remaining.append(img)
+                    continue
+                }
 
-            // Handle attachment images by adding a placeholder and data attribute
-            // These will be loaded asynchronously via JavaScript after page load
+            // Attachment images need the logged-in user's cookies, so they're served by AttachmentImageURLSchemeHandler.
             if src.contains("attachment.php") {
                 let attachmentSrc: String
                 if src.hasPrefix("http") {
                     attachmentSrc = src
                 } else if let baseURL = ForumsClient.shared.baseURL {
                     guard let url = URL(string: src, relativeTo: baseURL)?.absoluteString else {
+                        remaining.append(img)
                         continue
                     }
                     attachmentSrc = url
                 } else {
+                    remaining.append(img)
                     continue
                 }
 
@@ -182,12 +215,15 @@ extension HTMLDocument {
                    let attachmentIDItem = urlComponents.queryItems?.first(where: { $0.name == "attachmentid" }),
                    let attachmentID = attachmentIDItem.value {
 
-                    // Mark as attachment image and store the attachmentID for async loading
                     img["data-awful-attachment-id"] = attachmentID
                     img["data-awful-attachment-url"] = attachmentSrc
-                    // Use a placeholder while loading
-                    img["src"] = "data:image/svg+xml,%3Csvg xmlns='http://www.w3.org/2000/svg' width='100' height='100'%3E%3Crect fill='%23ddd' width='100' height='100'/%3E%3Ctext x='50%25' y='50%25' dominant-baseline='middle' text-anchor='middle' fill='%23999' font-family='sans-serif' font-size='14'%3ELoading...%3C/text%3E%3C/svg%3E"
+                    if let schemeURL = AttachmentImageURLSchemeHandler.url(forAttachmentID: attachmentID) {
+                        // Only the web view can load the scheme URL, so long-press, copy, and share get the real one.
+                        img["data-original-url"] = attachmentSrc
+                        img["src"] = schemeURL.absoluteString
+                    }
                 }
+                remaining.append(img)
                 continue
             }
 
@@ -234,6 +270,16 @@ extension HTMLDocument {
                         // Load immediately
                         img["src"] = finalURL
                     }
+
+                    // Downsampling would stop GIFs animating. Linkified images show their URL, so leave those be too.
+                    if downsampleImages, !shouldLinkifyNonSmilies,
+                       let originalURL = URL(string: finalURL),
+                       originalURL.pathExtension.lowercased() != "gif",
+                       let downsampledURL = DownsampledImageURLSchemeHandler.url(forImageURL: originalURL)
+                    {
+                        img["data-original-url"] = finalURL
+                        img["src"] = downsampledURL.absoluteString
+                    }
                 } else {
                     // Avatars, attachments, and data URIs always load immediately
                     img["src"] = finalURL
@@ -246,37 +292,72 @@ extension HTMLDocument {
                 // Use the updated src attribute after any URL fixes
                 link.textContent = img["src"] ?? src
                 img.parent?.replace(child: img, with: link)
+            } else {
+                remaining.append(img)
             }
         }
+        return remaining
     }
     
+    /**
+     Modifies the document in place, pointing the "reveal ignored post" link at a fragment we can recognize when it's tapped.
+     */
+    func markRevealIgnoredPostLink() {
+        guard let link = firstNode(matchingParsedSelector: .cached("a[title=\"DON'T DO IT!!\"]")) else { return }
+        Self.markRevealIgnoredPostLink(link)
+    }
+
+    static func markRevealIgnoredPostLink(_ link: HTMLElement) {
+        guard
+            let href = link["href"],
+            var components = URLComponents(string: href)
+            else { return }
+        components.fragment = "awful-ignored"
+        guard let replacement = components.url?.absoluteString else { return }
+        link["href"] = replacement
+    }
+
     /**
      Modifies the document in place, deleting all elements with the `editedby` class that have no text content.
      */
     func removeEmptyEditedByParagraphs() {
-        for p in nodes(matchingParsedSelector: .cached("p.editedby")) {
-            if p.textContent.trimmingCharacters(in: .whitespacesAndNewlines).isEmpty {
-                p.removeFromParentNode()
-            }
+        for p in nodes(matchingParsedSelector: .cached("p.editedby")) where Self.isEmptyEditedByParagraph(p) {
+            p.removeFromParentNode()
         }
     }
+
+    static func isEmptyEditedByParagraph(_ element: HTMLElement) -> Bool {
+        return element.tagName == "p"
+            && element.hasClass("editedby")
+            && element.textContent.trimmingCharacters(in: .whitespacesAndNewlines).isEmpty
+    }
     
     /**
      Modifies the document in place, removing the `style`, `onmouseover`, and `onmouseout` attributes from `bbc-spoiler` spans.
      */
     func removeSpoilerStylingAndEvents() {
         for element in nodes(matchingParsedSelector: .cached("span.bbc-spoiler")) {
-            element.removeAttribute(withName: "onmouseover")
-            element.removeAttribute(withName: "onmouseout")
-            element.removeAttribute(withName: "style")
+            Self.removeSpoilerStylingAndEvents(element)
         }
     }
+
+    static func removeSpoilerStylingAndEvents(_ element: HTMLElement) {
+        element.removeAttribute(withName: "onmouseover")
+        element.removeAttribute(withName: "onmouseout")
+        element.removeAttribute(withName: "style")
+    }
     
     /**
      Modifies the document in place to stop GIFs at various hosts from autoplaying.
      */
     func stopGIFAutoplay() {
-        for img in nodes(matchingParsedSelector: .cached("img")) {
+        _ = Self.stopGIFAutoplay(nodes(matchingParsedSelector: .cached("img")))
+    }
+
+    /// Like `stopGIFAutoplay()` but only looks at `imgs`. Returns any links it added to the document.
+    static func stopGIFAutoplay(_ imgs: [HTMLElement]) -> [HTMLElement] {
+        var addedLinks: [HTMLElement] = []
+        for img in imgs {
             guard
                 let src = img["src"],
                 let url = URL(string: src),
@@ -322,19 +403,27 @@ extension HTMLDocument {
                 let link = HTMLElement(tagName: "a", attributes: ["href": linkTarget.absoluteString])
                 link.textContent = linkTarget.absoluteString
                 imgSiblings.insert(link, at: imgSiblings.index(of: img))
+                addedLinks.append(link)
             }
             
             imgSiblings.replaceObject(at: imgSiblings.index(of: img), with: wrapper)
         }
+        return addedLinks
     }
     
     /**
      Modifies the document in place, replacing Flash-based Vimeo players with HTML5-based players.
      */
     func useHTML5VimeoPlayer() {
-        for param in nodes(matchingParsedSelector: .cached("div.bbcode_video object param[name='movie'][value*='://vimeo.com/']")) {
+        Self.useHTML5VimeoPlayer(nodes(matchingParsedSelector: .cached("div.bbcode_video object param[name='movie'][value*='://vimeo.com/']")))
+    }
+
+    /// Like `useHTML5VimeoPlayer()` but only looks at `params`, which should be `param[name='movie']` elements.
+    static func useHTML5VimeoPlayer(_ params: [HTMLElement]) {
+        for param in params {
             guard
                 let value = param["value"],
+                value.contains("://vimeo.com/"),
                 let sourceURL = URL(string: value),
                 let clipID = sourceURL.valueForFirstQueryItem(named: "clip_id"),
                 let object = param.parentElement,
@@ -383,13 +472,18 @@ extension HTMLDocument {
     }
 
     func embedVideos() {
-        for a in nodes(matchingParsedSelector: .cached("a")) {
+        Self.embedVideos(nodes(matchingParsedSelector: .cached("a")), isNWS: { containingPostIsNWS(node: $0) })
+    }
+
+    /// Like `embedVideos()` but only looks at `links`. `isNWS` says whether a link is in a post that has an NWS smilie.
+    static func embedVideos(_ links: [HTMLElement], isNWS: (HTMLElement) -> Bool) {
+        for a in links {
             if let href = a["href"],
                let url = URL(string: href),
                let host = url.host
             {
                 // don't expand if the post has an NWS smilie
-                if containingPostIsNWS(node: a) {
+                if isNWS(a) {
                     continue
                 }
                 let lowerHost = host.lowercased()
@@ -467,14 +561,22 @@ extension HTMLDocument {
      Replaces video-embed elements with plain links to the underlying URL. Pair with skipping `embedVideos()` and `useHTML5VimeoPlayer()` to honour a "don't embed videos" preference.
      */
     func linkifyResidualVideoEmbeds() {
-        for iframe in nodes(matchingParsedSelector: .cached("iframe[src]")) {
+        Self.linkifyResidualVideoEmbeds(
+            iframes: nodes(matchingParsedSelector: .cached("iframe[src]")),
+            videos: nodes(matchingParsedSelector: .cached("video")),
+            params: nodes(matchingParsedSelector: .cached("div.bbcode_video object param[name='movie']")))
+    }
+
+    /// Like `linkifyResidualVideoEmbeds()` but only looks at the passed-in elements. `params` should be `param[name='movie']` elements.
+    static func linkifyResidualVideoEmbeds(iframes: [HTMLElement], videos: [HTMLElement], params: [HTMLElement]) {
+        for iframe in iframes {
             guard let src = iframe["src"], !src.isEmpty else { continue }
             let link = HTMLElement(tagName: "a", attributes: ["href": src])
             link.textContent = src
             iframe.parent?.replace(child: iframe, with: link)
         }
 
-        for video in nodes(matchingParsedSelector: .cached("video")) {
+        for video in videos {
             let src = video["src"] ?? video.firstNode(matchingParsedSelector: .cached("source[src]"))?["src"]
             guard let src, !src.isEmpty else { continue }
             let link = HTMLElement(tagName: "a", attributes: ["href": src])
@@ -482,7 +584,7 @@ extension HTMLDocument {
             video.parent?.replace(child: video, with: link)
         }
 
-        for param in nodes(matchingParsedSelector: .cached("div.bbcode_video object param[name='movie']")) {
+        for param in params {
             guard
                 let value = param["value"],
                 let object = param.parentElement,
@@ -0,0 +1,226 @@
+//  HTMLRewriter.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import HTMLReader
+
+/**
+ Walks a tree of nodes once, depth-first, handing each element to the visitors registered for its tag name and each text node to the text visitors.
+
+ Visitors should only look. Collect what needs changing and change it after `walk(_:)` returns, as changing the tree mid-walk can skip or revisit nodes.
+ */
+struct HTMLTreeWalker {
+
+    enum Decision {
+        case visitChildren
+        case skipChildren
+    }
+
+    /// `ancestors` goes from the walk's root (exclusive) down to the element's parent.
+    typealias ElementVisitor = (_ element: HTMLElement, _ ancestors: [HTMLElement]) -> Decision
+    typealias TextVisitor = (_ textNode: HTMLTextNode, _ ancestors: [HTMLElement]) -> Void
+
+    private var elementVisitors: [String: [ElementVisitor]] = [:]
+    private var everyElementVisitors: [ElementVisitor] = []
+    private var textVisitors: [TextVisitor] = []
+
+    /**
+     - Parameter tagName: A lowercase tag name, or `nil` to visit every element.
+     - Parameter visitor: If any visitor returns `.skipChildren`, the element's descendants are not visited.
+     */
+    mutating func visitElements(named tagName: String?, _ visitor: @escaping ElementVisitor) {
+        if let tagName {
+            elementVisitors[tagName, default: []].append(visitor)
+        } else {
+            everyElementVisitors.append(visitor)
+        }
+    }
+
+    mutating func visitTextNodes(_ visitor: @escaping TextVisitor) {
+        textVisitors.append(visitor)
+    }
+
+    /// Visits the descendants of `root`, not including `root` itself.
+    func walk(_ root: HTMLNode) {
+        var ancestors: [HTMLElement] = []
+        walkChildren(of: root, ancestors: &ancestors)
+    }
+
+    private func walkChildren(of node: HTMLNode, ancestors: inout [HTMLElement]) {
+        for case let child as HTMLNode in node.children {
+            if let element = child as? HTMLElement {
+                var decision = Decision.visitChildren
+                for visitor in everyElementVisitors {
+                    if visitor(element, ancestors) == .skipChildren {
+                        decision = .skipChildren
+                    }
+                }
+                for visitor in elementVisitors[element.tagName] ?? [] {
+                    if visitor(element, ancestors) == .skipChildren {
+                        decision = .skipChildren
+                    }
+                }
+
+                if decision == .visitChildren, element.numberOfChildren > 0 {
+                    ancestors.append(element)
+                    walkChildren(of: element, ancestors: &ancestors)
+                    ancestors.removeLast()
+                }
+            } else if let textNode = child as? HTMLTextNode {
+                for visitor in textVisitors {
+                    visitor(textNode, ancestors)
+                }
+            }
+        }
+    }
+}
+
+extension HTMLDocument {
+
+    struct PostBodyRewriteOptions {
+        var embedVideos: Bool
+        var isIgnored: Bool
+        var linkifyNonSmilies: Bool
+        var magicCake: Bool
+        var stopGIFAutoplay: Bool
+        /// The logged-in user, whose quotes and mentions are highlighted.
+        var username: String?
+        var downsampleImages: Bool = false
+    }
+
+    /**
+     Modifies the document in place, rewriting a post body the same way as calling these in order:
+
+     1. `removeSpoilerStylingAndEvents()`
+     2. `removeEmptyEditedByParagraphs()`
+     3. `addAttributeToBlueskyLinks()`
+     4. `addAttributeToTweetLinks()`
+     5. `useHTML5VimeoPlayer()`, if `embedVideos`
+     6. `identifyQuotesCitingUser(named:shouldHighlight:)` and `identifyMentionsOfUser(named:shouldHighlight:)`, if there's a `username`
+     7. `processImgTags(shouldLinkifyNonSmilies:downsampleImages:)`
+     8. `stopGIFAutoplay()`, if `stopGIFAutoplay`
+     9. `markRevealIgnoredPostLink()`, if `isIgnored`
+     10. `addMagicCakeCSS()`, if `magicCake`
+     11. `embedVideos()` if `embedVideos`, otherwise `linkifyResidualVideoEmbeds()`
+
+     Each of those runs its own selector query over the whole document. This finds everything they need in one walk instead.
+     */
+    func rewritePostBody(_ options: PostBodyRewriteOptions) {
+        guard let body = bodyElement else { return }
+
+        var spoilers: [HTMLElement] = []
+        var emptyEditedByParagraphs: [HTMLElement] = []
+        var links: [HTMLElement] = []
+        var revealIgnoredPostLink: HTMLElement?
+        var quoteHeaders: [HTMLElement] = []
+        var textNodes: [HTMLTextNode] = []
+        var imgs: [HTMLElement] = []
+        var magicCakeQuoteLinks: [HTMLElement] = []
+        var iframes: [HTMLElement] = []
+        var videos: [HTMLElement] = []
+        var movieParams: [HTMLElement] = []
+
+        var walker = HTMLTreeWalker()
+        walker.visitElements(named: "span") { span, _ in
+            if span.hasClass("bbc-spoiler") {
+                spoilers.append(span)
+            }
+            return .visitChildren
+        }
+        walker.visitElements(named: "p") { p, _ in
+            // Nothing in here will survive, so no point looking inside.
+            guard Self.isEmptyEditedByParagraph(p) else { return .visitChildren }
+            emptyEditedByParagraphs.append(p)
+            return .skipChildren
+        }
+        walker.visitElements(named: "a") { a, _ in
+            links.append(a)
+            if options.isIgnored, revealIgnoredPostLink == nil, a["title"] == "DON'T DO IT!!" {
+                revealIgnoredPostLink = a
+            }
+            return .visitChildren
+        }
+        walker.visitElements(named: "img") { img, _ in
+            imgs.append(img)
+            return .visitChildren
+        }
+        walker.visitElements(named: "param") { param, _ in
+            if param["name"] == "movie" {
+                movieParams.append(param)
+            }
+            return .visitChildren
+        }
+        if options.username != nil {
+            walker.visitElements(named: "h4") { h4, ancestors in
+                if ancestors.contains(where: { $0.hasClass("bbc-block") }) {
+                    quoteHeaders.append(h4)
+                }
+                return .visitChildren
+            }
+            walker.visitTextNodes { textNode, _ in
+                textNodes.append(textNode)
+            }
+        }
+        if options.magicCake {
+            walker.visitElements(named: nil) { element, _ in
+                if Self.isMagicCakeQuoteLink(element) {
+                    magicCakeQuoteLinks.append(element)
+                }
+                return .visitChildren
+            }
+        }
+        if !options.embedVideos {
+            walker.visitElements(named: "iframe") { iframe, _ in
+                if iframe["src"] != nil {
+                    iframes.append(iframe)
+                }
+                return .visitChildren
+            }
+            walker.visitElements(named: "video") { video, _ in
+                videos.append(video)
+                return .visitChildren
+            }
+        }
+        walker.walk(body)
+
+        for spoiler in spoilers {
+            Self.removeSpoilerStylingAndEvents(spoiler)
+        }
+        for p in emptyEditedByParagraphs {
+            p.removeFromParentNode()
+        }
+        for a in links {
+            Self.addAttributeToBlueskyLink(a)
+            Self.addAttributeToTweetLink(a)
+        }
+        if options.embedVideos {
+            Self.useHTML5VimeoPlayer(movieParams)
+        }
+        if let username = options.username {
+            Self.identifyQuotesCitingUser(named: username, shouldHighlight: true, in: quoteHeaders)
+            Self.identifyMentionsOfUser(named: username, shouldHighlight: true, in: textNodes)
+        }
+        imgs = Self.processImgTags(imgs, shouldLinkifyNonSmilies: options.linkifyNonSmilies, downsampleImages: options.downsampleImages)
+        if options.stopGIFAutoplay {
+            links += Self.stopGIFAutoplay(imgs)
+        }
+        if let revealIgnoredPostLink {
+            Self.markRevealIgnoredPostLink(revealIgnoredPostLink)
+        }
+        for link in magicCakeQuoteLinks {
+            link.toggleClass("magic_cake")
+        }
+        if options.embedVideos {
+            // Only look once the images are done changing, and only if it matters.
+            var bodyIsNWS: Bool?
+            Self.embedVideos(links, isNWS: { _ in
+                if let bodyIsNWS { return bodyIsNWS }
+                let isNWS = body.firstNode(matchingParsedSelector: .cached("img[title=':nws:']")) != nil
+                bodyIsNWS = isNWS
+                return isNWS
+            })
+        } else {
+            Self.linkifyResidualVideoEmbeds(iframes: iframes, videos: videos, params: movieParams)
+        }
+    }
+}
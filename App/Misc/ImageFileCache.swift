@@ -0,0 +1,160 @@
+//  ImageFileCache.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import Foundation
+import ImageIO
+import os
+import UniformTypeIdentifiers
+
+private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category: "ImageFileCache")
+
+/**
+ Images saved in a folder in the caches directory, one file per key.
+
+ Files are written under a temporary name and moved into place once complete, so a partial download is never served. Reading a file marks it as recently used; once the whole lot goes over `byteLimit`, the least recently used files are deleted. Temporary files count towards the limit, and any left behind by a download that never finished (e.g. the app was killed) are deleted.
+
+ Keys become file names, so stick to letters and numbers.
+ */
+final class ImageFileCache {
+    let directory: URL
+    let byteLimit: Int
+
+    private let lock = NSLock()
+    private var bytesWrittenSinceTrim = 0
+
+    init(directoryName: String, byteLimit: Int) {
+        directory = FileManager.default
+            .urls(for: .cachesDirectory, in: .userDomainMask)[0]
+            .appendingPathComponent(directoryName, isDirectory: true)
+        self.byteLimit = byteLimit
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        DispatchQueue.global(qos: .utility).async {
+            self.trim()
+        }
+    }
+
+    private func fileURL(key: String) -> URL {
+        directory.appendingPathComponent(key, isDirectory: false)
+    }
+
+    func cachedImage(key: String) -> (data: Data, mimeType: String)? {
+        let url = fileURL(key: key)
+        guard let data = try? Data(contentsOf: url, options: .mappedIfSafe) else { return nil }
+
+        // Keep recently-viewed images around when trimming.
+        try? FileManager.default.setAttributes([.modificationDate: Date()], ofItemAtPath: url.path)
+
+        let mimeType = CGImageSourceCreateWithData(data as CFData, nil)
+            .flatMap(CGImageSourceGetType)
+            .flatMap { UTType($0 as String)?.preferredMIMEType }
+            ?? "application/octet-stream"
+        return (data, mimeType)
+    }
+
+    func store(_ data: Data, key: String) {
+        guard let writer = makeWriter(key: key) else { return }
+        writer.write(data)
+        writer.commit()
+    }
+
+    func makeWriter(key: String) -> Writer? {
+        let temporaryURL = directory.appendingPathComponent(".\(key)-\(UUID().uuidString)", isDirectory: false)
+        guard FileManager.default.createFile(atPath: temporaryURL.path, contents: nil),
+              let handle = try? FileHandle(forWritingTo: temporaryURL)
+        else { return nil }
+        return Writer(cache: self, handle: handle, temporaryURL: temporaryURL, finalURL: fileURL(key: key))
+    }
+
+    final class Writer {
+        private let cache: ImageFileCache
+        private var handle: FileHandle?
+        private let temporaryURL: URL
+        private let finalURL: URL
+        private var byteCount = 0
+
+        fileprivate init(cache: ImageFileCache, handle: FileHandle, temporaryURL: URL, finalURL: URL) {
+            self.cache = cache
+            self.handle = handle
+            self.temporaryURL = temporaryURL
+            self.finalURL = finalURL
+        }
+
+        func write(_ data: Data) {
+            do {
+                try handle?.write(contentsOf: data)
+                byteCount += data.count
+            } catch {
+                logger.warning("could not save image, will not cache it: \(error)")
+                discard()
+            }
+        }
+
+        func commit() {
+            guard let handle else { return }
+            self.handle = nil
+            do {
+                try handle.close()
+                _ = try FileManager.default.replaceItemAt(finalURL, withItemAt: temporaryURL)
+                cache.didWrite(byteCount)
+            } catch {
+                logger.warning("could not save image: \(error)")
+                try? FileManager.default.removeItem(at: temporaryURL)
+            }
+        }
+
+        /// Does nothing after `commit()`.
+        func discard() {
+            guard let handle else { return }
+            self.handle = nil
+            try? handle.close()
+            try? FileManager.default.removeItem(at: temporaryURL)
+        }
+    }
+
+    /// Trims again once a tenth of the limit has been written since last time, so a long session can't grow the cache much past its limit.
+    private func didWrite(_ byteCount: Int) {
+        lock.lock()
+        bytesWrittenSinceTrim += byteCount
+        let shouldTrim = bytesWrittenSinceTrim > byteLimit / 10
+        if shouldTrim {
+            bytesWrittenSinceTrim = 0
+        }
+        lock.unlock()
+
+        if shouldTrim {
+            DispatchQueue.global(qos: .utility).async {
+                self.trim()
+            }
+        }
+    }
+
+    /// A temporary file that hasn't been written to in this long belongs to a download that's never going to finish.
+    private static let abandonedWriteAge: TimeInterval = 60 * 60
+
+    private func trim() {
+        let keys: Set<URLResourceKey> = [.contentModificationDateKey, .totalFileAllocatedSizeKey]
+        guard let urls = try? FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: Array(keys)) else { return }
+
+        let abandonedCutoff = Date(timeIntervalSinceNow: -Self.abandonedWriteAge)
+        var files = urls.compactMap { url -> (url: URL, date: Date, size: Int)? in
+            guard let values = try? url.resourceValues(forKeys: keys) else { return nil }
+            let date = values.contentModificationDate ?? .distantPast
+            if url.lastPathComponent.hasPrefix("."), date < abandonedCutoff {
+                try? FileManager.default.removeItem(at: url)
+                return nil
+            }
+            return (url, date, values.totalFileAllocatedSize ?? 0)
+        }
+        var total = files.reduce(0) { $0 + $1.size }
+        guard total > byteLimit else { return }
+
+        files.sort { $0.date < $1.date }
+        // Recent temporary files may be downloads still in progress.
+        for file in files where total > byteLimit && !file.url.lastPathComponent.hasPrefix(".") {
+            try? FileManager.default.removeItem(at: file.url)
+            total -= file.size
+        }
+        logger.debug("trimmed \(self.directory.lastPathComponent) to \(total) bytes")
+    }
+}
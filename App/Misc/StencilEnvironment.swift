@@ -131,15 +131,37 @@ extension Stencil.Environment {
     
     private var contextDefaults: [String: Any] {
         return [
-            "baseURL": ForumsClient.shared.baseURL?.absoluteString ?? "",
-            "userInterfaceIdiom": UIDevice.current.userInterfaceIdiom == .pad ? "ipad" : "iphone",
-            "version": Bundle.main.shortVersionString ?? ""]
+            "baseURL": StencilEnvironment.baseURL,
+            "userInterfaceIdiom": StencilEnvironment.userInterfaceIdiom,
+            "version": StencilEnvironment.version]
+    }
+}
+
+extension StencilEnvironment {
+
+    // Default context values, also used by the compiled templates.
+
+    static var baseURL: String {
+        ForumsClient.shared.baseURL?.absoluteString ?? ""
+    }
+
+    static var userInterfaceIdiom: String {
+        UIDevice.current.userInterfaceIdiom == .pad ? "ipad" : "iphone"
+    }
+
+    static var version: String {
+        Bundle.main.shortVersionString ?? ""
     }
 }
 
 // MARK: - Custom filters and tags
 
 private func fontScaleStyle(_ context: Context) -> String {
+    return fontScaleStyleHTML()
+}
+
+/// The output of the `fontScaleStyle` tag.
+func fontScaleStyleHTML() -> String {
     let fontScale = NumberFormatter.localizedString(from: FoilDefaultStorage(Settings.fontScale).wrappedValue as NSNumber, number: .none)
     return """
         <style id="awful-font-scale-style">
@@ -163,17 +185,24 @@ private func htmlEscape(_ value: Any?) throws -> Any? {
     let stringified = stringify(value)
     var escaped = ""
     escaped.reserveCapacity(stringified.count)
-    for c in stringified {
-        switch c {
-        case "<": escaped += "&lt;"
-        case ">": escaped += "&gt;"
-        case "&": escaped += "&amp;"
-        case "'": escaped += "&apos;"
-        case "\"": escaped += "&quot;"
-        default: escaped.append(c)
+    escaped.appendHTMLEscaped(stringified)
+    return escaped
+}
+
+extension String {
+    /// Appends `unescaped` as the `htmlEscape` filter would output it.
+    mutating func appendHTMLEscaped(_ unescaped: String) {
+        for c in unescaped {
+            switch c {
+            case "<": self += "&lt;"
+            case ">": self += "&gt;"
+            case "&": self += "&amp;"
+            case "'": self += "&apos;"
+            case "\"": self += "&quot;"
+            default: append(c)
+            }
         }
     }
-    return escaped
 }
 
 // MARK: - Internal Stencil functions
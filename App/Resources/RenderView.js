@@ -307,6 +307,11 @@ Awful.fetchTweetOEmbed = function(tweetID, onSuccess, onFailure) {
  * @param {Element} thisPostElement - The post element to process for tweet embeds
  */
 Awful.embedTweetNow = function(thisPostElement) {
+    // An emptied-out post has no links to embed yet. It gets observed again when its contents come back.
+    if (Awful.virtualPosts.isVirtualized(thisPostElement)) {
+        return;
+    }
+
     // Check if already processing or processed
     if (thisPostElement.classList.contains("embed-processed") ||
         thisPostElement.classList.contains("embed-processing")) {
@@ -412,6 +417,7 @@ var waitingOEmbedResponses = {};
  Turns apparent links to Bluesky posts into actual embedded Bluesky posts.
  */
 Awful.embedBlueskyPosts = function() {
+  Awful.virtualPosts.restoreAll();
   for (const a of document.querySelectorAll('a[data-bluesky-post]')) {
     (async function() {
       const search = new URLSearchParams();
@@ -586,9 +592,9 @@ Awful.applyTimeoutToLoadingImages = function() {
     // Find post content images (excluding smilies, avatars, and lazy-loaded images) - these are the first 10 images
     const loadingImages = document.querySelectorAll(SELECTORS.LOADING_IMAGES);
 
-    // Count only the initially loading images (first 10), excluding attachment.php and data URLs
+    // Count only the initially loading images (first 10), excluding attachments and data URLs
     const initialImages = Array.from(loadingImages).filter(img =>
-        !img.src.includes('attachment.php') && !img.src.startsWith('data:')
+        !img.src.startsWith('awful-attachment:') && !img.src.startsWith('data:')
     );
     const totalImages = initialImages.length;
 
@@ -602,7 +608,7 @@ Awful.applyTimeoutToLoadingImages = function() {
 
     initialImages.forEach((img, index) => {
         const imageID = `img-init-${index}`;
-        const imageURL = img.src;
+        const imageURL = img.dataset.originalUrl || img.src;
 
         // img.complete is true for both successfully loaded AND failed images
         // We discriminate using naturalHeight: >0 means success, ===0 means failure
@@ -848,7 +854,7 @@ Awful.setupLazyImageErrorHandling = function() {
         // Only attach error listener - don't interfere with lazy loading
         img.addEventListener('error', function() {
             // Browser attempted to load this image and it failed
-            const imageURL = img.src;
+            const imageURL = img.dataset.originalUrl || img.src;
             Awful.handleImageLoadError(
                 new Error("Lazy image load failed"),
                 imageURL,
@@ -1241,7 +1247,8 @@ Awful.interestingElementsAtPoint = function(x, y) {
   var img = elementAtPoint.closest('img:not(button img)');
   if (img && Awful.isSpoiled(img)) {
     interesting.spoiledImageTitle = img.getAttribute('title');
-    if (img.classList.contains('posterized')) {
+    // Posterized GIFs and downsampled images both remember where they came from.
+    if (img.dataset.originalUrl) {
       interesting.spoiledImageURL = img.dataset.originalUrl;
     } else {
       interesting.spoiledImageURL = img.getAttribute('src');
@@ -1338,10 +1345,152 @@ Awful.topVisiblePost = function() {
 };
 
 
+// MARK: - Virtualized posts
+
+/**
+ Keeps only the posts near the viewport fully in the document. Posts further away are emptied out, leaving behind the `<post>` element itself at its measured height. Since the element stays put, scroll positions, post IDs and indices, `jumpToPostWithID`, `topVisiblePost`, and `markReadUpToPostWithID` all work as before.
+
+ An emptied post's contents are set aside as-is (not re-rendered from HTML), so spoilers, GIF toggles, and embeds that finish loading while it's away all stick. Taking them out of the document unloads iframes and lets WebKit drop decoded images; putting them back loads them again.
+
+ Off by default. See `Awful.setVirtualizePosts`.
+ */
+Awful.virtualPosts = {
+  enabled: false,
+
+  /// Posts within this many viewport heights of the viewport keep (or get back) their contents.
+  keepScreens: 2,
+
+  /// Posts are only emptied out once they're this many viewport heights away, so scrolling back and forth a little doesn't churn.
+  dropScreens: 3,
+
+  /// Emptied-out post elements mapped to what used to be in them.
+  saved: new WeakMap(),
+
+  updateScheduled: false,
+  lastWidth: 0,
+
+  isVirtualized: function(post) {
+    return this.saved.has(post);
+  },
+
+  scheduleUpdate: function() {
+    if (!this.enabled || this.updateScheduled) {
+      return;
+    }
+    this.updateScheduled = true;
+    window.requestAnimationFrame(function() {
+      Awful.virtualPosts.updateScheduled = false;
+      Awful.virtualPosts.update();
+    });
+  },
+
+  update: function() {
+    if (!this.enabled) {
+      return;
+    }
+
+    const viewportHeight = window.innerHeight;
+    const keepDistance = viewportHeight * this.keepScreens;
+    const dropDistance = viewportHeight * this.dropScreens;
+    const posts = document.querySelectorAll(SELECTORS.POST_ELEMENTS);
+
+    // Measure everything before changing anything. Emptying a post doesn't change its height, so these stay accurate.
+    const rects = Array.prototype.map.call(posts, function(post) {
+      return post.getBoundingClientRect();
+    });
+
+    let scrollAdjustment = 0;
+    Array.prototype.forEach.call(posts, function(post, i) {
+      const rect = rects[i];
+      let distance = 0;
+      if (rect.bottom < 0) {
+        distance = -rect.bottom;
+      } else if (rect.top > viewportHeight) {
+        distance = rect.top - viewportHeight;
+      }
+
+      if (this.isVirtualized(post)) {
+        if (distance <= keepDistance) {
+          this.restore(post);
+          // Keep what's on screen from jumping if a post above it came back a different size.
+          if (rect.bottom <= 0) {
+            scrollAdjustment += post.getBoundingClientRect().height - rect.height;
+          }
+        }
+      } else if (distance > dropDistance && !post.querySelector(SELECTORS.LOTTIE_PLAYERS)) {
+        // (Lottie players don't survive leaving the document, so posts with dead image or tweet badges stay.)
+        this.empty(post, rect.height);
+      }
+    }, this);
+
+    if (scrollAdjustment !== 0) {
+      window.scrollBy(0, scrollAdjustment);
+    }
+  },
+
+  empty: function(post, height) {
+    // Detached media keeps playing.
+    post.querySelectorAll('video, audio').forEach(function(media) {
+      media.pause();
+    });
+
+    const contents = document.createDocumentFragment();
+    while (post.firstChild) {
+      contents.appendChild(post.firstChild);
+    }
+    this.saved.set(post, { contents: contents, style: post.style.cssText });
+
+    post.style.boxSizing = 'border-box';
+    post.style.height = `${height}px`;
+  },
+
+  restore: function(post) {
+    const saved = this.saved.get(post);
+    this.saved.delete(post);
+    post.style.cssText = saved.style;
+    post.appendChild(saved.contents);
+
+    // Observing again makes the observer call back straight away, giving the tweets in this post a chance to embed.
+    if (Awful.tweetLazyLoadObserver) {
+      Awful.tweetLazyLoadObserver.unobserve(post);
+      Awful.tweetLazyLoadObserver.observe(post);
+    }
+  },
+
+  /**
+   Puts back every emptied-out post. Call before looking through (or changing the size of) every post, e.g. when a setting changes. Posts get emptied out again afterwards, remeasured.
+   */
+  restoreAll: function() {
+    const posts = document.querySelectorAll(SELECTORS.POST_ELEMENTS);
+    Array.prototype.forEach.call(posts, function(post) {
+      if (this.isVirtualized(post)) {
+        this.restore(post);
+      }
+    }, this);
+    this.scheduleUpdate();
+  },
+
+  didScroll: function() {
+    Awful.virtualPosts.scheduleUpdate();
+  },
+
+  didResize: function() {
+    // Saved heights are only good for the width they were measured at.
+    if (window.innerWidth !== Awful.virtualPosts.lastWidth) {
+      Awful.virtualPosts.lastWidth = window.innerWidth;
+      Awful.virtualPosts.restoreAll();
+    } else {
+      Awful.virtualPosts.scheduleUpdate();
+    }
+  }
+};
+
+
 /**
  Turns all links with `data-awful-linkified-image` attributes into img elements.
  */
 Awful.loadLinkifiedImages = function() {
+  Awful.virtualPosts.restoreAll();
   var links = document.querySelectorAll('[data-awful-linkified-image]');
   Array.prototype.forEach.call(links, function(link) {
     var url = link.textContent;
@@ -1421,6 +1570,53 @@ Awful.prependPosts = function(postsHTML) {
 };
 
 
+/**
+ Adds some posts to the bottom of the #posts element, as when the rest of a page arrives after its first posts are already showing.
+ */
+Awful.appendPosts = function(postsHTML) {
+  document.getElementById('posts').insertAdjacentHTML('beforeend', postsHTML);
+
+  if (window.twttr) {
+    window.twttr.ready(function() {
+      Awful.embedTweets();
+    });
+  }
+};
+
+
+/**
+ Swaps in a whole new page of posts, keeping the rest of the document (this script, stylesheets, ghost animation data) as it is. Much cheaper than loading a new document when changing pages.
+
+ @param {string} postsHTML - Replaces the contents of the #posts element.
+ @param {string} advertisementHTML - Replaces the contents of the #ad element.
+ @param {string} endMessageHTML - The end-of-thread message, or an empty string for none.
+ */
+Awful.replacePosts = function(postsHTML, advertisementHTML, endMessageHTML) {
+  // Anything still watching or timing the old posts.
+  Awful.cleanupObservers();
+
+  document.getElementById('posts').innerHTML = postsHTML;
+  document.getElementById('ad').innerHTML = advertisementHTML;
+
+  var oldEnd = document.querySelectorAll('#end, #endf');
+  Array.prototype.forEach.call(oldEnd, function(end) {
+    end.remove();
+  });
+  if (endMessageHTML) {
+    document.body.insertAdjacentHTML('beforeend', endMessageHTML);
+  }
+
+  window.scrollTo(0, 0);
+  Awful.virtualPosts.scheduleUpdate();
+
+  // Same as what runs when a new document loads.
+  Awful.embedGfycat();
+  Awful.applyTimeoutToLoadingImages();
+  Awful.setupRetryHandler();
+  Awful.setupLazyImageErrorHandling();
+};
+
+
 /**
  Replaces the announcement HTML.
 
@@ -1514,6 +1710,7 @@ Awful.setDarkMode = function(dark) {
  Updates the externally-updatable stylesheet, which lets us make changes quickly without going through a full app update.
  */
 Awful.setExternalStylesheet = function(stylesheet) {
+  Awful.virtualPosts.restoreAll();
   var externalStyle = document.getElementById('awful-external-style');
   if (externalStyle) {
     externalStyle.innerText = stylesheet;
@@ -1527,6 +1724,7 @@ Awful.setExternalStylesheet = function(stylesheet) {
  @param {number} percentage - The user's selected font scale as a percentage.
  */
 Awful.setFontScale = function(percentage) {
+  Awful.virtualPosts.restoreAll();
   var style = document.getElementById('awful-font-scale-style');
   if (!style) {
     return;
@@ -1546,6 +1744,7 @@ Awful.setFontScale = function(percentage) {
  @param {boolean} highlightMentions - `true` to highlight the logged-in user's username, `false` to remove any such highlighting.
  */
 Awful.setHighlightMentions = function(highlightMentions) {
+  Awful.virtualPosts.restoreAll();
   var mentions = document.querySelectorAll(".postbody span.mention");
   Array.prototype.forEach.call(mentions, function(mention) {
     mention.classList.toggle("highlight", highlightMentions);
@@ -1559,6 +1758,7 @@ Awful.setHighlightMentions = function(highlightMentions) {
  @param {boolean} highlightQuotes - `true` to highlight quotes written by the user, `false` to remove any such highlighting.
  */
 Awful.setHighlightQuotes = function(highlightQuotes) {
+  Awful.virtualPosts.restoreAll();
   var quotes = document.querySelectorAll(".bbc-block.mention");
   Array.prototype.forEach.call(quotes, function(quote) {
     quote.classList.toggle("highlight", highlightQuotes);
@@ -1582,6 +1782,7 @@ Awful.setPostHTMLAtIndex = function(postHTML, i) {
  @param {boolean} showAvatars - `true` to show user avatars, `false` to hide user avatars.
  */
 Awful.setShowAvatars = function(showAvatars) {
+  Awful.virtualPosts.restoreAll();
   if (showAvatars) {
     var headers = document.querySelectorAll('header[data-awful-avatar]');
     Array.prototype.forEach.call(headers, function(header) {
@@ -1634,6 +1835,7 @@ Awful.setShowAvatars = function(showAvatars) {
  @param {boolean} hide - `true` to mark the post header and post date as aria-hidden, `false` to restore them.
  */
 Awful.setHidePostMetadataForReader = function(hide) {
+  Awful.virtualPosts.restoreAll();
   var els = document.querySelectorAll('post > header, post > footer');
   Array.prototype.forEach.call(els, function(el) {
     if (hide) {
@@ -1645,12 +1847,39 @@ Awful.setHidePostMetadataForReader = function(hide) {
 };
 
 
+/**
+ Turns virtualized posts on or off. See `Awful.virtualPosts`.
+
+ @param {boolean} enabled - `true` to empty out posts far from the viewport, `false` to keep every post in full.
+ */
+Awful.setVirtualizePosts = function(enabled) {
+  var virtualPosts = Awful.virtualPosts;
+  if (virtualPosts.enabled === enabled) {
+    return;
+  }
+
+  if (enabled) {
+    virtualPosts.enabled = true;
+    virtualPosts.lastWidth = window.innerWidth;
+    window.addEventListener('scroll', virtualPosts.didScroll, { passive: true });
+    window.addEventListener('resize', virtualPosts.didResize);
+    virtualPosts.scheduleUpdate();
+  } else {
+    window.removeEventListener('scroll', virtualPosts.didScroll);
+    window.removeEventListener('resize', virtualPosts.didResize);
+    virtualPosts.restoreAll();
+    virtualPosts.enabled = false;
+  }
+};
+
+
 /**
  Updates the stylesheet for the currently-selected theme.
 
  @param {string} css - The replacement stylesheet from the new theme.
  */
 Awful.setThemeStylesheet = function(css) {
+  Awful.virtualPosts.restoreAll();
   var style = document.getElementById('awful-inline-style');
   if (!style) { return; }
   style.textContent = css;
@@ -1731,31 +1960,6 @@ Awful.embedGfycat = function() {
 
 Awful.embedGfycat();
 
-// Load attachment images asynchronously
-Awful.loadAttachmentImages = function() {
-  var attachmentImages = document.querySelectorAll('img[data-awful-attachment-id]');
-  attachmentImages.forEach(function(img, index) {
-    var attachmentID = img.getAttribute('data-awful-attachment-id');
-    var callbackID = 'attachment-' + attachmentID + '-' + index + '-' + Date.now();
-    img.setAttribute('data-awful-attachment-callback-id', callbackID);
-    window.webkit.messageHandlers.fetchAttachmentImage.postMessage({
-      id: callbackID,
-      attachmentid: attachmentID
-    });
-  });
-};
-
-Awful.didFetchAttachmentImage = function(id, dataURL) {
-  var img = document.querySelector('img[data-awful-attachment-callback-id="' + id + '"]');
-  if (img && dataURL) {
-    img.src = dataURL;
-  }
-};
-
-if (document.querySelectorAll('img[data-awful-attachment-id]').length > 0) {
-  Awful.loadAttachmentImages();
-}
-
 // Set up image loading if DOM is ready (DOMContentLoaded may have already fired)
 // The early user script in RenderView.swift tracks when DOMContentLoaded fires
 if (Awful.domContentLoadedFired) {
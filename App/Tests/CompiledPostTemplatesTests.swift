@@ -0,0 +1,124 @@
+//  CompiledPostTemplatesTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import Awful
+import XCTest
+
+final class CompiledPostTemplatesTests: XCTestCase {
+    func testPostMatchesStencil() throws {
+        for post in samplePosts {
+            let stencil = try StencilEnvironment.shared.renderTemplate(.post, context: post)
+            XCTAssertEqual(post.html, stencil, post.postID)
+        }
+    }
+
+    func testPostsViewMatchesStencil() throws {
+        var model = PostsViewRenderModel()
+        model.baseURL = "https://forums.somethingawful.com/"
+        model.externalStylesheet = ".external { }"
+        model.fontScaleStyle = fontScaleStyleHTML()
+        model.forumID = "26"
+        model.posts = samplePosts
+        model.stylesheet = "body { color: red; }"
+        model.threadID = "3500000"
+        model.tweetTheme = "dark"
+        model.userInterfaceIdiom = "iphone"
+        model.version = "1.2.3"
+
+        for (enableFrogAndGhost, endMessage) in [(false, false), (false, true), (true, false), (true, true)] {
+            model.enableFrogAndGhost = enableFrogAndGhost
+            model.endMessage = endMessage
+            model.ghostJsonData = enableFrogAndGhost ? "{\"boo\": true}" : ""
+            model.advertisementHTML = endMessage ? "<a href=\"#\">ad</a>" : ""
+
+            let stencil = try StencilEnvironment.shared.renderTemplate(.postsView, context: model.context)
+            XCTAssertEqual(model.html, stencil, "frog and ghost: \(enableFrogAndGhost), end message: \(endMessage)")
+        }
+    }
+
+    func testPageFragmentsAppearInPostsView() {
+        var model = PostsViewRenderModel()
+        model.posts = samplePosts
+        model.advertisementHTML = "<a href=\"#\">ad</a>"
+
+        for (enableFrogAndGhost, endMessage) in [(false, false), (false, true), (true, false), (true, true)] {
+            model.enableFrogAndGhost = enableFrogAndGhost
+            model.endMessage = endMessage
+
+            let html = model.html
+            let fragments = model.pageFragments
+            XCTAssertTrue(html.contains("<div id=\"posts\">\n    \(fragments.postsHTML)\n    </div>"))
+            XCTAssertTrue(html.contains("<div id=\"ad\">\n        \(fragments.advertisementHTML)\n"))
+            XCTAssertEqual(fragments.endMessageHTML.isEmpty, !endMessage)
+            XCTAssertTrue(html.contains(fragments.endMessageHTML))
+        }
+    }
+
+    func testShellIgnoresPageContent() {
+        var model = PostsViewRenderModel()
+        model.threadID = "3500000"
+        let shell = model.shell
+
+        model.posts = samplePosts
+        model.advertisementHTML = "<a href=\"#\">ad</a>"
+        model.endMessage = true
+        model.stylesheet = "body { color: blue; }"
+        XCTAssertEqual(model.shell, shell)
+
+        model.enableFrogAndGhost.toggle()
+        XCTAssertNotEqual(model.shell, shell)
+    }
+
+    func testEmptyPostsView() throws {
+        var model = PostsViewRenderModel()
+        model.baseURL = ""
+        model.fontScaleStyle = fontScaleStyleHTML()
+        model.userInterfaceIdiom = "ipad"
+        model.version = ""
+
+        let stencil = try StencilEnvironment.shared.renderTemplate(.postsView, context: model.context)
+        XCTAssertEqual(model.html, stencil)
+    }
+
+    private var samplePosts: [PostRenderModel] {
+        let plain = PostRenderModel(
+            accessibilityRoles: [],
+            authorRegdate: nil,
+            authorRegdateRaw: "Mar 3, 2004",
+            authorUserID: "12345",
+            authorUsername: "pokeyman",
+            beenSeen: false,
+            customTitleHTML: "",
+            hiddenAvatarURL: nil,
+            hideMetadataForReader: false,
+            htmlContents: "<p>hello <b>there</b></p>",
+            postDate: "",
+            postDateRaw: "Jan 1, 2026 12:00",
+            postID: "500000001",
+            roles: "",
+            showAvatars: true,
+            showRegdate: true,
+            visibleAvatarURL: URL(string: "https://i.somethingawful.com/avatar.png"))
+
+        var fancy = plain
+        fancy.accessibilityRoles = ["internet knight", "original poster"]
+        fancy.authorUsername = "<script>\"&'"
+        fancy.beenSeen = true
+        fancy.customTitleHTML = "<img src=\"title.gif\"><br>Some title"
+        fancy.hideMetadataForReader = true
+        fancy.postDateRaw = ""
+        fancy.postDate = "2026-01-01 12:00:00 +0000"
+        fancy.postID = "500000002"
+        fancy.roles = "ik op"
+        fancy.showRegdate = false
+
+        var avatarless = plain
+        avatarless.hiddenAvatarURL = URL(string: "https://i.somethingawful.com/a.png?b=c&d=e")
+        avatarless.postID = "500000003"
+        avatarless.showAvatars = false
+        avatarless.visibleAvatarURL = nil
+
+        return [plain, fancy, avatarless]
+    }
+}
@@ -4,6 +4,8 @@
 
 @testable import Awful
 import HTMLReader
+import UIKit
+import UniformTypeIdentifiers
 import XCTest
 
 final class HTMLRenderingHelperTests: XCTestCase {
@@ -67,4 +69,53 @@ final class HTMLRenderingHelperTests: XCTestCase {
         XCTAssertNil(doc.firstNode(matchingParsedSelector: .cached("iframe")))
         XCTAssertNotNil(doc.firstNode(matchingParsedSelector: .cached("a")))
     }
+
+    func testDownsampleImages() {
+        let doc = HTMLDocument(string: """
+            <img src="https://example.com/big.png">\
+            <img src="https://example.com/animated.gif">\
+            <img src="https://i.somethingawful.com/forumsystem/emoticons/emot-smile.gif" title=":)">
+            """)
+        doc.processImgTags(shouldLinkifyNonSmilies: false, downsampleImages: true)
+        let imgs = doc.nodes(matchingParsedSelector: .cached("img"))
+
+        XCTAssertEqual(imgs[0]["data-original-url"], "https://example.com/big.png")
+        let downsampled = imgs[0]["src"].flatMap(URLComponents.init(string:))
+        XCTAssertEqual(downsampled?.scheme, DownsampledImageURLSchemeHandler.scheme)
+        XCTAssertEqual(downsampled?.queryItems?.first?.value, "https://example.com/big.png")
+
+        XCTAssertEqual(imgs[1]["src"], "https://example.com/animated.gif")
+        XCTAssertNil(imgs[1]["data-original-url"])
+        XCTAssertEqual(imgs[2]["src"], "https://i.somethingawful.com/forumsystem/emoticons/emot-smile.gif")
+    }
+
+    func testAttachmentImageKeepsOriginalURL() {
+        let attachmentURL = "https://forums.somethingawful.com/attachment.php?attachmentid=123456"
+        let doc = HTMLDocument(string: "<img src=\"\(attachmentURL)\">")
+        doc.processImgTags(shouldLinkifyNonSmilies: false)
+        let img = doc.firstNode(matchingParsedSelector: .cached("img"))
+
+        XCTAssertEqual(img?["src"], AttachmentImageURLSchemeHandler.url(forAttachmentID: "123456")?.absoluteString)
+        XCTAssertEqual(img?["data-original-url"], attachmentURL)
+    }
+
+    func testDownsampleNarrowsWideImage() throws {
+        let format = UIGraphicsImageRendererFormat()
+        format.scale = 1
+        format.opaque = true
+        let image = UIGraphicsImageRenderer(size: CGSize(width: 2000, height: 500), format: format).image { context in
+            UIColor.red.setFill()
+            context.fill(CGRect(x: 0, y: 0, width: 2000, height: 500))
+        }
+        let png = try XCTUnwrap(image.pngData())
+
+        let downsampled = try XCTUnwrap(DownsampledImageURLSchemeHandler.downsample(png, maximumWidth: 500))
+        XCTAssertEqual(downsampled.type, .jpeg)
+        let result = try XCTUnwrap(UIImage(data: downsampled.data))
+        XCTAssertEqual(result.size.width * result.scale, 500)
+        XCTAssertEqual(result.size.height * result.scale, 125)
+
+        XCTAssertNil(DownsampledImageURLSchemeHandler.downsample(png, maximumWidth: 2000), "already narrow enough")
+        XCTAssertNil(DownsampledImageURLSchemeHandler.downsample(Data("<html>".utf8), maximumWidth: 500), "not an image")
+    }
 }
@@ -0,0 +1,139 @@
+//  HTMLRewriterTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import Awful
+import AwfulCore
+import HTMLReader
+import XCTest
+
+final class HTMLRewriterTests: XCTestCase {
+    func testMatchesHelpers() {
+        let html = """
+            <p>jerkstore said <a href="https://twitter.com/someone/status/12345">https://twitter.com/someone/status/12345</a>
+            and <a href="https://bsky.app/profile/someone/post/abc">https://bsky.app/profile/someone/post/abc</a></p>
+            <div class="bbc-block"><h4><a class="quote_link" href="showthread.php?goto=post&amp;postid=420">jerkstore posted:</a></h4>
+            <blockquote>hello <span class="bbc-spoiler" style="color: black" onmouseover="x()" onmouseout="y()">secret</span></blockquote></div>
+            <img src="https://i.somethingawful.com/forumsystem/emoticons/emot-smile.gif" title=":)">
+            <img src="https://i.imgur.com/abcdef.gif">
+            <a href="https://example.com/wrapped"><img src="https://i.imgur.com/linked.gif"></a>
+            <img src="http://img.waffleimages.com/43bc914050a09db4e3df87289eb4b0e38e9e33eb/butter.jpg">
+            <a href="https://i.imgur.com/video.gifv">https://i.imgur.com/video.gifv</a>
+            <a href="https://www.youtube.com/watch?v=dQw4w9WgXcQ">https://www.youtube.com/watch?v=dQw4w9WgXcQ</a>
+            <a href="showthread.php?action=showpost&amp;postid=1" title="DON'T DO IT!!">reveal</a>
+            <div class="bbcode_video"><object width="400" height="225"><param name="movie" value="https://vimeo.com/moogaloop.swf?clip_id=1234"></object></div>
+            <iframe src="https://www.youtube.com/embed/xyz"></iframe>
+            <video src="https://example.com/clip.mp4"></video>
+            <p class="editedby"> </p>
+            <p class="editedby">edited by jerkstore</p>
+            """ + (0..<12).map { "<img src=\"https://example.com/\($0).jpg\">" }.joined()
+
+        for options in allOptions(username: "jerkstore") {
+            XCTAssertEqual(rewritten(html, options), massagedOneHelperAtATime(html, options), "\(options)")
+        }
+    }
+
+    func testMatchesHelpersOnFixturePosts() throws {
+        for post in try fixturePosts() {
+            for options in allOptions(username: post.author.username) {
+                XCTAssertEqual(rewritten(post.body, options), massagedOneHelperAtATime(post.body, options), "post \(post.id.rawValue), \(options)")
+            }
+        }
+    }
+
+    func testPerformanceOneHelperAtATime() throws {
+        let posts = try fixturePosts()
+        let options = defaultOptions
+        measure {
+            for post in posts {
+                _ = massagedOneHelperAtATime(post.body, options)
+            }
+        }
+    }
+
+    func testPerformanceRewriter() throws {
+        let posts = try fixturePosts()
+        let options = defaultOptions
+        measure {
+            for post in posts {
+                _ = rewritten(post.body, options)
+            }
+        }
+    }
+
+    private let defaultOptions = HTMLDocument.PostBodyRewriteOptions(
+        embedVideos: true,
+        isIgnored: false,
+        linkifyNonSmilies: false,
+        magicCake: false,
+        stopGIFAutoplay: true,
+        username: "pokeyman")
+
+    private func allOptions(username: String?) -> [HTMLDocument.PostBodyRewriteOptions] {
+        var all: [HTMLDocument.PostBodyRewriteOptions] = []
+        for embedVideos in [false, true] {
+            for flip in [false, true] {
+                all.append(.init(
+                    embedVideos: embedVideos,
+                    isIgnored: flip,
+                    linkifyNonSmilies: flip,
+                    magicCake: !flip,
+                    stopGIFAutoplay: !flip,
+                    username: flip ? nil : username,
+                    downsampleImages: embedVideos))
+            }
+        }
+        return all
+    }
+
+    private func rewritten(_ html: String, _ options: HTMLDocument.PostBodyRewriteOptions) -> String {
+        let document = HTMLDocument(string: html)
+        document.rewritePostBody(options)
+        return document.bodyElement?.innerHTML ?? ""
+    }
+
+    /// What `massageHTML` did before `rewritePostBody(_:)` existed.
+    private func massagedOneHelperAtATime(_ html: String, _ options: HTMLDocument.PostBodyRewriteOptions) -> String {
+        let document = HTMLDocument(string: html)
+        document.removeSpoilerStylingAndEvents()
+        document.removeEmptyEditedByParagraphs()
+        document.addAttributeToBlueskyLinks()
+        document.addAttributeToTweetLinks()
+        if options.embedVideos {
+            document.useHTML5VimeoPlayer()
+        }
+        if let username = options.username {
+            document.identifyQuotesCitingUser(named: username, shouldHighlight: true)
+            document.identifyMentionsOfUser(named: username, shouldHighlight: true)
+        }
+        document.processImgTags(shouldLinkifyNonSmilies: options.linkifyNonSmilies, downsampleImages: options.downsampleImages)
+        if options.stopGIFAutoplay {
+            document.stopGIFAutoplay()
+        }
+        if options.isIgnored {
+            document.markRevealIgnoredPostLink()
+        }
+        if options.magicCake {
+            document.addMagicCakeCSS()
+        }
+        if options.embedVideos {
+            document.embedVideos()
+        } else {
+            document.linkifyResidualVideoEmbeds()
+        }
+        return document.bodyElement?.innerHTML ?? ""
+    }
+
+    /// Posts from AwfulCore's posts page fixtures.
+    private func fixturePosts() throws -> [PostScrapeResult] {
+        let fixtures = URL(fileURLWithPath: #filePath)
+            .deletingLastPathComponent()
+            .appendingPathComponent("../../AwfulCore/Tests/AwfulCoreTests/Fixtures", isDirectory: true)
+        var posts: [PostScrapeResult] = []
+        for name in ["showthread", "showthread2", "showthread3", "showthread-asktell", "showthread-fyad2", "showthread-last"] {
+            let html = try String(contentsOf: fixtures.appendingPathComponent("\(name).html"), encoding: .windowsCP1252)
+            posts += try PostsPageScrapeResult(HTMLDocument(string: html), url: nil).posts
+        }
+        return posts
+    }
+}
@@ -0,0 +1,200 @@
+//  ImageUploadSchedulerTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import Awful
+import XCTest
+
+final class ImageUploadSchedulerTests: XCTestCase {
+
+    /// Holds on to each upload until the test finishes it.
+    private final class FakeUploads {
+        private let lock = NSLock()
+        private var pending: [Int: (Result<ImageUploadScheduler<Int>.Uploaded, Error>) -> Void] = [:]
+        private var waitingToSend: [Int: () -> Void] = [:]
+        private(set) var started: [Int] = []
+        private(set) var mostAtOnce = 0
+        var remainingUploads: Int?
+
+        /// Otherwise, uploads wait for `startSending(_:)`, as if they were stuck waiting for a turn.
+        var startsSendingImmediately = true
+
+        func upload(_ source: Int, didStartSending: @escaping () -> Void, completion: @escaping (Result<ImageUploadScheduler<Int>.Uploaded, Error>) -> Void) -> Progress {
+            lock.lock()
+            pending[source] = completion
+            started.append(source)
+            mostAtOnce = max(mostAtOnce, pending.count)
+            let startsSendingImmediately = startsSendingImmediately
+            if !startsSendingImmediately {
+                waitingToSend[source] = didStartSending
+            }
+            lock.unlock()
+
+            if startsSendingImmediately {
+                didStartSending()
+            }
+            return Progress(totalUnitCount: 1)
+        }
+
+        func startSending(_ source: Int) {
+            lock.lock()
+            let didStartSending = waitingToSend.removeValue(forKey: source)
+            lock.unlock()
+            didStartSending?()
+        }
+
+        func succeed(_ source: Int) {
+            finish(source, .success(.init(url: URL(string: "https://example.com/\(source).png")!, remainingUploads: remainingUploads)))
+        }
+
+        func fail(_ source: Int) {
+            finish(source, .failure(URLError(.timedOut)))
+        }
+
+        private func finish(_ source: Int, _ result: Result<ImageUploadScheduler<Int>.Uploaded, Error>) {
+            lock.lock()
+            let completion = pending.removeValue(forKey: source)
+            lock.unlock()
+            completion?(result)
+        }
+
+        var startedCount: Int {
+            lock.lock()
+            defer { lock.unlock() }
+            return started.count
+        }
+    }
+
+    private func waitUntil(_ condition: @autoclosure () -> Bool, file: StaticString = #filePath, line: UInt = #line) {
+        let deadline = Date().addingTimeInterval(2)
+        while !condition(), Date() < deadline {
+            RunLoop.current.run(until: Date().addingTimeInterval(0.01))
+        }
+        XCTAssertTrue(condition(), file: file, line: line)
+    }
+
+    func testURLsComeBackInOrder() {
+        let uploads = FakeUploads()
+        let scheduler = ImageUploadScheduler(sources: Array(0..<5), upload: uploads.upload)
+        let done = expectation(description: "done")
+        scheduler.start { result in
+            XCTAssertEqual(try? result.get().map(\.lastPathComponent), ["0.png", "1.png", "2.png", "3.png", "4.png"])
+            done.fulfill()
+        }
+
+        var finished: Set<Int> = []
+        while finished.count < 5 {
+            waitUntil(uploads.startedCount > finished.count)
+            // Finish the most recently started first.
+            let source = uploads.started.last { !finished.contains($0) }!
+            finished.insert(source)
+            uploads.succeed(source)
+        }
+        wait(for: [done], timeout: 2)
+    }
+
+    func testOnlyAFewAtOnce() {
+        let uploads = FakeUploads()
+        var concurrentUploads: [Int] = []
+        let scheduler = ImageUploadScheduler(sources: Array(0..<10), upload: uploads.upload, setConcurrentUploads: { concurrentUploads.append($0) })
+        scheduler.maximumConcurrentUploads = 3
+        let done = expectation(description: "done")
+        scheduler.start { _ in done.fulfill() }
+
+        for source in 0..<10 {
+            waitUntil(uploads.startedCount > source)
+            uploads.succeed(source)
+        }
+        wait(for: [done], timeout: 2)
+
+        // One extra is allowed to get ready while the others send.
+        XCTAssertLessThanOrEqual(uploads.mostAtOnce, 4)
+        XCTAssertEqual(concurrentUploads.first, 2)
+        XCTAssertEqual(concurrentUploads.max(), 3)
+    }
+
+    func testSlowUploadsShrinkConcurrency() {
+        let uploads = FakeUploads()
+        var concurrentUploads: [Int] = []
+        let scheduler = ImageUploadScheduler(sources: Array(0..<4), upload: uploads.upload, setConcurrentUploads: { concurrentUploads.append($0) })
+        scheduler.slowUploadDuration = 0
+        let done = expectation(description: "done")
+        scheduler.start { _ in done.fulfill() }
+
+        for source in 0..<4 {
+            waitUntil(uploads.startedCount > source)
+            Thread.sleep(forTimeInterval: 0.01)
+            uploads.succeed(source)
+        }
+        wait(for: [done], timeout: 2)
+        XCTAssertEqual(concurrentUploads.last, 1)
+    }
+
+    func testWaitingToSendIsNotSlow() {
+        let uploads = FakeUploads()
+        uploads.startsSendingImmediately = false
+        var concurrentUploads: [Int] = []
+        let scheduler = ImageUploadScheduler(sources: Array(0..<3), upload: uploads.upload, setConcurrentUploads: { concurrentUploads.append($0) })
+        scheduler.slowUploadDuration = 0.1
+        let done = expectation(description: "done")
+        scheduler.start { _ in done.fulfill() }
+
+        waitUntil(uploads.startedCount == 3)
+        Thread.sleep(forTimeInterval: 0.2)
+        for source in 0..<3 {
+            uploads.startSending(source)
+            uploads.succeed(source)
+        }
+        wait(for: [done], timeout: 2)
+        XCTAssertFalse(concurrentUploads.contains(1))
+        XCTAssertEqual(concurrentUploads.last, 4)
+    }
+
+    func testFailsBeforeRunningOutOfUploads() {
+        let uploads = FakeUploads()
+        let scheduler = ImageUploadScheduler(sources: Array(0..<10), upload: uploads.upload)
+        let done = expectation(description: "done")
+        scheduler.start { result in
+            if case .failure(ImageUploadError.rateLimited) = result {} else {
+                XCTFail("expected rate limit error, got \(result)")
+            }
+            done.fulfill()
+        }
+        waitUntil(uploads.startedCount == 3)
+        scheduler.updateRemainingUploads(5)
+        wait(for: [done], timeout: 2)
+        XCTAssertEqual(uploads.startedCount, 3)
+    }
+
+    func testFirstErrorFailsBatch() {
+        let uploads = FakeUploads()
+        let scheduler = ImageUploadScheduler(sources: Array(0..<5), upload: uploads.upload)
+        let done = expectation(description: "done")
+        scheduler.start { result in
+            XCTAssertThrowsError(try result.get())
+            done.fulfill()
+        }
+        waitUntil(uploads.startedCount == 3)
+        uploads.fail(1)
+        wait(for: [done], timeout: 2)
+        XCTAssertTrue(scheduler.imageProgress[0].isCancelled)
+        XCTAssertEqual(uploads.startedCount, 3)
+    }
+
+    func testCancellingFailsWithoutWaiting() {
+        let uploads = FakeUploads()
+        let scheduler = ImageUploadScheduler(sources: Array(0..<5), upload: uploads.upload)
+        let done = expectation(description: "done")
+        scheduler.start { result in
+            if case .failure(let error as CocoaError) = result {
+                XCTAssertEqual(error.code, .userCancelled)
+            } else {
+                XCTFail("expected cancellation, got \(result)")
+            }
+            done.fulfill()
+        }
+        waitUntil(uploads.startedCount == 3)
+        scheduler.progress.cancel()
+        wait(for: [done], timeout: 2)
+    }
+}
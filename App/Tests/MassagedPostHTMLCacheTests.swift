@@ -0,0 +1,39 @@
+//  MassagedPostHTMLCacheTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import Awful
+import XCTest
+
+final class MassagedPostHTMLCacheTests: XCTestCase {
+    private let settings = PostHTMLSettings(autoplayGIFs: true, downsampleImages: false, embedVideos: false, loadImages: true, username: "pokeyman")
+
+    func testHitsAndMisses() {
+        let cache = MassagedPostHTMLCache()
+        var massageCount = 0
+        func html(innerHTML: String = "<p>hi</p>", isIgnored: Bool = false, settings: PostHTMLSettings? = nil) -> String {
+            return cache.html(postID: "123", innerHTML: innerHTML, isIgnored: isIgnored, forumID: "26", settings: settings ?? self.settings, massage: { innerHTML, isIgnored, _, _ in
+                massageCount += 1
+                return innerHTML + (isIgnored ? " (ignored)" : "")
+            })
+        }
+
+        XCTAssertEqual(html(), "<p>hi</p>")
+        XCTAssertEqual(html(), "<p>hi</p>")
+        XCTAssertEqual(massageCount, 1)
+        XCTAssertEqual(cache.hits, 1)
+        XCTAssertEqual(cache.misses, 1)
+
+        XCTAssertEqual(html(innerHTML: "<p>edited</p>"), "<p>edited</p>")
+        XCTAssertEqual(html(innerHTML: "<p>edited</p>", isIgnored: true), "<p>edited</p> (ignored)")
+        var otherSettings = settings
+        otherSettings.loadImages = false
+        _ = html(innerHTML: "<p>edited</p>", isIgnored: true, settings: otherSettings)
+        XCTAssertEqual(massageCount, 4)
+        XCTAssertEqual(cache.misses, 4)
+
+        cache.resetStatistics()
+        XCTAssertEqual(cache.hits, 0)
+        XCTAssertEqual(cache.misses, 0)
+    }
+}
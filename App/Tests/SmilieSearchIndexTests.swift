@@ -0,0 +1,72 @@
+//  SmilieSearchIndexTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import Awful
+import XCTest
+
+final class SmilieSearchIndexTests: XCTestCase {
+    private struct TestSmilie {
+        let text: String
+        let summary: String?
+    }
+
+    private let smilies = [
+        TestSmilie(text: ":rolleyes:", summary: "Eyes rolling"),
+        TestSmilie(text: ":rolldice:", summary: "Rolling dice"),
+        TestSmilie(text: ":patriot:", summary: "Café patrón"),
+        TestSmilie(text: ":eng101:", summary: "English 101"),
+        TestSmilie(text: ":rolleyes:", summary: "A duplicate"),
+        TestSmilie(text: ":v:", summary: nil),
+        TestSmilie(text: ":cop:", summary: "Police officer"),
+    ]
+
+    private func search(_ query: String) -> [String] {
+        SmilieSearchIndex(smilies, text: \.text, summary: \.summary).search(query).map(\.text)
+    }
+
+    func testDuplicatesAreDropped() {
+        XCTAssertEqual(SmilieSearchIndex(smilies, text: \.text, summary: \.summary).count, 6)
+    }
+
+    func testTextPrefixBeforeSummary() {
+        XCTAssertEqual(search("roll"), [":rolldice:", ":rolleyes:"])
+        XCTAssertEqual(search(":rolle"), [":rolleyes:"])
+        XCTAssertEqual(search("eyes"), [":rolleyes:"])
+    }
+
+    func testExactTextFirst() {
+        XCTAssertEqual(search("cop"), [":cop:"])
+        XCTAssertEqual(search(":v:"), [":v:"])
+    }
+
+    func testIgnoresCaseAndDiacritics() {
+        XCTAssertEqual(search("CAFE"), [":patriot:"])
+        XCTAssertEqual(search("patron"), [":patriot:"])
+    }
+
+    func testShortQueriesScanEverything() {
+        XCTAssertEqual(search("v"), [":v:"])
+        XCTAssertEqual(search("10"), [":eng101:"])
+    }
+
+    func testNoMatches() {
+        XCTAssertEqual(search("rolldie"), [])
+        XCTAssertEqual(search("zzz"), [])
+    }
+
+    func testColonsAlone() {
+        XCTAssertEqual(search(":").count, 6)
+        XCTAssertEqual(search(""), [])
+    }
+
+    func testPerformanceSearch() {
+        let many = (0..<1500).map { TestSmilie(text: ":smilie\($0):", summary: "Summary number \($0)") }
+        let index = SmilieSearchIndex(many, text: \.text, summary: \.summary)
+        measure {
+            for query in ["s", "sm", "smi", "smilie14", "number 7", "nope"] {
+                _ = index.search(query)
+            }
+        }
+    }
+}
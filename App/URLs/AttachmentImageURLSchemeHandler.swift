@@ -0,0 +1,119 @@
+//  AttachmentImageURLSchemeHandler.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import AwfulCore
+import os
+import WebKit
+
+private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category: "AttachmentImageURLSchemeHandler")
+
+/**
+ Serves forum attachment images to a web view at `awful-attachment://<attachment ID>`, using the logged-in user's session.
+
+ Bytes go to the web view in the pieces they arrive in, rather than being collected, re-encoded, and passed through JavaScript. They're also saved to disk, keyed by attachment ID, so the next request for the same attachment (e.g. when the page is reloaded) doesn't hit the network.
+
+ Register with `WKWebViewConfiguration.setURLSchemeHandler(_:forURLScheme:)`.
+ */
+final class AttachmentImageURLSchemeHandler: NSObject, WKURLSchemeHandler {
+
+    static let scheme = "awful-attachment"
+
+    static func url(forAttachmentID attachmentID: String) -> URL? {
+        var components = URLComponents()
+        components.scheme = scheme
+        components.host = attachmentID
+        return components.url
+    }
+
+    private static func attachmentID(from url: URL?) -> String? {
+        guard let id = url?.host, !id.isEmpty, id.allSatisfy(\.isNumber) else { return nil }
+        return id
+    }
+
+    /// Shared by every handler, so every web view benefits.
+    private static let cache = ImageFileCache(directoryName: "AttachmentImages", byteLimit: 100 * 1024 * 1024)
+
+    /// Only touched on the main thread, which is where WebKit calls us.
+    private var loads: [ObjectIdentifier: Task<Void, Never>] = [:]
+
+    func webView(_ webView: WKWebView, start task: WKURLSchemeTask) {
+        guard let url = task.request.url, let attachmentID = Self.attachmentID(from: url) else {
+            task.didFailWithError(URLError(.badURL))
+            return
+        }
+
+        let key = ObjectIdentifier(task)
+        let cache = Self.cache
+        loads[key] = Task.detached { [weak self] in
+            do {
+                try await Self.load(attachmentID, url: url, cache: cache, into: task)
+            } catch {
+                await MainActor.run {
+                    // Once WebKit stops a task, messaging it throws an exception.
+                    guard !Task.isCancelled else { return }
+                    if !(error is CancellationError) {
+                        logger.error("could not load attachment \(attachmentID): \(error)")
+                    }
+                    task.didFailWithError(error)
+                }
+            }
+            await MainActor.run {
+                _ = self?.loads.removeValue(forKey: key)
+            }
+        }
+    }
+
+    func webView(_ webView: WKWebView, stop task: WKURLSchemeTask) {
+        loads.removeValue(forKey: ObjectIdentifier(task))?.cancel()
+    }
+
+    private static func load(_ attachmentID: String, url: URL, cache: ImageFileCache, into task: WKURLSchemeTask) async throws {
+        if let cached = cache.cachedImage(key: attachmentID) {
+            try await send(to: task) {
+                $0.didReceive(makeResponse(url: url, mimeType: cached.mimeType, length: cached.data.count))
+                $0.didReceive(cached.data)
+                $0.didFinish()
+            }
+            return
+        }
+
+        let (chunks, response) = try await ForumsClient.shared.attachmentImageChunks(attachmentID: attachmentID)
+        guard let mimeType = response.mimeType, mimeType.hasPrefix("image/") else {
+            // Usually an HTML error page, e.g. when logged out.
+            throw URLError(.cannotDecodeContentData)
+        }
+
+        let writer = cache.makeWriter(key: attachmentID)
+        defer { writer?.discard() }
+
+        let expectedLength = response.expectedContentLength > 0 ? Int(response.expectedContentLength) : nil
+        try await send(to: task) {
+            $0.didReceive(makeResponse(url: url, mimeType: mimeType, length: expectedLength))
+        }
+
+        for try await data in chunks {
+            writer?.write(data)
+            try await send(to: task) { $0.didReceive(data) }
+        }
+
+        writer?.commit()
+        try await send(to: task) { $0.didFinish() }
+    }
+
+    /// Messages `task` on the main thread, unless WebKit has stopped it in the meantime.
+    private static func send(to task: WKURLSchemeTask, _ body: @escaping (WKURLSchemeTask) -> Void) async throws {
+        try await MainActor.run {
+            try Task.checkCancellation()
+            body(task)
+        }
+    }
+
+    private static func makeResponse(url: URL, mimeType: String, length: Int?) -> HTTPURLResponse {
+        var headers = ["Content-Type": mimeType]
+        if let length {
+            headers["Content-Length"] = "\(length)"
+        }
+        return HTTPURLResponse(url: url, statusCode: 200, httpVersion: "HTTP/1.1", headerFields: headers)!
+    }
+}
@@ -0,0 +1,180 @@
+//  DownsampledImageURLSchemeHandler.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import AwfulCore
+import CryptoKit
+import ImageIO
+import os
+import UniformTypeIdentifiers
+import WebKit
+
+private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category: "DownsampledImageURLSchemeHandler")
+
+/**
+ Serves post images to a web view at `awful-downsampled-image://image?url=<original URL>`, shrunk to fit `maximumWidth` (typically the widest the screen gets).
+
+ A web view given a 4000 pixel wide PNG to show in a 375 point wide post decodes every one of those pixels. Here the original is fetched once, downsampled off the main thread without ever being decoded at full size, and saved to disk, where it stays as long as it's been viewed recently enough. The web view only ever sees the small version.
+
+ Images that are already narrow enough, and animated images, are passed along as-is.
+
+ Register with `WKWebViewConfiguration.setURLSchemeHandler(_:forURLScheme:)`.
+ */
+final class DownsampledImageURLSchemeHandler: NSObject, WKURLSchemeHandler {
+
+    static let scheme = "awful-downsampled-image"
+
+    /// - Returns: `nil` unless `imageURL` is an `http` or `https` URL.
+    static func url(forImageURL imageURL: URL) -> URL? {
+        guard let scheme = imageURL.scheme?.lowercased(), scheme == "http" || scheme == "https" else { return nil }
+        var components = URLComponents()
+        components.scheme = self.scheme
+        components.host = "image"
+        components.queryItems = [URLQueryItem(name: "url", value: imageURL.absoluteString)]
+        return components.url
+    }
+
+    private static func imageURL(from url: URL?) -> URL? {
+        guard let url,
+              let components = URLComponents(url: url, resolvingAgainstBaseURL: false),
+              let value = components.queryItems?.first(where: { $0.name == "url" })?.value,
+              let imageURL = URL(string: value),
+              let scheme = imageURL.scheme?.lowercased(), scheme == "http" || scheme == "https"
+        else { return nil }
+        return imageURL
+    }
+
+    /// Shared by every handler, so every web view benefits.
+    private static let cache = ImageFileCache(directoryName: "DownsampledImages", byteLimit: 200 * 1024 * 1024)
+
+    private static let session: URLSession = {
+        let configuration = URLSessionConfiguration.default
+        // What's worth keeping goes in `cache`, after downsampling.
+        configuration.urlCache = nil
+        configuration.httpAdditionalHeaders = ["User-Agent": awfulUserAgent]
+        return URLSession(configuration: configuration)
+    }()
+
+    /// Images wider than this many pixels are shrunk to fit.
+    let maximumWidth: Int
+
+    /// Only touched on the main thread, which is where WebKit calls us.
+    private var loads: [ObjectIdentifier: Task<Void, Never>] = [:]
+
+    init(maximumWidth: Int) {
+        self.maximumWidth = maximumWidth
+    }
+
+    func webView(_ webView: WKWebView, start task: WKURLSchemeTask) {
+        guard let url = task.request.url, let imageURL = Self.imageURL(from: url) else {
+            task.didFailWithError(URLError(.badURL))
+            return
+        }
+
+        let key = ObjectIdentifier(task)
+        let maximumWidth = self.maximumWidth
+        loads[key] = Task.detached(priority: .userInitiated) { [weak self] in
+            do {
+                let image = try await Self.load(imageURL, maximumWidth: maximumWidth)
+                try await MainActor.run {
+                    // Once WebKit stops a task, messaging it throws an exception.
+                    try Task.checkCancellation()
+                    task.didReceive(HTTPURLResponse(url: url, statusCode: 200, httpVersion: "HTTP/1.1", headerFields: [
+                        "Content-Type": image.mimeType,
+                        "Content-Length": "\(image.data.count)"])!)
+                    task.didReceive(image.data)
+                    task.didFinish()
+                }
+            } catch {
+                await MainActor.run {
+                    guard !Task.isCancelled else { return }
+                    if !(error is CancellationError) {
+                        logger.error("could not load \(imageURL): \(error)")
+                    }
+                    task.didFailWithError(error)
+                }
+            }
+            await MainActor.run {
+                _ = self?.loads.removeValue(forKey: key)
+            }
+        }
+    }
+
+    func webView(_ webView: WKWebView, stop task: WKURLSchemeTask) {
+        loads.removeValue(forKey: ObjectIdentifier(task))?.cancel()
+    }
+
+    private static func load(_ imageURL: URL, maximumWidth: Int) async throws -> (data: Data, mimeType: String) {
+        let key = cacheKey(imageURL, maximumWidth: maximumWidth)
+        if let cached = cache.cachedImage(key: key) {
+            return cached
+        }
+
+        let (data, response) = try await session.data(from: imageURL)
+        if let response = response as? HTTPURLResponse, !(200..<300).contains(response.statusCode) {
+            throw URLError(.badServerResponse)
+        }
+        try Task.checkCancellation()
+
+        if let downsampled = downsample(data, maximumWidth: maximumWidth) {
+            logger.debug("downsampled \(data.count) bytes to \(downsampled.data.count) for \(imageURL)")
+            cache.store(downsampled.data, key: key)
+            return (downsampled.data, downsampled.type.preferredMIMEType ?? "application/octet-stream")
+        }
+
+        // Only keep what the web view can show. Error pages sent as 200 OK shouldn't stick around.
+        if let source = CGImageSourceCreateWithData(data as CFData, nil), CGImageSourceGetType(source) != nil {
+            cache.store(data, key: key)
+        }
+        return (data, response.mimeType ?? "application/octet-stream")
+    }
+
+    /// The same image at a different width is a different file.
+    private static func cacheKey(_ imageURL: URL, maximumWidth: Int) -> String {
+        let digest = SHA256.hash(data: Data("\(maximumWidth) \(imageURL.absoluteString)".utf8))
+        return digest.map { String(format: "%02x", $0) }.joined()
+    }
+
+    /**
+     Shrinks an image to `maximumWidth` pixels wide (after rotating per its orientation), keeping its aspect ratio, without decoding it at full size.
+
+     - Returns: `nil` if the image is fine as-is: already narrow enough, animated, or not an image at all.
+     */
+    static func downsample(_ data: Data, maximumWidth: Int) -> (data: Data, type: UTType)? {
+        guard let source = CGImageSourceCreateWithData(data as CFData, [kCGImageSourceShouldCache: false] as CFDictionary),
+              CGImageSourceGetCount(source) == 1,
+              let properties = CGImageSourceCopyPropertiesAtIndex(source, 0, nil) as? [CFString: Any],
+              let pixelWidth = properties[kCGImagePropertyPixelWidth] as? Int,
+              let pixelHeight = properties[kCGImagePropertyPixelHeight] as? Int
+        else { return nil }
+
+        // Orientations 5 through 8 turn the image on its side.
+        let orientation = properties[kCGImagePropertyOrientation] as? UInt32 ?? 1
+        let (width, height) = orientation >= 5 ? (pixelHeight, pixelWidth) : (pixelWidth, pixelHeight)
+        guard width > maximumWidth else { return nil }
+
+        // Thumbnails are sized by their longer side, which might be the height.
+        let longerSide = (Double(max(width, height)) * Double(maximumWidth) / Double(width)).rounded(.down)
+        let thumbnailOptions = [
+            kCGImageSourceCreateThumbnailFromImageAlways: true,
+            kCGImageSourceCreateThumbnailWithTransform: true,
+            kCGImageSourceShouldCacheImmediately: true,
+            kCGImageSourceThumbnailMaxPixelSize: max(1, Int(longerSide)),
+        ] as CFDictionary
+        guard let thumbnail = CGImageSourceCreateThumbnailAtIndex(source, 0, thumbnailOptions) else { return nil }
+
+        let isOpaque: Bool
+        switch thumbnail.alphaInfo {
+        case .none, .noneSkipFirst, .noneSkipLast:
+            isOpaque = true
+        default:
+            isOpaque = false
+        }
+        let type: UTType = isOpaque ? .jpeg : .png
+        let output = NSMutableData()
+        guard let destination = CGImageDestinationCreateWithData(output, type.identifier as CFString, 1, nil) else { return nil }
+        CGImageDestinationAddImage(destination, thumbnail, [kCGImageDestinationLossyCompressionQuality: 0.85] as CFDictionary)
+        guard CGImageDestinationFinalize(destination) else { return nil }
+        return (output as Data, type)
+    }
+}
@@ -0,0 +1,249 @@
+//  CompiledPostTemplates.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import Foundation
+
+/*
+ Hand-compiled versions of `Post.html.stencil` and `PostsView.html.stencil`.
+
+ Rendering through Stencil means building a `[String: Any]` context per post (with a nested author dictionary and lots of boxed values), then resolving each variable by name. These renderers read straight from the model structs and append into one buffer instead. Output is the same as Stencil's, which `CompiledPostTemplatesTests` checks. If you change either template, change its renderer here too.
+ */
+
+extension PostRenderModel {
+
+    /// Same as rendering `Post.html.stencil` with `context`.
+    var html: String {
+        var html = ""
+        html.reserveCapacity(estimatedHTMLLength)
+        appendHTML(to: &html)
+        return html
+    }
+
+    /// A guess that's usually a little too big, for reserving buffer space.
+    var estimatedHTMLLength: Int {
+        return htmlContents.utf8.count + customTitleHTML.utf8.count + 1600
+    }
+
+    /// Appends the result of rendering `Post.html.stencil` with `context`.
+    func appendHTML(to html: inout String) {
+        let hasCustomTitle = !customTitleHTML.isEmpty
+
+        html += "<post\n    id=\""
+        html += postID
+        html += "\"\n    class=\""
+        if beenSeen { html += " seen " }
+        html += "\n           "
+        html.appendHTMLEscaped(roles)
+        html += "\n           "
+        if visibleAvatarURL == nil { html += " no-avatar " }
+        html += "\n           "
+        if hasCustomTitle { html += " responsive " }
+        html += "\">\n\n    <header\n        class=\"userid-"
+        html.appendHTMLEscaped(authorUserID)
+        html += " "
+        if hasCustomTitle { html += " responsive " }
+        html += "\"\n        "
+        if hideMetadataForReader { html += " aria-hidden=\"true\" " }
+        html += "\n        "
+        if let hiddenAvatarURL {
+            html += " data-awful-avatar=\""
+            html.appendHTMLEscaped(hiddenAvatarURL.absoluteString)
+            html += "\" "
+        }
+        html += ">\n\n        "
+        if let visibleAvatarURL, !hasCustomTitle {
+            html += "\n        <img class=\"avatar\" src=\""
+            html += visibleAvatarURL.absoluteString
+            html += "\" alt=\"\">\n        "
+        }
+        html += "\n\n\t\t<section class=\"nameanddate\">\n            <span class=\"username\">\n                "
+        html.appendHTMLEscaped(authorUsername)
+        html += "\n            </span>\n\n            "
+        for role in accessibilityRoles {
+            html += "\n            <span class=\"voiceover-only\">\n                "
+            html.appendHTMLEscaped(role)
+            html += "\n            </span>\n            "
+        }
+        html += "\n\n            "
+        if showRegdate {
+            html += "\n            <time class=\"regdate\">\n                "
+            html += authorRegdateRaw
+            html += "\n            </time>\n            "
+        }
+        html += "\n        </section>\n        \n        "
+        if visibleAvatarURL != nil, hasCustomTitle {
+            html += "\n            <div class=\"customTitle responsive\">\n                "
+            html += customTitleHTML
+            html += "\n            </div>\n        "
+        }
+        html += "\n    </header>\n\n    <section class=\"postbody "
+        if hasCustomTitle { html += " responsive " }
+        html += "\">\n        "
+        html += htmlContents
+        html += "\n    </section>\n\n\t<footer "
+        if hideMetadataForReader { html += " aria-hidden=\"true\" " }
+        html += ">\n        <span class=\"divider"
+        if beenSeen { html += " divider-seen " }
+        html += "\"></span>\n        <span class=\"postdate\">\n            "
+        html += "\n                "
+        html += postDateRaw.isEmpty ? postDate : postDateRaw
+        html += "\n            "
+        html += "\n        </span>\n\n        <button class=\"action-button\" title=\"Post actions\">\n            <img src=\"awful-resource://post-dots.png\">\n        </button>\n\t</footer>\n</post>\n"
+    }
+}
+
+/// Everything `PostsView.html.stencil` needs to render a page of posts.
+struct PostsViewRenderModel {
+    var advertisementHTML: String = ""
+    var baseURL: String = StencilEnvironment.baseURL
+    var enableFrogAndGhost: Bool = false
+    var endMessage: Bool = false
+    var externalStylesheet: String = ""
+    var fontScaleStyle: String = fontScaleStyleHTML()
+    var forumID: String = ""
+    var ghostJsonData: String = ""
+    var posts: [PostRenderModel] = []
+    var stylesheet: String = ""
+    var threadID: String = ""
+    var tweetTheme: String = ""
+    var userInterfaceIdiom: String = StencilEnvironment.userInterfaceIdiom
+    var version: String = StencilEnvironment.version
+
+    /// Same as rendering `PostsView.html.stencil` with `context`.
+    var html: String {
+        var html = ""
+        html.reserveCapacity(
+            stylesheet.utf8.count
+            + externalStylesheet.utf8.count
+            + (enableFrogAndGhost ? ghostJsonData.utf8.count : 0)
+            + advertisementHTML.utf8.count
+            + posts.reduce(0) { $0 + $1.estimatedHTMLLength + 10 }
+            + 2000)
+
+        html += "<!DOCTYPE html>\n<meta charset=\"utf-8\">\n<meta name=\"viewport\" content=\"width=320, initial-scale=0.99, viewport-fit=cover\">\n\n"
+        if !baseURL.isEmpty {
+            html += "<base href=\""
+            html.appendHTMLEscaped(baseURL)
+            html += "\">"
+        }
+        html += "\n\n<title>Awful - Thread</title>\n\n<style id=\"awful-inline-style\">\n"
+        html += stylesheet
+        html += "\n</style>\n\n<style id=\"awful-external-style\">\n"
+        html += externalStylesheet
+        html += "\n</style>\n\n"
+        html += fontScaleStyle
+        html += "\n\n<script>\n\n</script>\n\n<body\n    class=\""
+        html += userInterfaceIdiom
+        html += "\n           "
+        if !threadID.isEmpty {
+            html += " thread-"
+            html.appendHTMLEscaped(threadID)
+            html += " "
+        }
+        html += "\n           "
+        if !forumID.isEmpty {
+            html += " forum-"
+            html.appendHTMLEscaped(forumID)
+            html += " "
+        }
+        html += "\"\n    data-version=\""
+        html += version
+        html += "\"\n    data-tweet-theme=\""
+        html += tweetTheme
+        html += "\">\n    \n    <div id=\"posts\">\n    "
+        appendPostsHTML(to: &html)
+        html += "\n    </div>\n\n    <div id=\"ad\">\n        "
+        html += advertisementHTML
+        html += "\n    </div>\n    \n    "
+        if enableFrogAndGhost {
+            html += "\n    <div id=\"ghost-json-data\" style=\"display:none;\">\n        "
+            html += ghostJsonData
+            html += "\n    </div>\n    "
+        }
+        html += "\n    \n    "
+        if endMessage, enableFrogAndGhost {
+            html += "\n        "
+            html += endMessageHTML
+            html += "\n    "
+        }
+        html += "\n    \n    "
+        if endMessage, !enableFrogAndGhost {
+            html += "\n    "
+            html += endMessageHTML
+            html += "\n    "
+        }
+        html += "\n</body>\n"
+        return html
+    }
+
+    /**
+     The parts of `html` that change from one page to the next: the posts, the advertisement, and the end-of-thread message.
+
+     A document already rendered from `html` can show a different page by swapping these in (see `RenderView.replacePosts(_:)`), keeping everything else it loaded. That only works when the rest of the document would come out the same, i.e. when `shell` matches.
+     */
+    var pageFragments: PageFragments {
+        var postsHTML = ""
+        postsHTML.reserveCapacity(posts.reduce(0) { $0 + $1.estimatedHTMLLength + 10 })
+        appendPostsHTML(to: &postsHTML)
+        return PageFragments(
+            postsHTML: postsHTML,
+            advertisementHTML: advertisementHTML,
+            endMessageHTML: endMessage ? endMessageHTML : "")
+    }
+
+    struct PageFragments {
+        var postsHTML: String
+        var advertisementHTML: String
+
+        /// Empty when there's no end-of-thread message.
+        var endMessageHTML: String
+    }
+
+    /// Everything in `html` that isn't one of the `pageFragments` and can't be changed in place by `RenderView`. (Stylesheets and font scale are left out because they can.)
+    var shell: Shell {
+        Shell(baseURL: baseURL, enableFrogAndGhost: enableFrogAndGhost, forumID: forumID, threadID: threadID, tweetTheme: tweetTheme)
+    }
+
+    struct Shell: Equatable {
+        var baseURL: String
+        var enableFrogAndGhost: Bool
+        var forumID: String
+        var threadID: String
+        var tweetTheme: String
+    }
+
+    private func appendPostsHTML(to html: inout String) {
+        for post in posts {
+            html += "\n        "
+            post.appendHTML(to: &html)
+            html += "\n    "
+        }
+    }
+
+    private var endMessageHTML: String {
+        if enableFrogAndGhost {
+            return "<div id=\"endf\" class=\".end\" style=\"height: 100px;\"></div>"
+        } else {
+            return "<div id=\"end\" class=\".end\">\n        End of the thread\n    </div>"
+        }
+    }
+
+    /// A context for rendering `PostsView.html.stencil` with Stencil. The compiled renderer doesn't need this; it's for checking the two agree.
+    var context: [String: Any] {
+        return [
+            "advertisementHTML": advertisementHTML,
+            "baseURL": baseURL,
+            "enableFrogAndGhost": enableFrogAndGhost,
+            "endMessage": endMessage,
+            "externalStylesheet": externalStylesheet,
+            "forumID": forumID,
+            "ghostJsonData": ghostJsonData,
+            "posts": posts.map { $0.context },
+            "stylesheet": stylesheet,
+            "threadID": threadID,
+            "tweetTheme": tweetTheme,
+            "userInterfaceIdiom": userInterfaceIdiom,
+            "version": version]
+    }
+}
@@ -0,0 +1,94 @@
+//  MassagedPostHTMLCache.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import Foundation
+import os
+
+private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category: "MassagedPostHTMLCache")
+
+/**
+ Remembers the result of turning a post's `innerHTML` into what we actually render, so that re-rendering a page (after a theme change, returning to the page, or showing hidden posts) skips parsing and rewriting each post.
+
+ Entries are keyed by post ID and remember what they were made from: a hash of the post's `innerHTML`, whether the post is ignored, its forum, and the relevant settings. If any of those change, the entry is remade.
+ */
+final class MassagedPostHTMLCache {
+
+    static let shared = MassagedPostHTMLCache()
+
+    private let cache = NSCache<NSString, Entry>()
+    private let lock = NSLock()
+    private var _hits = 0
+    private var _misses = 0
+
+    init() {
+        cache.countLimit = 2000
+    }
+
+    /// How many times a post's HTML came from the cache.
+    var hits: Int { withLock { _hits } }
+
+    /// How many times a post's HTML needed massaging.
+    var misses: Int { withLock { _misses } }
+
+    func resetStatistics() {
+        withLock {
+            _hits = 0
+            _misses = 0
+        }
+    }
+
+    func removeAllObjects() {
+        cache.removeAllObjects()
+    }
+
+    /// Returns the cached HTML for the post if it's still valid, otherwise calls `massage` and caches its result.
+    func html(
+        postID: String,
+        innerHTML: String,
+        isIgnored: Bool,
+        forumID: String,
+        settings: PostHTMLSettings,
+        massage: (_ innerHTML: String, _ isIgnored: Bool, _ forumID: String, _ settings: PostHTMLSettings) -> String
+    ) -> String {
+        let key = Key(innerHTMLHash: innerHTML.hashValue, isIgnored: isIgnored, forumID: forumID, settings: settings)
+        if let entry = cache.object(forKey: postID as NSString), entry.key == key {
+            withLock { _hits += 1 }
+            return entry.html
+        }
+
+        withLock { _misses += 1 }
+        let html = massage(innerHTML, isIgnored, forumID, settings)
+        cache.setObject(Entry(key: key, html: html), forKey: postID as NSString)
+        return html
+    }
+
+    /// Logs hits and misses so far.
+    func logStatistics() {
+        let (hits, misses) = withLock { (_hits, _misses) }
+        logger.debug("massaged post HTML cache: \(hits) hits, \(misses) misses")
+    }
+
+    private func withLock<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+
+    private struct Key: Equatable {
+        let innerHTMLHash: Int
+        let isIgnored: Bool
+        let forumID: String
+        let settings: PostHTMLSettings
+    }
+
+    private final class Entry {
+        let key: Key
+        let html: String
+
+        init(key: Key, html: String) {
+            self.key = key
+            self.html = html
+        }
+    }
+}
@@ -9,10 +9,55 @@ import AwfulTheming
 import HTMLReader
 import UIKit
 
-struct PostRenderModel: StencilContextConvertible {
-    let context: [String: Any]
+/// Everything `Post.html.stencil` needs to render a post. Render it via `context` or, faster, via `appendHTML(to:)`.
+struct PostRenderModel: Equatable, StencilContextConvertible {
+    var accessibilityRoles: [String]
+    var authorRegdate: Date?
+    var authorRegdateRaw: String
+    var authorUserID: String
+    var authorUsername: String
+    var beenSeen: Bool
+    /// Empty when the custom title layout is off.
+    var customTitleHTML: String
+    var hiddenAvatarURL: URL?
+    var hideMetadataForReader: Bool
+    var htmlContents: String
+    var postDate: String
+    var postDateRaw: String
+    var postID: String
+    var roles: String
+    var showAvatars: Bool
+    var showRegdate: Bool
+    var visibleAvatarURL: URL?
 
-    init(_ post: Post) {
+    var context: [String: Any] {
+        return [
+            "accessibilityRoles": accessibilityRoles,
+            "author": [
+                "regdate": authorRegdate as Any,
+                "regdateRaw": authorRegdateRaw,
+                "userID": authorUserID,
+                "username": authorUsername],
+            "beenSeen": beenSeen,
+            "customTitleHTML": customTitleHTML,
+            "hiddenAvatarURL": hiddenAvatarURL as Any,
+            "hideMetadataForReader": hideMetadataForReader,
+            "htmlContents": htmlContents,
+            "postDate": postDate,
+            "postDateRaw": postDateRaw,
+            "postID": postID,
+            "roles": roles,
+            "showAvatars": showAvatars,
+            "showRegdate": showRegdate,
+            "visibleAvatarURL": visibleAvatarURL as Any]
+    }
+}
+
+extension PostRenderModel {
+    /**
+     - Parameter htmlSettings: Pass the same settings when rendering several posts at once, to avoid rereading them for each post.
+     */
+    init(_ post: Post, htmlSettings: PostHTMLSettings = .current) {
         var roles: String {
             guard let author = post.author else { return "" }
             var roles = author.authorClasses ?? ""
@@ -21,16 +66,6 @@ struct PostRenderModel: StencilContextConvertible {
             }
             return roles
         }
-        var accessibilityRoles: String {
-            let spokenRoles = [
-                "ik": "internet knight",
-                "op": "original poster",
-                ]
-            return roles
-                .components(separatedBy: .whitespacesAndNewlines)
-                .map { spokenRoles[$0] ?? $0 }
-                .joined(separator: "; ")
-        }
         var forumID: String {
             return post.thread?.forum?.forumID ?? ""
         }
@@ -40,94 +75,96 @@ struct PostRenderModel: StencilContextConvertible {
             }
             return true
         }
-        var showAvatars: Bool { Awful.showAvatars }
-        var hiddenAvatarURL: URL? {
-            return showAvatars ? nil : post.author?.avatarURL
-        }
-        var htmlContents: String {
-            return massageHTML(post.innerHTML ?? "", isIgnored: post.ignored, forumID: forumID)
-        }
-        var visibleAvatarURL: URL? {
-            return showAvatars ? post.author?.avatarURL : nil
-        }
-        var customTitleHTML: String {
-            let html = post.author?.customTitleHTML
-            return html ?? ""
-        }
-        var postDateRaw: String {
-            return post.postDateRaw ?? ""
-        }
+        let showAvatars = Awful.showAvatars
 
-        context = [
-            "accessibilityRoles": accessibilityRoles,
-            "author": [
-                "regdate": post.author?.regdate as Any,
-                "regdateRaw": post.author?.regdateRaw as Any,
-                "userID": post.author?.userID as Any,
-                "username": post.author?.username as Any],
-            "beenSeen": post.beenSeen,
-            "customTitleHTML": (enableCustomTitlePostLayout ? post.author?.customTitleHTML : nil) as Any,
-            "hiddenAvatarURL": hiddenAvatarURL as Any,
-            "hideMetadataForReader": hidePostMetadataForReader,
-            "htmlContents": htmlContents,
-            "postDate": post.postDate as Any,
-            "postDateRaw": postDateRaw as String,
-            "postID": post.postID,
-            "roles": roles,
-            "showAvatars": showAvatars,
-            "showRegdate": showRegdate,
-            "visibleAvatarURL": visibleAvatarURL as Any]
+        self.roles = roles
+        accessibilityRoles = spokenRoles(roles)
+        authorRegdate = post.author?.regdate
+        authorRegdateRaw = post.author?.regdateRaw ?? ""
+        authorUserID = post.author?.userID ?? ""
+        authorUsername = post.author?.username ?? ""
+        beenSeen = post.beenSeen
+        customTitleHTML = (enableCustomTitlePostLayout ? post.author?.customTitleHTML : nil) ?? ""
+        hiddenAvatarURL = showAvatars ? nil : post.author?.avatarURL
+        hideMetadataForReader = hidePostMetadataForReader
+        htmlContents = MassagedPostHTMLCache.shared.html(
+            postID: post.postID,
+            innerHTML: post.innerHTML ?? "",
+            isIgnored: post.ignored,
+            forumID: forumID,
+            settings: htmlSettings,
+            massage: massageHTML)
+        postDate = post.postDate.map { "\($0)" } ?? ""
+        postDateRaw = post.postDateRaw ?? ""
+        postID = post.postID
+        self.showAvatars = showAvatars
+        self.showRegdate = showRegdate
+        visibleAvatarURL = showAvatars ? post.author?.avatarURL : nil
     }
 
     init(author: User, isOP: Bool, postDate: String, postHTML: String) {
-        context = [
-            "author": [
-                "regdate": author.regdate as Any,
-                "userID": author.userID,
-                "username": author.username as Any],
-            "beenSeen": false,
-            "hiddenAvatarURL": (showAvatars ? author.avatarURL : nil) as Any,
-            "hideMetadataForReader": hidePostMetadataForReader,
-            "customTitleHTML": (enableCustomTitlePostLayout ? author.customTitleHTML : nil) as Any,
-            "htmlContents": massageHTML(postHTML, isIgnored: false, forumID: ""),
-            "postDate": postDate,
-            "postDateRaw": "",
-            "postID": "fake",
-            "roles": (isOP ? "op " : "") + (author.authorClasses ?? ""),
-            "showAvatars": showAvatars,
-            "visibleAvatarURL": (showAvatars ? author.avatarURL : nil) as Any]
+        let showAvatars = Awful.showAvatars
+
+        roles = (isOP ? "op " : "") + (author.authorClasses ?? "")
+        accessibilityRoles = spokenRoles(roles)
+        authorRegdate = author.regdate
+        authorRegdateRaw = ""
+        authorUserID = author.userID
+        authorUsername = author.username ?? ""
+        beenSeen = false
+        customTitleHTML = (enableCustomTitlePostLayout ? author.customTitleHTML : nil) ?? ""
+        hiddenAvatarURL = showAvatars ? author.avatarURL : nil
+        hideMetadataForReader = hidePostMetadataForReader
+        htmlContents = massageHTML(postHTML, isIgnored: false, forumID: "", settings: .current)
+        self.postDate = postDate
+        postDateRaw = ""
+        postID = "fake"
+        self.showAvatars = showAvatars
+        showRegdate = false
+        visibleAvatarURL = showAvatars ? author.avatarURL : nil
     }
 }
 
-private func massageHTML(_ html: String, isIgnored: Bool, forumID: String) -> String {
-    let document = HTMLDocument(string: html)
-    document.removeSpoilerStylingAndEvents()
-    document.removeEmptyEditedByParagraphs()
-    document.addAttributeToBlueskyLinks()
-    document.addAttributeToTweetLinks()
-    let embedVideos = UserDefaults.standard.defaultingValue(for: Settings.embedVideos)
-    if embedVideos {
-        document.useHTML5VimeoPlayer()
-    }
-    if let username = UserDefaults.standard.value(for: Settings.username) {
-        document.identifyQuotesCitingUser(named: username, shouldHighlight: true)
-        document.identifyMentionsOfUser(named: username, shouldHighlight: true)
-    }
-    document.processImgTags(shouldLinkifyNonSmilies: !UserDefaults.standard.defaultingValue(for: Settings.loadImages))
-    if !UserDefaults.standard.defaultingValue(for: Settings.autoplayGIFs) {
-        document.stopGIFAutoplay()
-    }
-    if isIgnored {
-        document.markRevealIgnoredPostLink()
-    }
-    if (ForumTweaks(ForumID(forumID))?.magicCake) == true {
-        document.addMagicCakeCSS()
-    }
-    if embedVideos {
-        document.embedVideos()
-    } else {
-        document.linkifyResidualVideoEmbeds()
+private func spokenRoles(_ roles: String) -> [String] {
+    let spokenRoles = [
+        "ik": "internet knight",
+        "op": "original poster",
+        ]
+    return roles
+        .components(separatedBy: .whitespacesAndNewlines)
+        .filter { !$0.isEmpty }
+        .map { spokenRoles[$0] ?? $0 }
+}
+
+/// The settings that change what `massageHTML` does to a post.
+struct PostHTMLSettings: Hashable {
+    var autoplayGIFs: Bool
+    var downsampleImages: Bool
+    var embedVideos: Bool
+    var loadImages: Bool
+    var username: String?
+
+    static var current: PostHTMLSettings {
+        let defaults = UserDefaults.standard
+        return .init(
+            autoplayGIFs: defaults.defaultingValue(for: Settings.autoplayGIFs),
+            downsampleImages: defaults.defaultingValue(for: Settings.downsampleImages),
+            embedVideos: defaults.defaultingValue(for: Settings.embedVideos),
+            loadImages: defaults.defaultingValue(for: Settings.loadImages),
+            username: defaults.value(for: Settings.username))
     }
+}
+
+private func massageHTML(_ html: String, isIgnored: Bool, forumID: String, settings: PostHTMLSettings) -> String {
+    let document = HTMLDocument(string: html)
+    document.rewritePostBody(.init(
+        embedVideos: settings.embedVideos,
+        isIgnored: isIgnored,
+        linkifyNonSmilies: !settings.loadImages,
+        magicCake: ForumTweaks(ForumID(forumID))?.magicCake == true,
+        stopGIFAutoplay: !settings.autoplayGIFs,
+        username: settings.username,
+        downsampleImages: settings.downsampleImages))
     return document.bodyElement?.innerHTML ?? ""
 }
 
@@ -147,16 +184,3 @@ private var enableCustomTitlePostLayout: Bool {
         return false
     }
 }
-
-private extension HTMLDocument {
-    func markRevealIgnoredPostLink() {
-        guard
-            let link = firstNode(matchingParsedSelector: .cached("a[title=\"DON'T DO IT!!\"]")),
-            let href = link["href"],
-            var components = URLComponents(string: href)
-            else { return }
-        components.fragment = "awful-ignored"
-        guard let replacement = components.url?.absoluteString else { return }
-        link["href"] = replacement
-    }
-}
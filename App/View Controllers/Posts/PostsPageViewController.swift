@@ -16,6 +16,9 @@ import WebKit
 
 private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category: "PostsPageViewController")
 
+/// Only read once, and only if needed.
+private let ghostJsonData = (try? String(contentsOf: URL(string: "ghost60.json", relativeTo: Bundle.main.resourceURL)!, encoding: .utf8)) ?? ""
+
 /// Shows a list of posts in a thread.
 final class PostsPageViewController: ViewController {
     var selectedPost: Post? = nil
@@ -69,9 +72,24 @@ final class PostsPageViewController: ViewController {
     private var anchorDeltaAfterLoading: CGFloat?
     @FoilDefaultStorage(Settings.showAvatars) private var showAvatars
     @FoilDefaultStorage(Settings.loadImages) private var showImages
+    @FoilDefaultStorage(Settings.virtualizePosts) private var virtualizePosts
     let thread: AwfulThread
     private var webViewDidLoadOnce = false
 
+    /// Posts shown by `renderEarlyPosts(_:startingAt:page:)` while the rest of their page loads.
+    private var earlyRenderedPosts: [Post] = []
+    private var earlyRenderedModels: [PostRenderModel] = []
+    private var earlyRenderShowedEndMessage = false
+    /// Early posts rendered after the document started loading but before it finished.
+    private var earlyPostHTMLAwaitingLoad: [String] = []
+
+    /// Describes the document loaded in the render view, whose posts can be swapped out instead of loading a new document. `nil` until a document finishes loading.
+    private var loadedShell: PostsViewRenderModel.Shell?
+    /// Describes the document the render view is loading.
+    private var shellAwaitingLoad: PostsViewRenderModel.Shell?
+    /// Incremented by each call to `renderPosts()`, so a render that finishes preparing after a later one started can give up.
+    private var renderGeneration = 0
+
     // this is to overcome not being allowed to mark stored properties as potentially unavailable using @available
     private var _liquidGlassTitleView: UIView?
 
@@ -154,7 +172,6 @@ final class PostsPageViewController: ViewController {
         postsView.renderView.registerMessage(RenderView.BuiltInMessage.DidTapPostActionButton.self)
         postsView.renderView.registerMessage(RenderView.BuiltInMessage.DidTapAuthorHeader.self)
         postsView.renderView.registerMessage(RenderView.BuiltInMessage.FetchOEmbedFragment.self)
-        postsView.renderView.registerMessage(RenderView.BuiltInMessage.FetchAttachmentImage.self)
         postsView.renderView.registerMessage(RenderView.BuiltInMessage.ImageLoadProgress.self)
         postsView.topBar.goToParentForum = { [unowned self] in
             guard let forum = self.thread.forum else { return }
@@ -337,9 +354,25 @@ final class PostsPageViewController: ViewController {
             let firstUnreadPost: Int?
             let advertisementHTML: String
         }
-        let fetch = Task {
-            let result = try await ForumsClient.shared.listPosts(in: thread, writtenBy: author, page: newPage, updateLastReadPost: updateLastReadPost)
-            return FetchResult(posts: result.posts, firstUnreadPost: result.firstUnreadPost, advertisementHTML: result.advertisementHTML)
+        earlyRenderedPosts = []
+        earlyRenderedModels = []
+        earlyPostHTMLAwaitingLoad = []
+        let canRenderEarly = !renderedCachedPosts && !reloadingSamePage
+        let fetch = Task { [weak self] in
+            let updates = ForumsClient.shared.streamPosts(in: thread, writtenBy: author, page: newPage, updateLastReadPost: updateLastReadPost)
+            var receivedPostCount = 0
+            for try await update in updates {
+                switch update {
+                case .posts(let batch, pageStartsUnseen: let pageStartsUnseen):
+                    if canRenderEarly, pageStartsUnseen {
+                        self?.renderEarlyPosts(batch, startingAt: receivedPostCount, page: newPage)
+                    }
+                    receivedPostCount += batch.count
+                case let .finished(posts: posts, firstUnreadPost: firstUnreadPost, advertisementHTML: advertisementHTML):
+                    return FetchResult(posts: posts, firstUnreadPost: firstUnreadPost, advertisementHTML: advertisementHTML)
+                }
+            }
+            throw CancellationError()
         }
         cancelNetworkOperation = { fetch.cancel() }
         Task { [weak self] in
@@ -416,7 +449,12 @@ final class PostsPageViewController: ViewController {
                     self.scrollToFractionAfterLoading = self.postsView.renderView.scrollView.fractionalContentOffset.y
                 }
 
-                self.renderPosts()
+                if !self.earlyRenderIsComplete {
+                    self.earlyPostHTMLAwaitingLoad = []
+                    self.renderPosts()
+                }
+                self.earlyRenderedPosts = []
+                self.earlyRenderedModels = []
 
                 self.updateUserInterface()
 
@@ -464,6 +502,64 @@ final class PostsPageViewController: ViewController {
         }
     }
 
+    /**
+     Shows posts from a page that's still loading.
+
+     Only done when the rest of the page can simply be tacked on the end: a specific page whose posts won't be hidden as already-seen, with no particular post or scroll position to restore once it's done.
+     */
+    private func renderEarlyPosts(_ batch: [Post], startingAt start: Int, page newPage: ThreadPage) {
+        guard page == newPage,
+              case .specific = newPage,
+              hiddenPosts == 0,
+              hiddenPostsAfterLoading == nil,
+              jumpToPostIDAfterLoading == nil,
+              !jumpToLastPost,
+              anchorPostIDAfterLoading == nil,
+              scrollToFractionAfterLoading == nil
+        else { return }
+
+        // Once we've skipped a batch, there's a hole in the page. Wait for the whole thing instead.
+        guard earlyRenderedPosts.count == start else { return }
+
+        // Posts saved early can be missing things that only get saved along with the whole page (e.g. the thread's author and forum), so remember exactly what got rendered.
+        let models = batch.map { PostRenderModel($0) }
+        if start == 0 {
+            earlyRenderedPosts = batch
+            earlyRenderedModels = models
+            posts = batch
+            earlyRenderShowedEndMessage = isShowingLastPage
+            renderPosts()
+        } else {
+            earlyRenderedPosts += batch
+            earlyRenderedModels += models
+            posts = earlyRenderedPosts
+            let html = (start..<posts.count).map(renderedPostAtIndex).joined(separator: "\n")
+            if webViewDidLoadOnce {
+                postsView.renderView.appendPostHTML(html)
+            } else {
+                earlyPostHTMLAwaitingLoad.append(html)
+            }
+        }
+    }
+
+    /// Whether the finished page looks exactly like the posts already rendered by `renderEarlyPosts(_:startingAt:page:)`, so there's no need to render it again. Compares each post's render model, so anything that changed once the whole page was saved (OP highlighting, forum-specific massaging, seen posts) gets rendered.
+    private var earlyRenderIsComplete: Bool {
+        !earlyRenderedPosts.isEmpty
+            && earlyRenderedPosts == posts
+            && hiddenPosts == 0
+            && (advertisementHTML ?? "").isEmpty
+            && earlyRenderShowedEndMessage == isShowingLastPage
+            && posts.map({ PostRenderModel($0) }) == earlyRenderedModels
+    }
+
+    private var isShowingLastPage: Bool {
+        if case .specific(let pageNumber)? = page, pageNumber >= numberOfPages {
+            return true
+        } else {
+            return false
+        }
+    }
+
     /// Scroll the posts view so that a particular post is visible (if the post is on the current(ly loading) page).
     func scrollPostToVisible(_ post: Post) {
         let i = posts.firstIndex(of: post)
@@ -490,50 +586,53 @@ final class PostsPageViewController: ViewController {
     private func renderPosts() {
         webViewDidLoadOnce = false
 
-        var context: [String: Any] = [:]
+        var model = PostsViewRenderModel()
 
-        context["stylesheet"] = theme[string: "postsViewCSS"] as Any
+        model.stylesheet = theme[string: "postsViewCSS"] ?? ""
 
         if posts.count > hiddenPosts {
-            let subset = posts[hiddenPosts...]
-            context["posts"] = subset.map { PostRenderModel($0).context }
-        }
-
-        if let ad = advertisementHTML, !ad.isEmpty {
-            context["advertisementHTML"] = ad
+            let htmlSettings = PostHTMLSettings.current
+            model.posts = posts[hiddenPosts...].map { PostRenderModel($0, htmlSettings: htmlSettings) }
+            MassagedPostHTMLCache.shared.logStatistics()
         }
 
-        if context["posts"] != nil, case .specific(let pageNumber)? = page, pageNumber >= numberOfPages {
-            context["endMessage"] = true
-        }
+        model.advertisementHTML = advertisementHTML ?? ""
 
-        context["enableFrogAndGhost"] = frogAndGhostEnabled
+        model.endMessage = !model.posts.isEmpty && isShowingLastPage
 
-        context["ghostJsonData"] = try? String(contentsOf: URL(string: "ghost60.json", relativeTo: Bundle.main.resourceURL)!, encoding: .utf8)
+        model.enableFrogAndGhost = frogAndGhostEnabled
 
-        if let loggedInUsername, !loggedInUsername.isEmpty {
-            context["loggedInUsername"] = loggedInUsername
+        if frogAndGhostEnabled {
+            model.ghostJsonData = ghostJsonData
         }
 
-        context["externalStylesheet"] = PostsViewExternalStylesheetLoader.shared.stylesheet
+        model.externalStylesheet = PostsViewExternalStylesheetLoader.shared.stylesheet ?? ""
 
-        if !thread.threadID.isEmpty {
-            context["threadID"] = thread.threadID
-        }
+        model.threadID = thread.threadID
 
-        if let forum = thread.forum, !forum.forumID.isEmpty {
-            context["forumID"] = forum.forumID
-        }
+        model.forumID = thread.forum?.forumID ?? ""
 
-        context["tweetTheme"] = theme[string: "postsTweetTheme"] ?? "light"
+        model.tweetTheme = theme[string: "postsTweetTheme"] ?? "light"
 
-        Task.detached(priority: .userInitiated) { [context] in
-            let html: String
-            do {
-                html = try StencilEnvironment.shared.renderTemplate(.postsView, context: context)
-            } catch {
-                logger.error("could not render posts view HTML: \(error)")
-                html = ""
+        renderGeneration += 1
+        let generation = renderGeneration
+        let canReplacePosts = loadedShell == model.shell
+
+        Task.detached(priority: .userInitiated) { [model] in
+            // Changing pages in an already-loaded document skips reloading and re-parsing its scripts and stylesheets.
+            if canReplacePosts {
+                let fragments = model.pageFragments
+                guard await self.renderGeneration == generation else { return }
+                if await self.postsView.renderView.replacePosts(fragments) {
+                    return
+                }
+            }
+
+            let html = model.html
+            guard await self.renderGeneration == generation else { return }
+            await MainActor.run {
+                self.loadedShell = nil
+                self.shellAwaitingLoad = model.shell
             }
 
             await self.postsView.renderView.eraseDocument()
@@ -1011,13 +1110,7 @@ final class PostsPageViewController: ViewController {
     }
 
     private func renderedPostAtIndex(_ i: Int) -> String {
-        do {
-            let model = PostRenderModel(posts[i])
-            return try StencilEnvironment.shared.renderTemplate(.post, context: model)
-        } catch {
-            logger.error("could not render post at index \(i): \(error)")
-            return ""
-        }
+        return PostRenderModel(posts[i]).html
     }
 
     private func readIgnoredPostAtIndex(_ i: Int) {
@@ -1611,23 +1704,6 @@ final class PostsPageViewController: ViewController {
         }
     }
 
-    private func fetchAttachmentImage(attachmentID: String, id: String) {
-        Task {
-            do {
-                let imageData = try await ForumsClient.shared.fetchAttachmentImageByID(attachmentID: attachmentID)
-                if let image = UIImage(data: imageData), let pngData = image.pngData() {
-                    let base64 = pngData.base64EncodedString()
-                    let dataURL = "data:image/png;base64,\(base64)"
-                    await MainActor.run {
-                        postsView.renderView.didFetchAttachmentImage(id: id, dataURL: dataURL)
-                    }
-                }
-            } catch {
-                logger.error("Failed to fetch attachment image \(attachmentID): \(error)")
-            }
-        }
-    }
-
     private func presentDraftMenu(
         from source: DraftMenuSource,
         options: DraftMenuOptions
@@ -1985,6 +2061,12 @@ final class PostsPageViewController: ViewController {
             .receive(on: RunLoop.main)
             .sink { [weak self] _ in self?.postsView.renderView.loadLinkifiedImages() }
             .store(in: &cancellables)
+
+        $virtualizePosts
+            .dropFirst()
+            .receive(on: RunLoop.main)
+            .sink { [weak self] in self?.postsView.renderView.setVirtualizePosts($0) }
+            .store(in: &cancellables)
     }
 
     override func viewDidLayoutSubviews() {
@@ -2114,7 +2196,18 @@ extension PostsPageViewController: RenderViewDelegate {
             view.embedTweets()
         }
 
+        view.setVirtualizePosts(virtualizePosts)
+
         webViewDidLoadOnce = true
+        if let shell = shellAwaitingLoad {
+            loadedShell = shell
+            shellAwaitingLoad = nil
+        }
+
+        for html in earlyPostHTMLAwaitingLoad {
+            view.appendPostHTML(html)
+        }
+        earlyPostHTMLAwaitingLoad = []
 
         if jumpToLastPost {
             if posts.count > 0 {
@@ -2182,9 +2275,6 @@ extension PostsPageViewController: RenderViewDelegate {
         case let message as RenderView.BuiltInMessage.FetchOEmbedFragment:
             fetchOEmbed(url: message.url, id: message.id)
 
-        case let message as RenderView.BuiltInMessage.FetchAttachmentImage:
-            fetchAttachmentImage(attachmentID: message.attachmentID, id: message.id)
-
         case let message as RenderView.BuiltInMessage.ImageLoadProgress:
             if message.total == 0 {
                 // No images to load, dismiss immediately
@@ -2231,6 +2321,7 @@ extension PostsPageViewController: RenderViewDelegate {
     }
 
     func renderProcessDidTerminate(in view: RenderView) {
+        loadedShell = nil
         renderPosts()
     }
 }
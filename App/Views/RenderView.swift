@@ -68,6 +68,11 @@ final class RenderView: UIView {
 
         configuration.setURLSchemeHandler(ImageURLProtocol(), forURLScheme: ImageURLProtocol.scheme)
         configuration.setURLSchemeHandler(ResourceURLProtocol(), forURLScheme: ResourceURLProtocol.scheme)
+        configuration.setURLSchemeHandler(AttachmentImageURLSchemeHandler(), forURLScheme: AttachmentImageURLSchemeHandler.scheme)
+        configuration.setURLSchemeHandler(
+            // Native bounds are always portrait. Posts can be as wide as the screen in landscape (e.g. on iPad), so go by the longer side.
+            DownsampledImageURLSchemeHandler(maximumWidth: Int(max(UIScreen.main.nativeBounds.width, UIScreen.main.nativeBounds.height))),
+            forURLScheme: DownsampledImageURLSchemeHandler.scheme)
 
         let webView = WKWebView(frame: .zero, configuration: configuration)
         webView.isOpaque = false
@@ -306,27 +311,6 @@ extension RenderView: WKScriptMessageHandler {
             }
         }
 
-        struct FetchAttachmentImage: RenderViewMessage {
-            static let messageName = "fetchAttachmentImage"
-
-            /// An opaque `id` to use when calling back with the response.
-            let id: String
-
-            /// The attachment ID to fetch.
-            let attachmentID: String
-
-            init?(rawMessage: WKScriptMessage, in renderView: RenderView) {
-                assert(rawMessage.name == Self.messageName)
-                guard let body = rawMessage.body as? [String: Any],
-                      let id = body["id"] as? String,
-                      let attachmentID = body["attachmentid"] as? String
-                else { return nil }
-
-                self.id = id
-                self.attachmentID = attachmentID
-            }
-        }
-
         /// Sent from the web view to report image loading progress.
         struct ImageLoadProgress: RenderViewMessage {
             static let messageName = "imageLoadProgress"
@@ -601,18 +585,6 @@ extension RenderView {
         }
     }
 
-    func didFetchAttachmentImage(id: String, dataURL: String) {
-        Task {
-            do {
-                try await webView.eval("""
-                    window.Awful?.didFetchAttachmentImage(\(escapeForEval(id)), \(escapeForEval(dataURL)));
-                """)
-            } catch {
-                logger.error("error calling back after fetching attachment image: \(error)")
-            }
-        }
-    }
-
     /**
      How far the web document is offset from the scroll view's bounds.
 
@@ -726,6 +698,59 @@ extension RenderView {
         }
     }
     
+    /// Insert some newly-rendered posts below all existing rendered posts.
+    func appendPostHTML(_ postHTML: String) {
+        let escaped: String
+        do {
+            escaped = try escapeForEval(postHTML)
+        } catch {
+            logger.warning("could not JSON-escape the post HTML: \(error)")
+            return
+        }
+
+        Task {
+            do {
+                try await webView.eval("if (window.Awful) Awful.appendPosts(\(escaped))")
+            } catch {
+                self.mentionError(error, explanation: "could not evaluate appendPosts")
+            }
+        }
+    }
+    
+    /**
+     Shows a different page of posts in the already-rendered posts document, without loading a new one. The document's scripts, stylesheets, and other resources stay put.
+
+     The delegate hears `didFinishRenderingHTML(in:)` afterwards, same as when a call to `render(html:baseURL:)` finishes.
+
+     - Returns: `false` if the posts couldn't be swapped in (e.g. the document is still loading, or isn't a posts document), in which case the caller should `render(html:baseURL:)` instead.
+     */
+    func replacePosts(_ fragments: PostsViewRenderModel.PageFragments) async -> Bool {
+        let js: String
+        do {
+            js = """
+                (window.Awful && Awful.replacePosts && document.getElementById('posts'))
+                    ? (Awful.replacePosts(\(try escapeForEval(fragments.postsHTML)), \(try escapeForEval(fragments.advertisementHTML)), \(try escapeForEval(fragments.endMessageHTML))), true)
+                    : false
+                """
+        } catch {
+            logger.warning("could not JSON-escape the page HTML: \(error)")
+            return false
+        }
+
+        let result: Any?
+        do {
+            result = try await webView.eval(js)
+        } catch {
+            mentionError(error, explanation: "could not evaluate replacePosts")
+            return false
+        }
+        guard result as? Bool == true else { return false }
+
+        logger.debug("replaced posts with \(fragments.postsHTML.count) characters of HTML")
+        delegate?.didFinishRenderingHTML(in: self)
+        return true
+    }
+
     /// Replaces an existing post with a new rendering (e.g. after loading the contents of an ignored post).
     func replacePostHTML(_ postHTML: String, at i: Int) {
         let escaped: String
@@ -825,6 +850,17 @@ extension RenderView {
         }
     }
 
+    /// Turns on (when `true`) or off (when `false`) emptying out posts that are far from the visible part of the document, which saves memory on long pages. Posts fill back in as they scroll closer.
+    func setVirtualizePosts(_ enabled: Bool) {
+        Task {
+            do {
+                try await webView.eval("if (window.Awful) Awful.setVirtualizePosts(\(enabled ? "true" : "false"))")
+            } catch {
+                self.mentionError(error, explanation: "could not evaluate setVirtualizePosts")
+            }
+        }
+    }
+
     /// Turns all avatars on (when `true`) or off (when `false`).
     func setShowAvatars(_ showAvatars: Bool) {
         Task {
@@ -27,6 +27,11 @@ let package = Package(
                 "HTMLReader",
             ]
         ),
+        .testTarget(
+            name: "AwfulCoreBenchmarks",
+            dependencies: ["AwfulCore", "AwfulScraping", "HTMLReader"],
+            exclude: ["Baseline.json"]
+        ),
         .testTarget(
             name: "AwfulCoreTests",
             dependencies: ["AwfulCore"],
@@ -8,55 +8,235 @@ import os
 
 private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category: "CachePruner")
 
+/**
+ Deletes cached objects that haven't been touched in a while, plus the least recently touched posts when the cache gets too big.
+
+ Deletion happens at the store level in bounded batches (via `NSBatchDeleteRequest`), so pruning a big cache neither materializes every expired object nor ties up `managedObjectContext`'s queue. Each batch is merged into `managedObjectContext` as it's deleted and announced via `Notification.Name.cachePrunerDidDeleteObjects` for other contexts to merge.
+ */
 final class CachePruner: Operation, @unchecked Sendable {
+
+    struct Policy {
+        /// Objects that haven't been modified for this long are deleted.
+        var maximumAge: TimeInterval = 7 * 24 * 60 * 60
+
+        /// If set, the least recently modified posts beyond this many are deleted.
+        var maximumPostCount: Int?
+
+        /**
+         If set, and the store's files take up more than this many bytes, the least recently modified posts are deleted (in proportion to how far over we are) and the store is vacuumed next time it's loaded.
+
+         Posts are by far the bulk of the store, so they're what we delete.
+         */
+        var maximumStoreSize: Int?
+
+        static let `default` = Policy()
+    }
+
     let managedObjectContext: NSManagedObjectContext
-    
-    init(managedObjectContext context: NSManagedObjectContext) {
+    let policy: Policy
+
+    /// How many objects to delete per batch delete request.
+    let batchSize: Int
+
+    /// Counts deleted objects. Its total is known once expired objects have been found.
+    let progress = Progress(totalUnitCount: -1)
+
+    /// The files that make up the store, for checking `Policy.maximumStoreSize`.
+    var storeURL: URL?
+
+    init(
+        managedObjectContext context: NSManagedObjectContext,
+        policy: Policy = .default,
+        batchSize: Int = 500
+    ) {
         managedObjectContext = context
+        self.policy = policy
+        self.batchSize = batchSize
         super.init()
     }
-    
+
     override func main() {
-        let context = managedObjectContext
-        guard let storeCoordinator = context.persistentStoreCoordinator else { return }
-        let allEntities = storeCoordinator.managedObjectModel.entities
-        let prunableEntities = allEntities.filter { (entity: NSEntityDescription) -> Bool in entity.attributesByName["lastModifiedDate"] != nil }
-        
-        context.performAndWait { () -> Void in
-            var components = DateComponents()
-            components.day = -7
-            let calendar = Calendar(identifier: .gregorian)
-            let oneWeekAgo = calendar.date(byAdding: components, to: Date())!
-            let fetchRequest: NSFetchRequest<NSManagedObjectID> = NSFetchRequest()
-            fetchRequest.predicate = NSPredicate(format: "lastModifiedDate < %@", oneWeekAgo as NSDate)
-            fetchRequest.resultType = .managedObjectIDResultType
-            
-            var candidateObjectIDs: [NSManagedObjectID] = []
+        guard let storeCoordinator = managedObjectContext.persistentStoreCoordinator else { return }
+        let start = Date()
+
+        // Do the work on our own context so `managedObjectContext` (typically on the main queue) stays free.
+        let context = NSManagedObjectContext(concurrencyType: .privateQueueConcurrencyType)
+        context.persistentStoreCoordinator = storeCoordinator
+
+        // Start before anything is deleted, so a body inserted by a save that races with us isn't dropped for want of a post.
+        let bodyStore = storeCoordinator.persistentStores.first.map(PostBodyStore.forPersistentStore(_:))
+        bodyStore?.beginCompaction()
+
+        // An object isn't expired if it's actively in use. Since lastModifiedDate gets updated on save, it's possible to have objects actively in use with an expired lastModifiedDate, and we don't want to delete those.
+        var objectIDsInUse: Set<NSManagedObjectID> = []
+        managedObjectContext.performAndWait {
+            for object in managedObjectContext.registeredObjects {
+                objectIDsInUse.insert(object.objectID)
+                // Deleting a thread takes its posts with it.
+                if object is Post {
+                    objectIDsInUse.formUnion(object.objectIDs(forRelationshipNamed: "thread"))
+                }
+            }
+        }
+
+        var doomed: [(entity: NSEntityDescription, objectIDs: [NSManagedObjectID])] = []
+        var shouldVacuum = false
+        context.performAndWait {
+            // Delete objects that would get cascade-deleted (e.g. posts) before their owners (e.g. threads), so every deletion shows up in a batch's results.
+            let model = storeCoordinator.managedObjectModel
+            let cascadeDestinations = Set(model.entities.flatMap { entity in
+                entity.relationshipsByName.values
+                    .filter { $0.deleteRule == .cascadeDeleteRule }
+                    .compactMap { $0.destinationEntity?.name }
+            })
+            let prunableEntities = model.entities
+                .filter { $0.attributesByName["lastModifiedDate"] != nil }
+                .sorted { cascadeDestinations.contains($0.name ?? "") && !cascadeDestinations.contains($1.name ?? "") }
+            let cutoff = Date(timeIntervalSinceNow: -policy.maximumAge)
             for entity in prunableEntities {
-                fetchRequest.entity = entity
-                do {
-                    let result = try context.fetch(fetchRequest)
-                    candidateObjectIDs.append(contentsOf: result)
+                var objectIDs = fetchObjectIDs(of: entity, in: context) {
+                    $0.predicate = NSPredicate(format: "lastModifiedDate < %@", cutoff as NSDate)
+                }
+
+                if entity.name == Post.entityName, let limit = postCountLimit(in: context, shouldVacuum: &shouldVacuum) {
+                    let alreadyDoomed = Set(objectIDs)
+                    objectIDs += fetchObjectIDs(of: entity, in: context) {
+                        $0.predicate = NSPredicate(format: "lastModifiedDate >= %@", cutoff as NSDate)
+                        $0.sortDescriptors = [NSSortDescriptor(key: "lastModifiedDate", ascending: false)]
+                        $0.fetchOffset = limit
+                    }.filter { !alreadyDoomed.contains($0) }
                 }
-                catch {
-                    logger.error("error fetching: \(error)")
+
+                objectIDs.removeAll { objectIDsInUse.contains($0) }
+                if !objectIDs.isEmpty {
+                    doomed.append((entity, objectIDs))
                 }
             }
-            
-            // An object isn't expired if it's actively in use. Since lastModifiedDate gets updated on save, it's possible to have objects actively in use with an expired lastModifiedDate, and we don't want to delete those.
-            let expiredObjectIDs = candidateObjectIDs.filter { (id: NSManagedObjectID) -> Bool in context.registeredObject(for: id) == nil }
-            
-            for objectID in expiredObjectIDs {
-                let object = context.object(with: objectID)
-                context.delete(object)
+        }
+
+        progress.totalUnitCount = Int64(doomed.reduce(0) { $0 + $1.objectIDs.count })
+
+        var deletedCount = 0
+        batches: for (entity, objectIDs) in doomed {
+            for start in stride(from: 0, to: objectIDs.count, by: batchSize) {
+                guard !isCancelled else { break batches }
+
+                let batch = Array(objectIDs[start..<min(start + batchSize, objectIDs.count)])
+                let deleted = context.performAndWait { () -> [NSManagedObjectID] in
+                    let request = NSBatchDeleteRequest(objectIDs: batch)
+                    request.resultType = .resultTypeObjectIDs
+                    do {
+                        let result = try context.execute(request) as? NSBatchDeleteResult
+                        return result?.result as? [NSManagedObjectID] ?? []
+                    } catch {
+                        logger.error("error batch deleting \(batch.count) \(entity.name ?? "", privacy: .public) objects: \(error)")
+                        return []
+                    }
+                }
+
+                if !deleted.isEmpty {
+                    let changes = [NSDeletedObjectsKey: deleted]
+                    NSManagedObjectContext.mergeChanges(fromRemoteContextSave: changes, into: [managedObjectContext])
+                    NotificationCenter.default.post(name: .cachePrunerDidDeleteObjects, object: self, userInfo: changes)
+                }
+                deletedCount += deleted.count
+                progress.completedUnitCount += Int64(batch.count)
             }
-            
+        }
+
+        if let bodyStore {
+            if deletedCount > 0, !isCancelled {
+                compactPostBodies(bodyStore, in: context)
+            } else {
+                bodyStore.endCompaction()
+            }
+        }
+
+        if shouldVacuum, !isCancelled, let store = storeCoordinator.persistentStores.first {
+            var metadata = storeCoordinator.metadata(for: store)
+            metadata[DataStore.MetadataKey.needsVacuum] = true
+            // Batch deletes don't save anything, so there may not be a save to take this along.
+            storeCoordinator.setMetadataAndWrite(metadata, for: store)
+        }
+
+        let elapsed = Date().timeIntervalSince(start)
+        logger.info("pruned \(deletedCount) of \(self.progress.totalUnitCount) objects in \(elapsed, format: .fixed(precision: 2))s\(self.isCancelled ? " (cancelled)" : "", privacy: .public)")
+    }
+
+    /// Deleted posts leave their bodies behind in the `PostBodyStore`.
+    private func compactPostBodies(_ bodyStore: PostBodyStore, in context: NSManagedObjectContext) {
+        let digests = context.performAndWait { () -> Set<Data>? in
+            let request = NSFetchRequest<NSDictionary>(entityName: Post.entityName)
+            request.resultType = .dictionaryResultType
+            request.propertiesToFetch = ["bodyDigest"]
+            request.predicate = NSPredicate(format: "bodyDigest != nil")
             do {
-                try context.save()
+                return Set(try context.fetch(request).compactMap { $0["bodyDigest"] as? Data })
+            } catch {
+                logger.error("error fetching post body digests: \(error)")
+                return nil
             }
-            catch {
-                logger.error("error saving: \(error)")
+        }
+        guard let digests else {
+            bodyStore.endCompaction()
+            return
+        }
+
+        do {
+            try bodyStore.compact(retaining: digests)
+        } catch {
+            logger.error("error compacting post bodies: \(error)")
+        }
+    }
+
+    private func fetchObjectIDs(
+        of entity: NSEntityDescription,
+        in context: NSManagedObjectContext,
+        configure: (NSFetchRequest<NSManagedObjectID>) -> Void
+    ) -> [NSManagedObjectID] {
+        let request = NSFetchRequest<NSManagedObjectID>()
+        request.entity = entity
+        request.resultType = .managedObjectIDResultType
+        configure(request)
+        do {
+            return try context.fetch(request)
+        } catch {
+            logger.error("error fetching: \(error)")
+            return []
+        }
+    }
+
+    /// How many posts to keep, if the policy limits them.
+    private func postCountLimit(in context: NSManagedObjectContext, shouldVacuum: inout Bool) -> Int? {
+        var limit = policy.maximumPostCount
+
+        if let maximumStoreSize = policy.maximumStoreSize, let storeURL {
+            let storeSize = Self.sizeOfStore(at: storeURL)
+            if storeSize > maximumStoreSize {
+                // Assume posts are spread evenly through the store, and aim a little low so we aren't back here tomorrow.
+                let postCount = Post.count(in: context)
+                let sizeLimited = Int(Double(postCount) * Double(maximumStoreSize) / Double(storeSize) * 0.9)
+                limit = min(limit ?? .max, sizeLimited)
+                shouldVacuum = true
+                logger.info("store is \(storeSize) bytes, over the limit of \(maximumStoreSize); keeping at most \(sizeLimited) of \(postCount) posts")
             }
         }
+
+        return limit
+    }
+
+    /// Sums the size of the SQLite file, its sidecar files, and its pack of post bodies.
+    static func sizeOfStore(at storeURL: URL) -> Int {
+        let paths = ["", "-wal", "-shm"].map { storeURL.path + $0 }
+            + [PostBodyStore.packURL(forStoreURL: storeURL).path]
+        return paths.reduce(0) { total, path in
+            let size = (try? FileManager.default.attributesOfItem(atPath: path))?[.size] as? Int
+            return total + (size ?? 0)
+        }
     }
 }
+
+public extension Notification.Name {
+    /// Posted by a cache pruner (the notification's object) after deleting a batch of objects directly from the store. The user info has the deleted object IDs under `NSDeletedObjectsKey`, suitable for `NSManagedObjectContext.mergeChanges(fromRemoteContextSave:into:)`.
+    static let cachePrunerDidDeleteObjects = Notification.Name("CachePrunerDidDeleteObjects")
+}
@@ -98,10 +98,17 @@ public final class DataStore: NSObject {
         }
         
         let storeURL = storeDirectoryURL.appendingPathComponent("AwfulCache.sqlite")
-        let options = [
+        var options = [
             NSMigratePersistentStoresAutomaticallyOption: true,
             NSInferMappingModelAutomaticallyOption: true
         ]
+
+        // Deleting lots of posts leaves the file just as big, so the pruner asks us to vacuum on the next load (when we're not competing with anyone for the store).
+        let existingMetadata = try? NSPersistentStoreCoordinator.metadataForPersistentStore(ofType: NSSQLiteStoreType, at: storeURL, options: nil)
+        let needsVacuum = existingMetadata?[MetadataKey.needsVacuum] as? Bool ?? false
+        if needsVacuum {
+            options[NSSQLiteManualVacuumOption] = true
+        }
         
         do {
             persistentStore = try storeCoordinator.addPersistentStore(ofType: NSSQLiteStoreType, configurationName: nil, at: storeURL, options: options)
@@ -118,11 +125,19 @@ public final class DataStore: NSObject {
             fatalError("could not load persistent store at \(storeURL): \(error)")
         }
 
+        if needsVacuum, let store = persistentStore {
+            logger.info("vacuumed store after pruning")
+            var metadata = storeCoordinator.metadata(for: store)
+            metadata[MetadataKey.needsVacuum] = nil
+            storeCoordinator.setMetadataAndWrite(metadata, for: store)
+        }
+
         fixParentForumSetToSelf()
     }
 
-    private enum MetadataKey {
+    enum MetadataKey {
         static let didFixParentForumSetToSelf = "com.awfulapp.awful did fix parent forum set to self"
+        static let needsVacuum = "com.awfulapp.awful needs vacuum"
     }
 
     /**
@@ -157,8 +172,13 @@ public final class DataStore: NSObject {
         return queue
         }()
     
+    /// What `prune()` deletes beyond objects that are a week old.
+    var pruningPolicy = CachePruner.Policy(maximumStoreSize: 200 * 1024 * 1024)
+
     func prune() {
-        operationQueue.addOperation(CachePruner(managedObjectContext: mainManagedObjectContext))
+        let pruner = CachePruner(managedObjectContext: mainManagedObjectContext, policy: pruningPolicy)
+        pruner.storeURL = persistentStore?.url
+        operationQueue.addOperation(pruner)
     }
     
     public func deleteStoreAndReset() {
@@ -192,6 +212,20 @@ public final class DataStore: NSObject {
     }
 }
 
+extension NSPersistentStoreCoordinator {
+
+    /// Like `setMetadata(_:for:)`, but also writes the metadata to the store's file right away. Otherwise it's only written by the next save with changes to save, which may never come.
+    func setMetadataAndWrite(_ metadata: [String: Any], for store: NSPersistentStore) {
+        setMetadata(metadata, for: store)
+        guard store.type == NSSQLiteStoreType, let url = store.url else { return }
+        do {
+            try NSPersistentStoreCoordinator.setMetadata(metadata, forPersistentStoreOfType: store.type, at: url, options: store.options)
+        } catch {
+            logger.error("could not write metadata to store at \(url): \(error)")
+        }
+    }
+}
+
 /// A LastModifiedContextObserver updates the lastModifiedDate attribute (for any objects that have one) whenever its context is saved.
 public final class LastModifiedContextObserver: NSObject {
     let managedObjectContext: NSManagedObjectContext
@@ -0,0 +1,319 @@
+//  PostBodyStore.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import CoreData
+import CryptoKit
+import Foundation
+import os
+
+private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category: "PostBodyStore")
+
+/**
+ Keeps post bodies out of the SQLite store, compressed and deduplicated by their SHA-256 digest.
+
+ A `Post` only remembers its body's digest. The bodies themselves live in one append-only pack file next to the persistent store, which is memory-mapped for reading. Identical bodies (the same post seen again on a reloaded page, mostly) are only written once, and comparing a freshly-scraped body with the saved one is a matter of comparing digests rather than reading and decompressing anything.
+
+ Bodies that no post refers to anymore are left in the pack until `compact(retaining:)` rewrites it, which `CachePruner` does after it deletes posts.
+
+ Pack format: an 8-byte header (`AWPB` and a little-endian version), then records of a 32-byte digest, the uncompressed and compressed lengths as little-endian `UInt32`s, and the LZFSE-compressed UTF-8 body. A record cut short by a crash is discarded when the pack is next opened.
+
+ Instances are safe to use from any thread.
+ */
+final class PostBodyStore {
+
+    /// Where the pack is saved. `nil` keeps everything in memory, e.g. alongside an in-memory persistent store.
+    let fileURL: URL?
+
+    private let lock = NSLock()
+    private var index: [Data: Record] = [:]
+    private var memoryRecords: [Data: Data] = [:]
+    private var mapped: Data?
+    private var fileLength = 0
+    private var handle: FileHandle?
+    private var insertedDuringCompaction: Set<Data>?
+    private let decoded = NSCache<NSData, NSString>()
+
+    private struct Record {
+        let offset: Int
+        let length: Int
+        let compressedLength: Int
+    }
+
+    private static let header = Data("AWPB".utf8) + littleEndianBytes(UInt32(1))
+    private static let recordHeaderLength = 32 + 4 + 4
+
+    init(fileURL: URL?) {
+        self.fileURL = fileURL
+        decoded.countLimit = 200
+        if fileURL != nil {
+            lock.lock()
+            defer { lock.unlock() }
+            loadIndex()
+        }
+    }
+
+    deinit {
+        try? handle?.close()
+    }
+
+    // MARK: Bodies
+
+    static func digest(of body: String) -> Data {
+        Data(SHA256.hash(data: Data(body.utf8)))
+    }
+
+    /**
+     Saves `body` (if it isn't already saved) and returns its digest.
+
+     - Throws: If the body couldn't be compressed or written to the pack, in which case nothing refers to it and the caller needs to hang on to it some other way.
+     */
+    @discardableResult
+    func insert(_ body: String, digest: Data? = nil) throws -> Data {
+        let digest = digest ?? Self.digest(of: body)
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        if index[digest] != nil || memoryRecords[digest] != nil {
+            insertedDuringCompaction?.insert(digest)
+            return digest
+        }
+
+        let utf8 = Data(body.utf8)
+        let compressed = try (utf8 as NSData).compressed(using: .lzfse) as Data
+
+        if fileURL == nil {
+            memoryRecords[digest] = compressed
+        } else {
+            try append(digest: digest, length: utf8.count, compressed: compressed)
+        }
+        insertedDuringCompaction?.insert(digest)
+        decoded.setObject(body as NSString, forKey: digest as NSData)
+        return digest
+    }
+
+    func contains(_ digest: Data) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return index[digest] != nil || memoryRecords[digest] != nil
+    }
+
+    /// The body whose digest is `digest`, or `nil` if it's not in the store.
+    func body(forDigest digest: Data) -> String? {
+        if let body = decoded.object(forKey: digest as NSData) {
+            return body as String
+        }
+
+        lock.lock()
+        let compressed: Data?
+        if let record = index[digest] {
+            compressed = bytes(for: record)
+        } else {
+            compressed = memoryRecords[digest]
+        }
+        lock.unlock()
+
+        guard let compressed,
+              let utf8 = try? (compressed as NSData).decompressed(using: .lzfse) as Data,
+              let body = String(data: utf8, encoding: .utf8)
+        else { return nil }
+
+        decoded.setObject(body as NSString, forKey: digest as NSData)
+        return body
+    }
+
+    /// How many distinct bodies are saved.
+    var count: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return index.count + memoryRecords.count
+    }
+
+    /**
+     Call before deleting posts whose bodies `compact(retaining:)` will then drop, and before gathering the digests to pass it.
+
+     Anything inserted in the meantime is kept, as its post may not be saved yet. Call `endCompaction()` instead of compacting if it turns out there's nothing to drop.
+     */
+    func beginCompaction() {
+        lock.lock()
+        defer { lock.unlock() }
+        insertedDuringCompaction = []
+    }
+
+    /// Stops keeping track of inserts without compacting.
+    func endCompaction() {
+        lock.lock()
+        defer { lock.unlock() }
+        insertedDuringCompaction = nil
+    }
+
+    /// Rewrites the pack with only the bodies in `digests` (plus any inserted since `beginCompaction()`), dropping everything else.
+    func compact(retaining digests: Set<Data>) throws {
+        lock.lock()
+        defer { lock.unlock() }
+
+        let digests = digests.union(insertedDuringCompaction ?? [])
+        insertedDuringCompaction = nil
+
+        guard let fileURL else {
+            memoryRecords = memoryRecords.filter { digests.contains($0.key) }
+            return
+        }
+
+        let kept = index.filter { digests.contains($0.key) }
+        guard kept.count < index.count else { return }
+
+        var pack = Self.header
+        for (digest, record) in kept.sorted(by: { $0.value.offset < $1.value.offset }) {
+            guard let compressed = bytes(for: record) else { continue }
+            pack.append(Self.recordHeader(digest: digest, length: record.length, compressedLength: compressed.count))
+            pack.append(compressed)
+        }
+
+        try? handle?.close()
+        handle = nil
+        mapped = nil
+        try pack.write(to: fileURL, options: .atomic)
+        logger.info("compacted post bodies from \(self.index.count) to \(kept.count) (\(pack.count) bytes)")
+
+        decoded.removeAllObjects()
+        loadIndex()
+    }
+
+    // MARK: Pack file
+
+    private func loadIndex() {
+        guard let fileURL else { return }
+        index = [:]
+        fileLength = 0
+        mapped = nil
+
+        guard let data = try? Data(contentsOf: fileURL, options: .alwaysMapped),
+              data.count >= Self.header.count,
+              data.prefix(Self.header.count) == Self.header
+        else {
+            // Missing or unrecognizable, so start over.
+            try? FileManager.default.removeItem(at: fileURL)
+            return
+        }
+
+        var offset = Self.header.count
+        while offset + Self.recordHeaderLength <= data.count {
+            let start = data.startIndex + offset
+            let digest = data[start ..< start + 32]
+            let length = Int(Self.readUInt32(data, at: start + 32))
+            let compressedLength = Int(Self.readUInt32(data, at: start + 36))
+            let bodyOffset = offset + Self.recordHeaderLength
+            guard bodyOffset + compressedLength <= data.count else { break }
+
+            index[Data(digest)] = Record(offset: bodyOffset, length: length, compressedLength: compressedLength)
+            offset = bodyOffset + compressedLength
+        }
+
+        if offset < data.count {
+            logger.warning("discarding \(data.count - offset) bytes of incomplete post body at end of pack")
+            if let handle = try? FileHandle(forWritingTo: fileURL) {
+                try? handle.truncate(atOffset: UInt64(offset))
+                try? handle.close()
+            }
+        }
+
+        fileLength = offset
+        mapped = data.count == offset ? data : nil
+    }
+
+    /// Must be called with `lock` held. A failed write may leave part of a record past `fileLength`, which the next append overwrites.
+    private func append(digest: Data, length: Int, compressed: Data) throws {
+        guard let fileURL else { return }
+        do {
+            let handle: FileHandle
+            if let existing = self.handle {
+                handle = existing
+            } else {
+                if !FileManager.default.fileExists(atPath: fileURL.path) {
+                    try Self.header.write(to: fileURL)
+                    fileLength = Self.header.count
+                }
+                handle = try FileHandle(forWritingTo: fileURL)
+                self.handle = handle
+            }
+
+            try handle.seek(toOffset: UInt64(fileLength))
+            var record = Self.recordHeader(digest: digest, length: length, compressedLength: compressed.count)
+            record.append(compressed)
+            try handle.write(contentsOf: record)
+
+            index[digest] = Record(offset: fileLength + Self.recordHeaderLength, length: length, compressedLength: compressed.count)
+            fileLength += record.count
+        } catch {
+            logger.error("could not append post body to \(fileURL): \(error)")
+            throw error
+        }
+    }
+
+    /// Must be called with `lock` held.
+    private func bytes(for record: Record) -> Data? {
+        let end = record.offset + record.compressedLength
+        if (mapped?.count ?? 0) < end {
+            // Appended since we last mapped the file.
+            mapped = fileURL.flatMap { try? Data(contentsOf: $0, options: .alwaysMapped) }
+        }
+        guard let mapped, mapped.count >= end else { return nil }
+        return mapped.subdata(in: mapped.startIndex + record.offset ..< mapped.startIndex + end)
+    }
+
+    private static func recordHeader(digest: Data, length: Int, compressedLength: Int) -> Data {
+        var header = Data(capacity: recordHeaderLength + compressedLength)
+        header.append(digest)
+        header.append(littleEndianBytes(UInt32(length)))
+        header.append(littleEndianBytes(UInt32(compressedLength)))
+        return header
+    }
+
+    private static func readUInt32(_ data: Data, at index: Data.Index) -> UInt32 {
+        data[index ..< index + 4].reversed().reduce(0) { $0 << 8 | UInt32($1) }
+    }
+}
+
+private func littleEndianBytes(_ value: UInt32) -> Data {
+    withUnsafeBytes(of: value.littleEndian) { Data($0) }
+}
+
+// MARK: - Finding the store for a persistent store
+
+extension PostBodyStore {
+
+    /// The body store that goes with `store`, created on first use. SQLite stores keep their bodies in a file next to the store; any other kind keeps them in memory.
+    static func forPersistentStore(_ store: NSPersistentStore) -> PostBodyStore {
+        registryLock.lock()
+        defer { registryLock.unlock() }
+
+        if let existing = objc_getAssociatedObject(store, &associationKey) as? PostBodyStore {
+            return existing
+        }
+
+        let fileURL: URL? = store.type == NSSQLiteStoreType
+            ? store.url.map(packURL(forStoreURL:))
+            : nil
+        let bodyStore = PostBodyStore(fileURL: fileURL)
+        objc_setAssociatedObject(store, &associationKey, bodyStore, .OBJC_ASSOCIATION_RETAIN)
+        return bodyStore
+    }
+
+    /// Where the bodies for the SQLite store at `storeURL` are saved.
+    static func packURL(forStoreURL storeURL: URL) -> URL {
+        storeURL.deletingPathExtension().appendingPathExtension("postbodies")
+    }
+
+    /// The body store for wherever `object` is (or will be) saved.
+    static func forObject(_ object: NSManagedObject) -> PostBodyStore? {
+        guard let store = object.objectID.persistentStore
+                ?? object.managedObjectContext?.persistentStoreCoordinator?.persistentStores.first
+        else { return nil }
+        return forPersistentStore(store)
+    }
+
+    private static let registryLock = NSLock()
+    private static var associationKey: UInt8 = 0
+}
@@ -0,0 +1,238 @@
+//  AttachmentCompressor.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import ImageIO
+import os
+import UIKit
+import UniformTypeIdentifiers
+
+private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category: "AttachmentCompressor")
+
+/**
+ Gets an image under a maximum file size in as few full-size encodes as possible.
+
+ The image is drawn once at the largest size allowed, and every later attempt works from that one bitmap. A small copy of the bitmap (the probe) is then encoded a few times to estimate how big the full image will be at each quality or size. That means the first full-size encode usually fits, and the rest is a binary search.
+
+ Opaque images become JPEGs, and the search is over quality. If even the lowest quality is too big, the search moves on to dimensions. Images with transparency stay PNG, and the search is over dimensions only.
+
+ Encoding a big photo takes a while, so don't call `compress(_:)` on the main thread.
+ */
+struct AttachmentCompressor {
+    let maxFileSize: Int
+    let maxDimension: Int
+
+    var minimumQuality: CGFloat = 0.1
+    var maximumQuality: CGFloat = 0.9
+
+    /// JPEG quality to use when even `minimumQuality` isn't enough and the image needs to get smaller instead.
+    var scaledQuality: CGFloat = 0.7
+
+    /// Neither side is made smaller than this (unless it started out smaller).
+    var minimumDimension = 100
+
+    /// A result at least this fraction of `maxFileSize` is good enough. Encoding again would only get a little closer.
+    var closeEnough = 0.85
+
+    /// The probe aims for this fraction of `maxFileSize`, leaving room for estimation error.
+    var estimateTarget = 0.92
+
+    /// The longer side of the probe, in pixels.
+    var probeDimension = 1024
+
+    struct Result {
+        let data: Data
+        let image: UIImage
+        let isPNG: Bool
+
+        /// How many times the full-size image (not the probe) was encoded.
+        let fullEncodes: Int
+    }
+
+    func compress(_ image: UIImage) -> Result? {
+        let opaque = !image.hasAlpha
+        let pixelSize = CGSize(width: image.size.width * image.scale, height: image.size.height * image.scale)
+        guard pixelSize.width >= 1, pixelSize.height >= 1 else { return nil }
+
+        let ratio = min(1, CGFloat(maxDimension) / max(pixelSize.width, pixelSize.height))
+        let size = CGSize(width: (pixelSize.width * ratio).rounded(.down), height: (pixelSize.height * ratio).rounded(.down))
+        guard let bitmap = render(image, size: size, opaque: opaque) else {
+            logger.error("could not draw \(Int(pixelSize.width))×\(Int(pixelSize.height)) image to compress")
+            return nil
+        }
+
+        let search = Search(compressor: self, bitmap: bitmap, opaque: opaque)
+        let result = opaque ? search.jpeg() : search.png()
+        if let result {
+            logger.debug("compressed to \(result.data.count) bytes in \(result.fullEncodes) full-size encodes")
+        }
+        return result
+    }
+
+    private final class Search {
+        let compressor: AttachmentCompressor
+        let bitmap: CGImage
+        let opaque: Bool
+        var fullEncodes = 0
+
+        private lazy var probe: (image: CGImage, pixelRatio: Double)? = {
+            let bitmap = self.bitmap
+            let longSide = max(bitmap.width, bitmap.height)
+            guard longSide > self.compressor.probeDimension else { return (bitmap, 1) }
+            let scale = CGFloat(self.compressor.probeDimension) / CGFloat(longSide)
+            guard let probe = scaled(bitmap, by: scale, opaque: self.opaque) else { return nil }
+            return (probe, Double(bitmap.width * bitmap.height) / Double(probe.width * probe.height))
+        }()
+
+        init(compressor: AttachmentCompressor, bitmap: CGImage, opaque: Bool) {
+            self.compressor = compressor
+            self.bitmap = bitmap
+            self.opaque = opaque
+        }
+
+        private var minimumScale: CGFloat {
+            min(1, CGFloat(compressor.minimumDimension) / CGFloat(min(bitmap.width, bitmap.height)))
+        }
+
+        private var estimateLimit: Double {
+            Double(compressor.maxFileSize) * compressor.estimateTarget
+        }
+
+        func jpeg() -> Result? {
+            let qualities = compressor.minimumQuality ... compressor.maximumQuality
+
+            // Largest probe quality whose estimate fits.
+            var guess = compressor.minimumQuality
+            if let probe {
+                var low = compressor.minimumQuality, high = compressor.maximumQuality
+                for _ in 0..<6 {
+                    let mid = (low + high) / 2
+                    let size = encodeJPEG(probe.image, quality: mid).map { Double($0.count) * probe.pixelRatio }
+                    if let size, size <= estimateLimit { low = mid } else { high = mid }
+                }
+                guess = low
+            }
+
+            if let found = largestFitting(in: qualities, firstTry: guess, tolerance: 0.05, encode: { quality in
+                encodeJPEG(bitmap, quality: quality)
+            }) {
+                return Result(data: found.data, image: UIImage(cgImage: bitmap), isPNG: false, fullEncodes: fullEncodes)
+            }
+
+            // Even the lowest quality is too big, so it needs to get smaller.
+            let scaledQuality = compressor.scaledQuality
+            let scaleGuess = probe
+                .flatMap { probe in encodeJPEG(probe.image, quality: scaledQuality).map { Double($0.count) * probe.pixelRatio } }
+                .map { CGFloat((estimateLimit / $0).squareRoot()) }
+                ?? 0.5
+            return scaledSearch(firstTry: scaleGuess) { encodeJPEG($0, quality: scaledQuality) }
+        }
+
+        func png() -> Result? {
+            let scaleGuess = probe
+                .flatMap { probe in encodePNG(probe.image).map { Double($0.count) * probe.pixelRatio } }
+                .map { CGFloat((estimateLimit / $0).squareRoot()) }
+                ?? 1
+            return scaledSearch(firstTry: scaleGuess, encode: encodePNG)
+        }
+
+        private func scaledSearch(firstTry: CGFloat, encode: (CGImage) -> Data?) -> Result? {
+            var images: [CGFloat: CGImage] = [:]
+            let found = largestFitting(in: minimumScale ... 1, firstTry: firstTry, tolerance: 0.05) { scale in
+                let image = scale >= 1 ? bitmap : scaled(bitmap, by: scale, opaque: opaque)
+                images[scale] = image
+                return image.flatMap(encode)
+            }
+            guard let found, let image = images[found.value] else { return nil }
+            return Result(data: found.data, image: UIImage(cgImage: image), isPNG: !opaque, fullEncodes: fullEncodes)
+        }
+
+        /**
+         Binary searches `range` for the largest value whose encoding fits, starting with `firstTry`.
+
+         Stops as soon as something fits that's `closeEnough` to the limit, or when the values left to try are all within `tolerance` of each other.
+         */
+        private func largestFitting(
+            in range: ClosedRange<CGFloat>,
+            firstTry: CGFloat,
+            tolerance: CGFloat,
+            encode: (CGFloat) -> Data?
+        ) -> (value: CGFloat, data: Data)? {
+            var best: (value: CGFloat, data: Data)?
+            var tooBig = range.upperBound + tolerance
+            var value = range.clamped(firstTry)
+
+            while true {
+                fullEncodes += 1
+                guard let data = encode(value) else { return best }
+
+                if data.count <= compressor.maxFileSize {
+                    best = (value, data)
+                    if value >= range.upperBound || Double(data.count) >= Double(compressor.maxFileSize) * compressor.closeEnough {
+                        return best
+                    }
+                } else {
+                    tooBig = value
+                    if value <= range.lowerBound { return best }
+                }
+
+                if let best {
+                    let high = min(tooBig, range.upperBound)
+                    guard high - best.value > tolerance else { return best }
+                    value = tooBig > range.upperBound ? range.upperBound : (best.value + high) / 2
+                } else {
+                    value = tooBig - range.lowerBound > tolerance ? (range.lowerBound + tooBig) / 2 : range.lowerBound
+                }
+            }
+        }
+    }
+}
+
+private extension ClosedRange where Bound == CGFloat {
+    func clamped(_ value: CGFloat) -> CGFloat {
+        Swift.min(Swift.max(value, lowerBound), upperBound)
+    }
+}
+
+private func render(_ image: UIImage, size: CGSize, opaque: Bool) -> CGImage? {
+    let format = UIGraphicsImageRendererFormat()
+    format.scale = 1
+    format.opaque = opaque
+    let renderer = UIGraphicsImageRenderer(size: size, format: format)
+    return renderer.image { _ in
+        image.draw(in: CGRect(origin: .zero, size: size))
+    }.cgImage
+}
+
+private func scaled(_ image: CGImage, by scale: CGFloat, opaque: Bool) -> CGImage? {
+    let width = max(1, Int((CGFloat(image.width) * scale).rounded(.down)))
+    let height = max(1, Int((CGFloat(image.height) * scale).rounded(.down)))
+    guard let context = CGContext(
+        data: nil,
+        width: width,
+        height: height,
+        bitsPerComponent: 8,
+        bytesPerRow: 0,
+        space: image.colorSpace ?? CGColorSpaceCreateDeviceRGB(),
+        bitmapInfo: (opaque ? CGImageAlphaInfo.noneSkipFirst : .premultipliedFirst).rawValue | CGBitmapInfo.byteOrder32Little.rawValue
+    ) else { return nil }
+    context.interpolationQuality = .high
+    context.draw(image, in: CGRect(x: 0, y: 0, width: width, height: height))
+    return context.makeImage()
+}
+
+private func encodeJPEG(_ image: CGImage, quality: CGFloat) -> Data? {
+    encode(image, type: .jpeg, properties: [kCGImageDestinationLossyCompressionQuality: quality])
+}
+
+private func encodePNG(_ image: CGImage) -> Data? {
+    encode(image, type: .png, properties: [:])
+}
+
+private func encode(_ image: CGImage, type: UTType, properties: [CFString: Any]) -> Data? {
+    let data = NSMutableData()
+    guard let destination = CGImageDestinationCreateWithData(data, type.identifier as CFString, 1, nil) else { return nil }
+    CGImageDestinationAddImage(destination, image, properties as CFDictionary)
+    guard CGImageDestinationFinalize(destination) else { return nil }
+    return data as Data
+}
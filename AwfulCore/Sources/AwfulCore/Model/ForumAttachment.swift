@@ -26,8 +26,10 @@ private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category:
 
  When an image exceeds limits, `ForumAttachment` can automatically:
  1. Scale down dimensions while maintaining aspect ratio
- 2. Apply progressive JPEG compression (for non-transparent images)
- 3. Scale down PNG images with transparency until they meet size requirements
+ 2. Find the highest JPEG quality that fits (for non-transparent images)
+ 3. Find the largest dimensions that fit as a PNG (for images with transparency)
+
+ See `AttachmentCompressor` for how it gets there without encoding the image over and over. A resized attachment keeps the data it was compressed to, so it isn't encoded again for upload.
 
  ## State Preservation
 
@@ -42,16 +44,15 @@ public final class ForumAttachment: NSObject, NSCoding {
 
     private struct CompressionSettings {
         static let defaultQuality: CGFloat = 0.9
-        static let qualityDecrement: CGFloat = 0.1
-        static let minQuality: CGFloat = 0.1
-        static let dimensionScaleFactor: CGFloat = 0.9
-        static let minimumDimension = 100
     }
 
     public let image: UIImage?
     public let photoAssetIdentifier: String?
     public private(set) var validationError: ValidationError?
 
+    /// Data the image was compressed to by `resized(maxDimension:maxFileSize:)`, if that's where it came from.
+    private var compressedData: (data: Data, isPNG: Bool)?
+
     public enum ValidationError: Error {
         case fileTooLarge(actualSize: Int, maxSize: Int)
         case dimensionsTooLarge(width: Int, height: Int, maxDimension: Int)
@@ -66,6 +67,14 @@ public final class ForumAttachment: NSObject, NSCoding {
         self.validationError = validate()
     }
 
+    private init(compressed: AttachmentCompressor.Result, photoAssetIdentifier: String?) {
+        self.image = compressed.image
+        self.photoAssetIdentifier = photoAssetIdentifier
+        self.compressedData = (compressed.data, compressed.isPNG)
+        super.init()
+        self.validationError = validate()
+    }
+
     /**
      Restores a ForumAttachment from encoded state.
 
@@ -172,7 +181,11 @@ public final class ForumAttachment: NSObject, NSCoding {
         dateFormatter.dateFormat = "yyyy-MM-dd-HHmmss"
         let timestamp = dateFormatter.string(from: Date())
 
-        if hasAlpha, let pngData = image.pngData() {
+        if let compressed = compressedData {
+            return compressed.isPNG
+                ? (compressed.data, "photo-\(timestamp).png", "image/png")
+                : (compressed.data, "photo-\(timestamp).jpg", "image/jpeg")
+        } else if hasAlpha, let pngData = image.pngData() {
             return (pngData, "photo-\(timestamp).png", "image/png")
         } else if let jpegData = image.jpegData(compressionQuality: CompressionSettings.defaultQuality) {
             return (jpegData, "photo-\(timestamp).jpg", "image/jpeg")
@@ -181,105 +194,19 @@ public final class ForumAttachment: NSObject, NSCoding {
         }
     }
 
-    public func resized(maxDimension: Int? = nil, maxFileSize: Int? = nil) -> ForumAttachment? {
-        guard let originalImage = image else { return nil }
-
-        let effectiveMaxDimension = maxDimension ?? Self.maxDimension
-        let effectiveMaxFileSize = maxFileSize ?? Self.maxFileSize
-
-        let originalWidth = Int(originalImage.size.width * originalImage.scale)
-        let originalHeight = Int(originalImage.size.height * originalImage.scale)
-
-        var targetWidth = originalWidth
-        var targetHeight = originalHeight
-
-        if originalWidth > effectiveMaxDimension || originalHeight > effectiveMaxDimension {
-            let ratio = min(CGFloat(effectiveMaxDimension) / CGFloat(originalWidth),
-                          CGFloat(effectiveMaxDimension) / CGFloat(originalHeight))
-            targetWidth = Int(CGFloat(originalWidth) * ratio)
-            targetHeight = Int(CGFloat(originalHeight) * ratio)
-        }
-
-        if let compressed = compressImage(
-            originalImage,
-            targetWidth: targetWidth,
-            targetHeight: targetHeight,
-            maxFileSize: effectiveMaxFileSize
-        ) {
-            return ForumAttachment(image: compressed, photoAssetIdentifier: photoAssetIdentifier)
-        }
-
-        return nil
-    }
-
     /**
-     Compresses an image to fit within the specified dimensions and file size limits.
-
-     The compression algorithm uses a two-pronged approach:
-     - For images without alpha channel: Uses JPEG compression with progressively decreasing quality
-     - For images with alpha channel: Uses PNG compression with progressively smaller dimensions
-
-     This strategy optimizes for file size while preserving visual quality and transparency where needed.
+     Returns a copy of this attachment that fits within the dimension and file size limits, or `nil` if the image can't be made to fit.
 
-     - Parameters:
-       - originalImage: The source image to compress
-       - targetWidth: Maximum width in pixels
-       - targetHeight: Maximum height in pixels
-       - maxFileSize: Maximum file size in bytes
-
-     - Returns: A compressed image that fits within the constraints, or `nil` if compression failed
+     This can take a while for a big photo, so call it off the main thread.
      */
-    private func compressImage(
-        _ originalImage: UIImage,
-        targetWidth: Int,
-        targetHeight: Int,
-        maxFileSize: Int
-    ) -> UIImage? {
-        var compressionQuality = CompressionSettings.defaultQuality
-        var currentWidth = targetWidth
-        var currentHeight = targetHeight
-        var resizedImage = originalImage.resized(to: CGSize(width: currentWidth, height: currentHeight))
-        var lastValidImage: UIImage?
-
-        // Iteratively compress until we meet the file size constraint
-        while compressionQuality > CompressionSettings.minQuality {
-            let hasAlpha = resizedImage.hasAlpha
-            let data: Data?
-
-            // Choose encoding based on alpha channel presence
-            if hasAlpha {
-                data = resizedImage.pngData()
-            } else {
-                data = resizedImage.jpegData(compressionQuality: compressionQuality)
-            }
-
-            // Success: image fits within file size limit
-            if let imageData = data, imageData.count <= maxFileSize {
-                return resizedImage
-            }
-
-            // For images with alpha: reduce dimensions (PNG doesn't support quality adjustment)
-            if hasAlpha {
-                let newWidth = Int(CGFloat(currentWidth) * CompressionSettings.dimensionScaleFactor)
-                let newHeight = Int(CGFloat(currentHeight) * CompressionSettings.dimensionScaleFactor)
-                if newWidth < CompressionSettings.minimumDimension || newHeight < CompressionSettings.minimumDimension {
-                    break
-                }
-                currentWidth = newWidth
-                currentHeight = newHeight
-                resizedImage = originalImage.resized(to: CGSize(width: currentWidth, height: currentHeight))
-
-                if let data = resizedImage.pngData(), data.count <= maxFileSize {
-                    lastValidImage = resizedImage
-                }
-            } else {
-                // For images without alpha: reduce JPEG quality
-                compressionQuality -= CompressionSettings.qualityDecrement
-            }
-        }
+    public func resized(maxDimension: Int? = nil, maxFileSize: Int? = nil) -> ForumAttachment? {
+        guard let originalImage = image else { return nil }
 
-        // Return the last image that fit within constraints, or nil if none did
-        return lastValidImage
+        let compressor = AttachmentCompressor(
+            maxFileSize: maxFileSize ?? Self.maxFileSize,
+            maxDimension: maxDimension ?? Self.maxDimension)
+        guard let compressed = compressor.compress(originalImage) else { return nil }
+        return ForumAttachment(compressed: compressed, photoAssetIdentifier: photoAssetIdentifier)
     }
 }
 
@@ -304,20 +231,11 @@ extension ForumAttachment.ValidationError {
     }
 }
 
-private extension UIImage {
+extension UIImage {
     private static let alphaInfoTypes: Set<CGImageAlphaInfo> = [.first, .last, .premultipliedFirst, .premultipliedLast]
 
     var hasAlpha: Bool {
         guard let alphaInfo = cgImage?.alphaInfo else { return false }
         return Self.alphaInfoTypes.contains(alphaInfo)
     }
-
-    func resized(to targetSize: CGSize) -> UIImage {
-        let format = UIGraphicsImageRendererFormat()
-        format.scale = 1
-        let renderer = UIGraphicsImageRenderer(size: targetSize, format: format)
-        return renderer.image { _ in
-            draw(in: CGRect(origin: .zero, size: targetSize))
-        }
-    }
 }
@@ -18,8 +18,11 @@ public class Post: AwfulManagedObject, Managed {
     /// Whether the post's author is ignored.
     @NSManaged public var ignored: Bool
     
-    /// The HTML body of the post.
-    @NSManaged public var innerHTML: String?
+    /// The SHA-256 digest of the post's HTML body, which lives in the `PostBodyStore`.
+    @NSManaged var bodyDigest: Data?
+    
+    /// The HTML body of the post, for posts saved before bodies moved to the `PostBodyStore`.
+    @NSManaged var legacyInnerHTML: String?
     
     /// The last time the cached post data changed.
     @NSManaged var lastModifiedDate: Date
@@ -46,6 +49,46 @@ public class Post: AwfulManagedObject, Managed {
 }
 
 extension Post {
+    /// The HTML body of the post.
+    public var innerHTML: String? {
+        get {
+            if let bodyDigest, let body = PostBodyStore.forObject(self)?.body(forDigest: bodyDigest) {
+                return body
+            }
+            return legacyInnerHTML
+        }
+        set {
+            setInnerHTML(newValue, digest: newValue.map(PostBodyStore.digest(of:)))
+        }
+    }
+
+    /**
+     Sets the body when its digest is already known, skipping the work if it hasn't changed.
+
+     If the body store can't save the body (e.g. the disk is full), it's kept in `legacyInnerHTML` instead so it isn't lost.
+     */
+    func setInnerHTML(_ body: String?, digest: Data?) {
+        guard let body, let digest, let bodyStore = PostBodyStore.forObject(self) else {
+            keepLegacyInnerHTML(body)
+            return
+        }
+        if digest == bodyDigest, bodyStore.contains(digest) { return }
+
+        do {
+            try bodyStore.insert(body, digest: digest)
+        } catch {
+            keepLegacyInnerHTML(body)
+            return
+        }
+        bodyDigest = digest
+        if legacyInnerHTML != nil { legacyInnerHTML = nil }
+    }
+
+    private func keepLegacyInnerHTML(_ body: String?) {
+        if bodyDigest != nil { bodyDigest = nil }
+        if body != legacyInnerHTML { legacyInnerHTML = body }
+    }
+
     /// Whether the user has seen the post.
     public var beenSeen: Bool {
         if let thread = thread {
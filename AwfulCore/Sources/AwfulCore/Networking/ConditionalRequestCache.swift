@@ -0,0 +1,120 @@
+//  ConditionalRequestCache.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import CoreData
+import CryptoKit
+import Foundation
+
+/**
+ Remembers enough about pages we've already scraped to skip scraping them again when they haven't changed.
+
+ If a response had validators (`ETag` or `Last-Modified`), they're sent along with the next request for the same page, and a `304 Not Modified` means nothing changed. The Forums rarely send validators, so we also hash each response body: when a page comes back identical to last time, parsing and upserting it would only recreate what's already in the store.
+
+ Entries are recorded only after the response has been successfully scraped and upserted, and they remember the resulting objects so they can be handed out again. Entries are keyed by URL and login session, so logging in as someone else doesn't reuse someone else's bookmarks.
+ */
+final class ConditionalRequestCache {
+
+    struct Entry {
+        fileprivate let etag: String?
+        fileprivate let lastModified: String?
+        fileprivate let contentHash: SHA256.Digest
+        fileprivate let group: Group?
+        fileprivate let generation: Int
+
+        /// Whatever the response was upserted into, in order.
+        let objectIDs: [NSManagedObjectID]
+    }
+
+    /**
+     Pages whose upserts change one another's objects. Recording an entry in a group invalidates every other entry in the group.
+
+     Upserting a page of threads sets those threads' list page, and page 1 takes every other thread off the list. Once a different page, tag filter, or the bookmarks is upserted, an earlier entry's threads may no longer be where that page left them, so the page needs upserting again even if it comes back the same.
+     */
+    enum Group {
+        case threadLists
+    }
+
+    private let cache = NSCache<NSString, Box>()
+    private let lock = NSLock()
+    private var generations: [Group: Int] = [:]
+
+    init() {
+        cache.countLimit = 100
+    }
+
+    func key(for request: URLRequest, session: String?) -> String {
+        "\(session ?? "")|\(request.url?.absoluteString ?? "")"
+    }
+
+    /// Sets the request up for revalidation, if we have an entry with validators for `key`.
+    func addValidators(to request: inout URLRequest, forKey key: String) {
+        guard let entry = cache.object(forKey: key as NSString)?.entry else { return }
+
+        // Let our validators through untouched, and let any 304 get back to us.
+        request.cachePolicy = .reloadIgnoringLocalCacheData
+        if let etag = entry.etag {
+            request.setValue(etag, forHTTPHeaderField: "If-None-Match")
+        }
+        if let lastModified = entry.lastModified {
+            request.setValue(lastModified, forHTTPHeaderField: "If-Modified-Since")
+        }
+    }
+
+    /// Returns the entry for `key` if the response says nothing changed since it was recorded.
+    func unchangedEntry(forKey key: String, response: URLResponse, data: Data) -> Entry? {
+        guard let entry = cache.object(forKey: key as NSString)?.entry,
+              entry.group.map({ generation(of: $0) == entry.generation }) ?? true
+        else { return nil }
+
+        if (response as? HTTPURLResponse)?.statusCode == 304 {
+            return entry
+        }
+        return SHA256.hash(data: data) == entry.contentHash ? entry : nil
+    }
+
+    /// Call once `data` is successfully scraped and upserted.
+    func record(forKey key: String, response: URLResponse, data: Data, objectIDs: [NSManagedObjectID], group: Group? = nil) {
+        let generation = group.map(invalidate(_:)) ?? 0
+        let response = response as? HTTPURLResponse
+        let entry = Entry(
+            etag: response?.value(forHTTPHeaderField: "ETag"),
+            lastModified: response?.value(forHTTPHeaderField: "Last-Modified"),
+            contentHash: SHA256.hash(data: data),
+            group: group,
+            generation: generation,
+            objectIDs: objectIDs)
+        cache.setObject(Box(entry), forKey: key as NSString)
+    }
+
+    /// Makes every entry recorded so far in `group` count as changed, and returns the group's new generation.
+    @discardableResult
+    func invalidate(_ group: Group) -> Int {
+        lock.lock()
+        defer { lock.unlock() }
+        let generation = generations[group, default: 0] + 1
+        generations[group] = generation
+        return generation
+    }
+
+    private func generation(of group: Group) -> Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return generations[group, default: 0]
+    }
+
+    func removeEntry(forKey key: String) {
+        cache.removeObject(forKey: key as NSString)
+    }
+
+    func removeAllEntries() {
+        cache.removeAllObjects()
+    }
+
+    private final class Box {
+        let entry: Entry
+        init(_ entry: Entry) {
+            self.entry = entry
+        }
+    }
+}
@@ -34,6 +34,12 @@ public final class FixtureURLProtocol: URLProtocol {
      Any fixtures added here will be loaded, causing relevant requests to be intercepted. Initially the set of enabled fixtures is empty, at which point this URL protocol does nothing.
      */
     public static var enabledFixtures: Set<Fixture> = []
+
+    /// The bundle containing the `Fixtures` folder. Tests that bring their own fixtures can point this at their bundle.
+    public static var fixtureBundle = Bundle(for: FixtureURLProtocol.self)
+
+    /// How long to wait before answering a request, to stand in for a trip over the network.
+    public static var latency: TimeInterval = 0
     
     public struct Fixture: Hashable {
         fileprivate let basename: String
@@ -114,7 +120,7 @@ public final class FixtureURLProtocol: URLProtocol {
         
         logger.debug("matching fixture for \(self.request) is \(fixture.basename)")
         
-        let bundle = Bundle(for: FixtureURLProtocol.self)
+        let bundle = FixtureURLProtocol.fixtureBundle
         guard let fixtureURL = bundle.url(forResource: fixture.basename, withExtension: "html", subdirectory: "Fixtures") else {
             
             logger.error("missing expected fixture \(fixture.basename) in bundle \(bundle); did you forget to add Core/Tests/Fixtures to the Core target?")
@@ -136,19 +142,48 @@ public final class FixtureURLProtocol: URLProtocol {
             return
         }
         
-        let response = URLResponse(url: url, mimeType: mimeType, expectedContentLength: data.count, textEncodingName: nil)
-        
-        client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
-        
-        client?.urlProtocol(self, didLoad: data)
-        
-        client?.urlProtocolDidFinishLoading(self)
-        
-        logger.debug("done loading for \(self.request)")
+        // Fixtures are saved as the Forums sent them, in windows-1252.
+        let headers = ["Content-Type": "\(mimeType ?? "text/html"); charset=windows-1252"]
+        guard let response = HTTPURLResponse(url: url, statusCode: 200, httpVersion: "HTTP/1.1", headerFields: headers) else {
+            client?.urlProtocol(self, didFailWithError: LoadingError.noMatchingFixture)
+            return
+        }
+
+        let finish = { [self] in
+            guard !isStopped else { return }
+            client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+            client?.urlProtocol(self, didLoad: data)
+            client?.urlProtocolDidFinishLoading(self)
+            logger.debug("done loading for \(self.request)")
+        }
+
+        let latency = FixtureURLProtocol.latency
+        if latency > 0 {
+            DispatchQueue.global().asyncAfter(deadline: .now() + latency, execute: finish)
+        } else {
+            finish()
+        }
+    }
+
+    /// Set on the URL loading thread, read wherever a delayed response finishes.
+    private var isStopped: Bool {
+        get {
+            stoppedLock.lock()
+            defer { stoppedLock.unlock() }
+            return _isStopped
+        }
+        set {
+            stoppedLock.lock()
+            defer { stoppedLock.unlock() }
+            _isStopped = newValue
+        }
     }
+    private var _isStopped = false
+    private let stoppedLock = NSLock()
     
     public override func stopLoading() {
-        // nothing to do here; everything happens in startLoading()
+        // Everything happens in startLoading(), but a delayed response shouldn't arrive after we're told to stop.
+        isStopped = true
     }
 }
 
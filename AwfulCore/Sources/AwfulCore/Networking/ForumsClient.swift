@@ -14,6 +14,7 @@ private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category:
 /// Sends data to and scrapes data from the Something Awful Forums.
 public final class ForumsClient {
     private var backgroundManagedObjectContext: NSManagedObjectContext?
+    private let conditionalRequestCache = ConditionalRequestCache()
     private var lastModifiedObserver: LastModifiedContextObserver?
     private var urlSession: URLSession?
 
@@ -59,10 +60,13 @@ public final class ForumsClient {
             }
             if let oldBackground = backgroundManagedObjectContext {
                 NotificationCenter.default.removeObserver(self, name: .NSManagedObjectContextDidSave, object: oldBackground)
+                NotificationCenter.default.removeObserver(self, name: .cachePrunerDidDeleteObjects, object: nil)
                 backgroundManagedObjectContext = nil
                 lastModifiedObserver = nil
             }
             
+            conditionalRequestCache.removeAllEntries()
+
             guard let newValue = managedObjectContext else { return }
 
             NotificationCenter.default.addObserver(self, selector: #selector(mainManagedObjectContextDidSave), name: .NSManagedObjectContextDidSave, object: newValue)
@@ -71,6 +75,7 @@ public final class ForumsClient {
             backgroundManagedObjectContext = background
             background.persistentStoreCoordinator = newValue.persistentStoreCoordinator
             NotificationCenter.default.addObserver(self, selector: #selector(backgroundManagedObjectContextDidSave), name: .NSManagedObjectContextDidSave, object: background)
+            NotificationCenter.default.addObserver(self, selector: #selector(cachePrunerDidDeleteObjects), name: .cachePrunerDidDeleteObjects, object: nil)
 
             lastModifiedObserver = LastModifiedContextObserver(managedObjectContext: background)
         }
@@ -81,6 +86,16 @@ public final class ForumsClient {
         context.perform { context.mergeChanges(fromContextDidSave: notification) }
     }
 
+    /// The pruner deletes straight from the store and merges into the main context, but our background context needs to hear about it too.
+    @objc private func cachePrunerDidDeleteObjects(_ notification: Notification) {
+        guard let context = backgroundManagedObjectContext,
+              let pruner = notification.object as? CachePruner,
+              pruner.managedObjectContext.persistentStoreCoordinator === context.persistentStoreCoordinator,
+              let changes = notification.userInfo
+        else { return }
+        NSManagedObjectContext.mergeChanges(fromRemoteContextSave: changes, into: [context])
+    }
+
     @objc private func backgroundManagedObjectContextDidSave(_ notification: Notification) {
         guard let context = managedObjectContext else { return }
 
@@ -146,39 +161,149 @@ public final class ForumsClient {
 
         let result: Result<(Data, URLResponse), Swift.Error>
         do {
-            guard let url = URL(string: urlString, relativeTo: baseURL),
-                  let components = URLComponents(url: url, resolvingAgainstBaseURL: true)
-            else { throw ForumsClient.Error.invalidBaseURL }
-
-            let parameters = parameters.lazy.map(win1252Escaped(_:))
-
-            var request: URLRequest
-            switch method {
-            case .get:
-                var queryItems = components.queryItems ?? []
-                queryItems.append(contentsOf: parameters.map { URLQueryItem(name: $0, value: $1) })
-                var components = components
-                components.queryItems = queryItems
-                request = URLRequest(url: components.url!)
-
-            case .post:
-                request = URLRequest(url: url)
-                try request.setMultipartFormData(parameters, encoding: .windowsCP1252)
-            }
-            request.httpMethod = method.rawValue
+            let request = try makeRequest(method: method, urlString: urlString, parameters: parameters)
             let tuple = try await urlSession.data(for: request, willRedirect: willRedirect)
             result = .success(tuple)
         } catch {
             result = .failure(error)
         }
 
+        noticeRemoteLogOut(wasLoggedIn: wasLoggedIn)
+
+        return try result.get()
+    }
+
+    /// Like `fetch(method:urlString:parameters:willRedirect:)`, but hands over the response body in the pieces it arrives in.
+    private func fetchChunks(
+        urlString: String,
+        parameters: some Sequence<KeyValuePairs<String, Any>.Element>,
+        willRedirect: @escaping (_ response: HTTPURLResponse, _ newRequest: URLRequest) async -> URLRequest? = { $1 }
+    ) async throws -> (AsyncThrowingStream<Data, Swift.Error>, URLResponse) {
+        guard let urlSession else {
+            throw Error.missingURLSession
+        }
+
+        let wasLoggedIn = isLoggedIn
+
+        let result: Result<(AsyncThrowingStream<Data, Swift.Error>, URLResponse), Swift.Error>
+        do {
+            let request = try makeRequest(method: .get, urlString: urlString, parameters: parameters)
+            let tuple = try await urlSession.chunks(for: request, willRedirect: willRedirect)
+            result = .success(tuple)
+        } catch {
+            result = .failure(error)
+        }
+
+        noticeRemoteLogOut(wasLoggedIn: wasLoggedIn)
+
+        return try result.get()
+    }
+
+    private enum ConditionalFetch<T: NSManagedObject> {
+        /// The page is the same as the last time it was upserted, which resulted in these objects (from the main context).
+        case unchanged([T])
+
+        case changed(ChangedResponse)
+    }
+
+    private struct ChangedResponse {
+        let data: Data
+        let response: URLResponse
+
+        /// Call once the response is successfully scraped and upserted, with the upserted objects.
+        let record: (_ objectIDs: [NSManagedObjectID]) -> Void
+    }
+
+    /**
+     Like `fetch(method: .get, …)`, but checks with `conditionalRequestCache` whether the response is unchanged since the last time it was upserted, and if so, skips straight to the resulting objects.
+
+     Refreshing an unchanged forum list or bookmarks page then costs a revalidation (or a download and hash) instead of a parse, scrape, and Core Data write.
+
+     - Parameter group: Pages whose upserts undo one another's, such that upserting any of them means the others need upserting again.
+     */
+    private func fetchUnlessUnchanged<T: NSManagedObject>(
+        _: T.Type,
+        urlString: String,
+        parameters: some Collection<KeyValuePairs<String, Any>.Element>,
+        group: ConditionalRequestCache.Group? = nil
+    ) async throws -> ConditionalFetch<T> {
+        guard let urlSession else {
+            throw Error.missingURLSession
+        }
+        guard let mainContext = managedObjectContext else {
+            throw Error.missingManagedObjectContext
+        }
+
+        let wasLoggedIn = isLoggedIn
+
+        let result: Result<(Data, URLResponse, key: String), Swift.Error>
+        do {
+            var request = try makeRequest(method: .get, urlString: urlString, parameters: parameters)
+            let key = conditionalRequestCache.key(for: request, session: loginCookie?.value)
+            conditionalRequestCache.addValidators(to: &request, forKey: key)
+            let (data, response) = try await urlSession.data(for: request, willRedirect: { $1 })
+            result = .success((data, response, key))
+        } catch {
+            result = .failure(error)
+        }
+
+        noticeRemoteLogOut(wasLoggedIn: wasLoggedIn)
+
+        let (fetchedData, fetchedResponse, key) = try result.get()
+        var (data, response) = (fetchedData, fetchedResponse)
+
+        if let entry = conditionalRequestCache.unchangedEntry(forKey: key, response: response, data: data) {
+            let objects = await mainContext.perform {
+                entry.objectIDs.compactMap { try? mainContext.existingObject(with: $0) as? T }
+            }
+            if objects.count == entry.objectIDs.count {
+                return .unchanged(objects)
+            }
+
+            // Something got pruned or deleted since, so we need to upsert after all.
+            conditionalRequestCache.removeEntry(forKey: key)
+            if (response as? HTTPURLResponse)?.statusCode == 304 {
+                (data, response) = try await fetch(method: .get, urlString: urlString, parameters: parameters)
+            }
+        }
+
+        return .changed(ChangedResponse(data: data, response: response, record: { [conditionalRequestCache, data, response] objectIDs in
+            conditionalRequestCache.record(forKey: key, response: response, data: data, objectIDs: objectIDs, group: group)
+        }))
+    }
+
+    private func makeRequest(
+        method: Method,
+        urlString: String,
+        parameters: some Sequence<KeyValuePairs<String, Any>.Element>
+    ) throws -> URLRequest {
+        guard let url = URL(string: urlString, relativeTo: baseURL),
+              let components = URLComponents(url: url, resolvingAgainstBaseURL: true)
+        else { throw ForumsClient.Error.invalidBaseURL }
+
+        var request: URLRequest
+        switch method {
+        case .get:
+            var queryItems = components.queryItems ?? []
+            queryItems.append(contentsOf: parameters.lazy.map(win1252Escaped(_:)).map { URLQueryItem(name: $0, value: $1) })
+            var components = components
+            components.queryItems = queryItems
+            request = URLRequest(url: components.url!)
+
+        case .post:
+            request = URLRequest(url: url)
+            request.setWin1252MultipartFormData(parameters)
+        }
+        request.httpMethod = method.rawValue
+        return request
+    }
+
+    private func noticeRemoteLogOut(wasLoggedIn: Bool) {
         if wasLoggedIn, !isLoggedIn, let didRemotelyLogOut {
             Task { @MainActor in
                 didRemotelyLogOut()
             }
         }
-
-        return try result.get()
     }
 
     // MARK: Forums Session
@@ -217,7 +342,7 @@ public final class ForumsClient {
         }
         let backgroundUser = try await backgroundContext.perform {
             let managed = try result.upsert(into: backgroundContext)
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
             return managed.currentUser
         }
         return try await mainContext.perform {
@@ -234,12 +359,14 @@ public final class ForumsClient {
         guard let context = backgroundManagedObjectContext else {
             throw Error.missingManagedObjectContext
         }
-        let (data, _) = try await fetch(method: .get, urlString: "index.php?json=1", parameters: [])
-        let result = try JSONDecoder().decode(IndexScrapeResult.self, from: data)
+        let fetched = try await fetchUnlessUnchanged(Forum.self, urlString: "index.php?json=1", parameters: [])
+        guard case let .changed(changed) = fetched else { return }
+        let result = try JSONDecoder().decode(IndexScrapeResult.self, from: changed.data)
         try await context.perform {
             try result.upsert(into: context)
-            try context.save()
+            try context.saveIfChanged()
         }
+        changed.record([])
     }
 
     // MARK: Search
@@ -334,27 +461,34 @@ public final class ForumsClient {
             parameters["posticon"] = threadTagID
         }
 
-        let (data, response) = try await fetch(method: .get, urlString: "forumdisplay.php", parameters: parameters)
-        let (document, url) = try parseHTML(data: data, response: response)
+        let changed: ChangedResponse
+        switch try await fetchUnlessUnchanged(AwfulThread.self, urlString: "forumdisplay.php", parameters: parameters, group: .threadLists) {
+        case .unchanged(let threads):
+            return threads
+        case .changed(let response):
+            changed = response
+        }
+        let (document, url) = try parseHTML(data: changed.data, response: changed.response)
         let result = try ThreadListScrapeResult(document, url: url)
         let backgroundThreads = try await backgroundContext.perform {
             let threads = try result.upsert(into: backgroundContext)
             _ = try result.upsertAnnouncements(into: backgroundContext)
 
             let forum = backgroundContext.object(with: forum.objectID) as! Forum
-            forum.canPost = result.canPostNewThread
+            if result.canPostNewThread != forum.canPost { forum.canPost = result.canPostNewThread }
 
             if
                 page == 1,
                 var threadsToForget = threads.first?.forum?.threads
             {
                 threadsToForget.subtract(threads)
-                threadsToForget.forEach { $0.threadListPage = 0 }
+                threadsToForget.forEach { if $0.threadListPage != 0 { $0.threadListPage = 0 } }
             }
 
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
             return threads
         }
+        changed.record(backgroundThreads.map { $0.objectID })
         return await mainContext.perform {
             backgroundThreads.compactMap { mainContext.object(with: $0.objectID) as? AwfulThread }
         }
@@ -367,12 +501,18 @@ public final class ForumsClient {
               let mainContext = managedObjectContext
         else { throw Error.missingManagedObjectContext }
 
-        let (data, response) = try await fetch(method: .get, urlString: "bookmarkthreads.php", parameters: [
+        let changed: ChangedResponse
+        switch try await fetchUnlessUnchanged(AwfulThread.self, urlString: "bookmarkthreads.php", parameters: [
             "action": "view",
             "perpage": "40",
             "pagenumber": "\(page)",
-        ])
-        let (document, url) = try parseHTML(data: data, response: response)
+        ], group: .threadLists) {
+        case .unchanged(let threads):
+            return threads
+        case .changed(let response):
+            changed = response
+        }
+        let (document, url) = try parseHTML(data: changed.data, response: changed.response)
         let result = try ThreadListScrapeResult(document, url: url)
         let backgroundThreads = try await backgroundContext.perform {
             let threads = try result.upsert(into: backgroundContext)
@@ -386,9 +526,10 @@ public final class ForumsClient {
                 )
             }.forEach { $0.bookmarkListPage = 0 }
 
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
             return threads
         }
+        changed.record(backgroundThreads.map { $0.objectID })
         return await mainContext.perform {
             backgroundThreads.compactMap { mainContext.object(with: $0.objectID) as? AwfulThread }
         }
@@ -498,7 +639,7 @@ public final class ForumsClient {
         let result = try PostIconListScrapeResult(document, url: url)
         let backgroundTags = try await backgroundContext.perform {
             let managed = try result.upsert(into: backgroundContext)
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
             return (primary: managed.primary, secondary: managed.secondary)
         }
         return await mainContext.perform {
@@ -527,7 +668,7 @@ public final class ForumsClient {
 
         let (tagImageName, secondaryTagImageName) = try await backgroundContext.perform {
             _ = try formData.postIcons.upsert(into: backgroundContext)
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
 
             let tagImageName = someThreadTag
                 .flatMap { backgroundContext.object(with: $0.objectID) as? ThreadTag }
@@ -668,7 +809,7 @@ public final class ForumsClient {
         let result = try AnnouncementListScrapeResult(document, url: url)
         let backgroundAnnouncements = try await backgroundContext.perform {
             let announcements = try result.upsert(into: backgroundContext)
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
             return announcements
         }
         return await mainContext.perform {
@@ -696,6 +837,129 @@ public final class ForumsClient {
               let mainContext = managedObjectContext
         else { throw Error.missingManagedObjectContext }
 
+        let (_, parameters) = await postsPageParameters(thread: thread, author: author, page: page, updateLastReadPost: updateLastReadPost)
+        let (data, response) = try await fetch(method: .get, urlString: "showthread.php", parameters: parameters, willRedirect: maintainPostsPerPage)
+        let result = try scrapePostsPage(data: data, response: response)
+
+        try Task.checkCancellation()
+
+        return try await upsertPostsPage(result, backgroundContext: backgroundContext, mainContext: mainContext)
+    }
+
+    /// An update from `streamPosts(in:writtenBy:page:updateLastReadPost:batchSize:)`.
+    public enum PostsPageUpdate {
+        /**
+         Some of the page's posts, in page order, saved and ready to show while the rest of the page loads.
+
+         `pageStartsUnseen` is `true` when the first post on the page is unseen, which means no posts on the page will turn out to be already-seen.
+         */
+        case posts([Post], pageStartsUnseen: Bool)
+
+        /// The whole page is scraped and saved. Same values as returned by `listPosts(in:writtenBy:page:updateLastReadPost:)`.
+        case finished(posts: [Post], firstUnreadPost: Int?, advertisementHTML: String)
+    }
+
+    /**
+     Like `listPosts(in:writtenBy:page:updateLastReadPost:)`, except posts are scraped, saved, and delivered in batches while the rest of the page is still downloading. On a slow connection, the first post can be on screen well before the last post arrives.
+
+     The last update is always `.finished` (unless an error is thrown). Cancelling iteration cancels the request.
+
+     - Parameter batchSize: How many posts to save at once, after the first batch (which is saved as soon as possible).
+     */
+    public func streamPosts(
+        in thread: AwfulThread,
+        writtenBy author: User?,
+        page: ThreadPage,
+        updateLastReadPost: Bool,
+        batchSize: Int = 10
+    ) -> AsyncThrowingStream<PostsPageUpdate, Swift.Error> {
+        AsyncThrowingStream { continuation in
+            let task = Task {
+                do {
+                    try await self.streamPosts(in: thread, writtenBy: author, page: page, updateLastReadPost: updateLastReadPost, batchSize: batchSize, to: continuation)
+                    continuation.finish()
+                } catch {
+                    continuation.finish(throwing: error)
+                }
+            }
+            continuation.onTermination = { _ in task.cancel() }
+        }
+    }
+
+    private func streamPosts(
+        in thread: AwfulThread,
+        writtenBy author: User?,
+        page: ThreadPage,
+        updateLastReadPost: Bool,
+        batchSize: Int,
+        to continuation: AsyncThrowingStream<PostsPageUpdate, Swift.Error>.Continuation
+    ) async throws {
+        guard let backgroundContext = backgroundManagedObjectContext,
+              let mainContext = managedObjectContext
+        else { throw Error.missingManagedObjectContext }
+
+        let (threadID, parameters) = await postsPageParameters(thread: thread, author: author, page: page, updateLastReadPost: updateLastReadPost)
+        let (chunks, response) = try await fetchChunks(urlString: "showthread.php", parameters: parameters, willRedirect: maintainPostsPerPage)
+
+        var scraped: [PostScrapeResult] = []
+        let scraper = PostsPageStreamingScraper(
+            contentTypeHeader: (response as? HTTPURLResponse)?.allHeaderFields["Content-Type"] as? String,
+            url: response.url,
+            didScrapePost: { scraped.append($0) }
+        )
+        var savedCount = 0
+        var pageStartsUnseen = false
+        // Body digests of posts saved so far, so the whole page doesn't save them again.
+        var savedBodyDigests: [PostID: Data] = [:]
+
+        func saveScrapedPosts() async throws {
+            let batch = Array(scraped[savedCount...])
+            guard !batch.isEmpty else { return }
+            if savedCount == 0 {
+                pageStartsUnseen = !batch[0].hasBeenSeen
+            }
+            savedCount = scraped.count
+
+            let (backgroundPosts, bodyDigests) = try await backgroundContext.perform {
+                let posts = try batch.upsert(into: backgroundContext, threadID: threadID, isSingleUserFilterEnabled: author != nil)
+                try backgroundContext.saveIfChanged()
+                return (posts, posts.map { $0.bodyDigest })
+            }
+            for (raw, digest) in zip(batch, bodyDigests) {
+                savedBodyDigests[raw.id] = digest
+            }
+            let posts = await mainContext.perform {
+                backgroundPosts.compactMap { mainContext.object(with: $0.objectID) as? Post }
+            }
+            continuation.yield(.posts(posts, pageStartsUnseen: pageStartsUnseen))
+        }
+
+        for try await chunk in chunks {
+            try scraper.consume(chunk)
+
+            let unsaved = scraped.count - savedCount
+            if unsaved >= batchSize || (savedCount == 0 && unsaved > 0) {
+                try Task.checkCancellation()
+                try await saveScrapedPosts()
+            }
+        }
+        let result = try scraper.finish()
+        if let page = scraper.pageWithoutPosts {
+            try checkServerErrors(page)
+        }
+
+        try Task.checkCancellation()
+
+        let (posts, firstUnreadPost, advertisementHTML) = try await upsertPostsPage(result, skippingBodyDigests: savedBodyDigests, backgroundContext: backgroundContext, mainContext: mainContext)
+        continuation.yield(.finished(posts: posts, firstUnreadPost: firstUnreadPost, advertisementHTML: advertisementHTML))
+    }
+
+    private func postsPageParameters(
+        thread: AwfulThread,
+        author: User?,
+        page: ThreadPage,
+        updateLastReadPost: Bool
+    ) async -> (threadID: String, parameters: [String: Any]) {
         let threadID: String = await thread.managedObjectContext!.perform {
             thread.threadID
         }
@@ -721,31 +985,18 @@ public final class ForumsClient {
             parameters["userid"] = userID
         }
 
-        // SA: We set perpage=40 above to effectively ignore the user's "number of posts per page" setting on the Forums proper. When we get redirected (i.e. goto=newpost or goto=lastpost), the page we're redirected to is appropriate for our hardcoded perpage=40. However, the redirected URL has **no** perpage parameter, so it defaults to the user's setting from the Forums proper. This block maintains our hardcoded perpage value.
-        func redirect(
-            response: HTTPURLResponse,
-            newRequest: URLRequest
-        ) async -> URLRequest? {
-            var components = newRequest.url.flatMap { URLComponents(url: $0, resolvingAgainstBaseURL: true) }
-            let queryItems = (components?.queryItems ?? [])
-                .filter { $0.name != "perpage" }
-            components?.queryItems = queryItems
-                + [URLQueryItem(name: "perpage", value: "40")]
-
-            var request = newRequest
-            request.url = components?.url
-            return request
-        }
-
-        let (data, response) = try await fetch(method: .get, urlString: "showthread.php", parameters: parameters, willRedirect: redirect)
-        let (document, url) = try parseHTML(data: data, response: response)
-        let result = try PostsPageScrapeResult(document, url: url)
-
-        try Task.checkCancellation()
+        return (threadID, parameters)
+    }
 
+    private func upsertPostsPage(
+        _ result: PostsPageScrapeResult,
+        skippingBodyDigests alreadySaved: [PostID: Data] = [:],
+        backgroundContext: NSManagedObjectContext,
+        mainContext: NSManagedObjectContext
+    ) async throws -> (posts: [Post], firstUnreadPost: Int?, advertisementHTML: String) {
         let backgroundPosts = try await backgroundContext.perform {
-            let posts = try result.upsert(into: backgroundContext)
-            try backgroundContext.save()
+            let posts = try result.upsert(into: backgroundContext, skippingBodyDigests: alreadySaved)
+            try backgroundContext.saveIfChanged()
             return posts
         }
         let posts = await mainContext.perform {
@@ -759,6 +1010,55 @@ public final class ForumsClient {
         )
     }
 
+    /**
+     Fetches, scrapes, and saves a page of posts without marking anything as seen. For `ThreadArchiver`, which doesn't need the posts handed back.
+
+     - Returns: The IDs of the posts on the page, and how many pages the thread has (if the page says).
+     */
+    func archivePostsPage(threadID: String, page: Int) async throws -> (postIDs: [String], pageCount: Int?) {
+        guard let backgroundContext = backgroundManagedObjectContext else {
+            throw Error.missingManagedObjectContext
+        }
+
+        let (data, response) = try await fetch(method: .get, urlString: "showthread.php", parameters: [
+            "threadid": threadID,
+            "perpage": "40",
+            "pagenumber": "\(page)",
+            "noseen": "1",
+        ], willRedirect: maintainPostsPerPage)
+        let result = try scrapePostsPage(data: data, response: response)
+
+        try Task.checkCancellation()
+
+        try await backgroundContext.perform {
+            _ = try result.upsert(into: backgroundContext)
+            try backgroundContext.saveIfChanged()
+        }
+        return (postIDs: result.posts.map { $0.id.rawValue }, pageCount: result.pageCount)
+    }
+
+    /// Which of `postIDs` are still saved, e.g. haven't been pruned from the cache since `ThreadArchiver` last saw them.
+    func savedPostIDs(among postIDs: some Collection<String>) async throws -> Set<String> {
+        guard let backgroundContext = backgroundManagedObjectContext else {
+            throw Error.missingManagedObjectContext
+        }
+        guard !postIDs.isEmpty else { return [] }
+
+        let postIDs = Array(postIDs)
+        return try await backgroundContext.perform {
+            var saved: Set<String> = []
+            // Stay well under SQLite's limit on variables per statement.
+            for start in stride(from: 0, to: postIDs.count, by: 500) {
+                let request = NSFetchRequest<NSDictionary>(entityName: Post.entityName)
+                request.resultType = .dictionaryResultType
+                request.propertiesToFetch = ["postID"]
+                request.predicate = NSPredicate(format: "postID IN %@", Array(postIDs[start ..< min(start + 500, postIDs.count)]))
+                saved.formUnion(try backgroundContext.fetch(request).compactMap { $0["postID"] as? String })
+            }
+            return saved
+        }
+    }
+
     /**
      - Parameter post: An ignored post whose author and innerHTML should be filled.
      */
@@ -778,7 +1078,7 @@ public final class ForumsClient {
         let result = try ShowPostScrapeResult(document, url: url)
         try await backgroundContext.perform {
             _ = try result.upsert(into: backgroundContext)
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
         }
         await postContext.perform {
             postContext.refresh(post, mergeChanges: true)
@@ -901,8 +1201,7 @@ public final class ForumsClient {
 
         var request = URLRequest(url: url)
         request.httpMethod = "POST"
-        let escapedParams = formParams.lazy.map(win1252Escaped(_:))
-        try request.setMultipartFormData(escapedParams, encoding: .windowsCP1252)
+        request.setWin1252MultipartFormData(formParams)
         try request.appendFileData(
             attachment.data,
             withName: "attachment",
@@ -1138,8 +1437,7 @@ public final class ForumsClient {
 
         var request = URLRequest(url: url)
         request.httpMethod = "POST"
-        let escapedParams = formParams.lazy.map(win1252Escaped(_:))
-        try request.setMultipartFormData(escapedParams, encoding: .windowsCP1252)
+        request.setWin1252MultipartFormData(formParams)
         try request.appendFileData(
             attachment.data,
             withName: "attachment",
@@ -1233,6 +1531,11 @@ public final class ForumsClient {
         return imageData
     }
 
+    /// Like `fetchAttachmentImageByID(attachmentID:)`, but hands over the image in pieces as it arrives.
+    public func attachmentImageChunks(attachmentID: String) async throws -> (AsyncThrowingStream<Data, Swift.Error>, URLResponse) {
+        try await fetchChunks(urlString: "attachment.php", parameters: ["attachmentid": attachmentID])
+    }
+
     /**
      - Parameter postID: The post's ID. Specified directly in case no such post exists, which would make for a useless `Post`.
      - Returns: The promise of a post (with its `thread` set) and the page containing the post (may be `AwfulThreadPage.last`).
@@ -1386,7 +1689,7 @@ public final class ForumsClient {
         let result = try ProfileScrapeResult(document, url: url)
         return try await backgroundContext.perform {
             let profile = try result.upsert(into: backgroundContext)
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
             return profile
         }
     }
@@ -1500,7 +1803,7 @@ public final class ForumsClient {
         let backgroundMessages = try await backgroundContext.perform {
             let messages = try result.upsert(into: backgroundContext, folderID: folderID)
             do {
-                try backgroundContext.save()
+                try backgroundContext.saveIfChanged()
             } catch let error as NSError {
                 // Core Data validation errors bury the per-attribute details inside NSDetailedErrorsKey.
                 let detailed = (error.userInfo[NSDetailedErrorsKey] as? [NSError])?.map { detail -> String in
@@ -1548,7 +1851,7 @@ public final class ForumsClient {
                 folders.append(folder)
             }
 
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
             return folders
         }
 
@@ -1736,7 +2039,7 @@ public final class ForumsClient {
             if bgMessage.isSent != isSent { bgMessage.isSent = isSent }
             bgMessage.lastModifiedDate = Date()
 
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
         }
     }
 
@@ -1755,7 +2058,7 @@ public final class ForumsClient {
         let result = try PrivateMessageScrapeResult(document, url: url)
         let backgroundMessage = try await backgroundContext.perform {
             let message = try result.upsert(into: backgroundContext)
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
             return message
         }
         return try await mainContext.perform {
@@ -1790,7 +2093,7 @@ public final class ForumsClient {
         let result = try PostIconListScrapeResult(document, url: url)
         let backgroundTags = try await backgroundContext.perform {
             let managed = try result.upsert(into: backgroundContext)
-            try backgroundContext.save()
+            try backgroundContext.saveIfChanged()
             return managed.primary
         }
         return await mainContext.perform {
@@ -1962,6 +2265,34 @@ private func parseHTML(data: Data, response: URLResponse) throws -> ParsedDocume
     return (document: document, url: response.url)
 }
 
+/// Scrapes a posts page without parsing the whole thing into one big `HTMLDocument`.
+private func scrapePostsPage(data: Data, response: URLResponse) throws -> PostsPageScrapeResult {
+    let contentType = (response as? HTTPURLResponse)?.allHeaderFields["Content-Type"] as? String
+    let scraper = PostsPageStreamingScraper(contentTypeHeader: contentType, url: response.url)
+    try scraper.consume(data)
+    let result = try scraper.finish()
+    if let page = scraper.pageWithoutPosts {
+        try checkServerErrors(page)
+    }
+    return result
+}
+
+/// SA: We set perpage=40 when listing posts to effectively ignore the user's "number of posts per page" setting on the Forums proper. When we get redirected (i.e. goto=newpost or goto=lastpost), the page we're redirected to is appropriate for our hardcoded perpage=40. However, the redirected URL has **no** perpage parameter, so it defaults to the user's setting from the Forums proper. This maintains our hardcoded perpage value.
+private func maintainPostsPerPage(
+    response: HTTPURLResponse,
+    newRequest: URLRequest
+) async -> URLRequest? {
+    var components = newRequest.url.flatMap { URLComponents(url: $0, resolvingAgainstBaseURL: true) }
+    let queryItems = (components?.queryItems ?? [])
+        .filter { $0.name != "perpage" }
+    components?.queryItems = queryItems
+        + [URLQueryItem(name: "perpage", value: "40")]
+
+    var request = newRequest
+    request.url = components?.url
+    return request
+}
+
 private func parseJSONDict(data: Data, response: URLResponse) throws -> [String: Any] {
     let json = try JSONSerialization.jsonObject(with: data, options: [])
     guard let dict = json as? [String: Any] else {
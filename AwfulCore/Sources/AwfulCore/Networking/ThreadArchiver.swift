@@ -0,0 +1,233 @@
+//  ThreadArchiver.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import Foundation
+import os
+
+private let logger = Logger(subsystem: Bundle.main.bundleIdentifier!, category: "ThreadArchiver")
+
+/**
+ Downloads many pages of a thread into the store, e.g. to read a megathread offline.
+
+ Pages go through three stages: fetch, scrape, and upsert. Several pages are in flight at once (see `Configuration.maximumConcurrentPages`), so one page can be scraping or saving while the next is still downloading. Request starts are spaced out so we don't hammer the Forums.
+
+ Finished pages are written to a journal as they complete, so an archive that gets interrupted (cancelled, app killed, network gone) can be resumed by archiving the same thread again. The thread's last page is never considered finished, as it'll probably get more posts. Neither is a page whose posts have since been pruned from the cache.
+ */
+public final class ThreadArchiver {
+
+    public struct Configuration {
+        /// How many pages can be fetched, scraped, or saved at once.
+        public var maximumConcurrentPages: Int
+
+        /// The least amount of time between starting one request and starting the next.
+        public var minimumRequestInterval: TimeInterval
+
+        /// Where to keep track of which pages are done. `nil` means nothing is remembered between archives.
+        public var journalDirectory: URL?
+
+        public init(maximumConcurrentPages: Int = 3, minimumRequestInterval: TimeInterval = 0.25, journalDirectory: URL? = defaultJournalDirectory) {
+            self.maximumConcurrentPages = max(maximumConcurrentPages, 1)
+            self.minimumRequestInterval = max(minimumRequestInterval, 0)
+            self.journalDirectory = journalDirectory
+        }
+
+        public static let `default` = Configuration()
+
+        public static var defaultJournalDirectory: URL? {
+            FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first?
+                .appendingPathComponent("ThreadArchives", isDirectory: true)
+        }
+    }
+
+    public struct Summary: Equatable {
+        /// Pages that were downloaded this time around.
+        public var fetchedPages: Int
+
+        /// Pages that a previous archive already finished.
+        public var skippedPages: Int
+
+        /// Posts found on the fetched pages.
+        public var postCount: Int
+    }
+
+    public let configuration: Configuration
+
+    /// Counts pages, including any skipped because they were already done. Cancelling it cancels the archive.
+    public let progress: Progress
+
+    private let client: ForumsClient
+
+    public init(client: ForumsClient = .shared, configuration: Configuration = .default) {
+        self.client = client
+        self.configuration = configuration
+        progress = Progress(totalUnitCount: -1)
+    }
+
+    /**
+     Fetches and saves pages of a thread.
+
+     - Parameter threadID: The thread to archive.
+     - Parameter pages: Which pages to archive. `nil` means every page, which takes a trip to the last page we know of (or the first page, if this thread is new to us) to find out how many there are now.
+     */
+    public func archive(threadID: String, pages requestedPages: ClosedRange<Int>? = nil) async throws -> Summary {
+        let start = Date()
+        let journal = Journal(threadID: threadID, directory: configuration.journalDirectory)
+        let spacer = RequestSpacer(interval: configuration.minimumRequestInterval)
+        var summary = Summary(fetchedPages: 0, skippedPages: 0, postCount: 0)
+        var alreadyFetched: Set<Int> = []
+
+        let fetchPage = { [client] (page: Int) async throws -> (page: Int, postIDs: [String], pageCount: Int?) in
+            try await spacer.wait()
+            let (postIDs, pageCount) = try await client.archivePostsPage(threadID: threadID, page: page)
+            return (page: page, postIDs: postIDs, pageCount: pageCount)
+        }
+
+        let pages: ClosedRange<Int>
+        if let requestedPages {
+            pages = requestedPages
+        } else {
+            // The thread may have grown since last time. Its last known page is never finished, so it needs fetching anyway.
+            let probe = await journal.pageCount ?? 1
+            let fetched = try await fetchPage(probe)
+            summary.fetchedPages += 1
+            summary.postCount += fetched.postIDs.count
+            alreadyFetched.insert(probe)
+            await journal.finish(page: probe, postIDs: fetched.postIDs, pageCount: fetched.pageCount)
+            pages = 1...max(fetched.pageCount ?? probe, 1)
+        }
+        alreadyFetched.formIntersection(pages)
+
+        // The cache pruner may have deleted posts the journal says we have.
+        let journaled = await journal.finishedPages(in: pages)
+        let saved = try await client.savedPostIDs(among: journaled.values.joined())
+        let remaining = pages.filter { page in
+            guard !alreadyFetched.contains(page) else { return false }
+            guard let postIDs = journaled[page] else { return true }
+            return !postIDs.allSatisfy(saved.contains)
+        }
+        summary.skippedPages = pages.count - remaining.count - alreadyFetched.count
+        progress.totalUnitCount = Int64(pages.count)
+        progress.completedUnitCount = Int64(pages.count - remaining.count)
+
+        let progress = progress
+        try await withTaskCancellationHandler {
+            try await withThrowingTaskGroup(of: (page: Int, postIDs: [String], pageCount: Int?).self) { group in
+                var pending = remaining.makeIterator()
+                for _ in 0..<configuration.maximumConcurrentPages {
+                    guard let page = pending.next() else { break }
+                    group.addTask { try await fetchPage(page) }
+                }
+
+                while let done = try await group.next() {
+                    await journal.finish(page: done.page, postIDs: done.postIDs, pageCount: done.pageCount)
+                    summary.fetchedPages += 1
+                    summary.postCount += done.postIDs.count
+                    progress.completedUnitCount += 1
+
+                    if progress.isCancelled {
+                        throw CancellationError()
+                    }
+                    if let page = pending.next() {
+                        group.addTask { try await fetchPage(page) }
+                    }
+                }
+            }
+        } onCancel: {
+            progress.cancel()
+        }
+
+        logger.info("archived thread \(threadID) pages \(pages.lowerBound)...\(pages.upperBound): fetched \(summary.fetchedPages), skipped \(summary.skippedPages), \(summary.postCount) posts in \(Date().timeIntervalSince(start), format: .fixed(precision: 2))s")
+        return summary
+    }
+
+    /// Forgets which pages of the thread were archived, so the next archive fetches everything again.
+    public func resetJournal(threadID: String) async {
+        await Journal(threadID: threadID, directory: configuration.journalDirectory).reset()
+    }
+}
+
+/// Hands out request start times at least `interval` apart.
+private actor RequestSpacer {
+    private let interval: UInt64
+    private var nextStart: UInt64 = 0
+
+    init(interval: TimeInterval) {
+        self.interval = UInt64(interval * 1_000_000_000)
+    }
+
+    func wait() async throws {
+        let now = DispatchTime.now().uptimeNanoseconds
+        let start = max(now, nextStart)
+        // Reserve our slot before sleeping, so other callers line up behind us.
+        nextStart = start + interval
+        if start > now {
+            try await Task.sleep(nanoseconds: start - now)
+        }
+    }
+}
+
+/// Which pages of a thread have been archived, saved after every change.
+private actor Journal {
+    private struct Contents: Codable {
+        var finishedPages: [FinishedPage] = []
+        var pageCount: Int?
+    }
+
+    private struct FinishedPage: Codable {
+        let page: Int
+
+        /// The page's first and last posts. The page only stays finished while they're still saved.
+        let postIDs: [String]
+    }
+
+    private var contents: Contents
+    private let fileURL: URL?
+
+    init(threadID: String, directory: URL?) {
+        fileURL = directory?.appendingPathComponent("\(threadID).json")
+        contents = fileURL
+            .flatMap { try? Data(contentsOf: $0) }
+            .flatMap { try? JSONDecoder().decode(Contents.self, from: $0) }
+            ?? Contents()
+    }
+
+    var pageCount: Int? { contents.pageCount }
+
+    /// The IDs of the posts on each finished page in `pages`.
+    func finishedPages(in pages: ClosedRange<Int>) -> [Int: [String]] {
+        Dictionary(
+            contents.finishedPages.filter { pages.contains($0.page) }.map { ($0.page, $0.postIDs) },
+            uniquingKeysWith: { $1 })
+    }
+
+    func finish(page: Int, postIDs: [String], pageCount: Int?) {
+        if let pageCount {
+            contents.pageCount = max(contents.pageCount ?? 0, pageCount)
+        }
+        // The last page is still filling up, so it's never done.
+        if let pageCount = contents.pageCount, page >= pageCount {
+            return
+        }
+        contents.finishedPages.removeAll { $0.page == page }
+        contents.finishedPages.append(FinishedPage(page: page, postIDs: [postIDs.first, postIDs.last].compactMap { $0 }))
+        save()
+    }
+
+    func reset() {
+        contents = Contents()
+        if let fileURL {
+            try? FileManager.default.removeItem(at: fileURL)
+        }
+    }
+
+    private func save() {
+        guard let fileURL else { return }
+        do {
+            try FileManager.default.createDirectory(at: fileURL.deletingLastPathComponent(), withIntermediateDirectories: true)
+            try JSONEncoder().encode(contents).write(to: fileURL, options: .atomic)
+        } catch {
+            logger.error("could not save archive journal to \(fileURL): \(error)")
+        }
+    }
+}
@@ -0,0 +1,108 @@
+//  URLSession+chunks.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import Foundation
+
+extension URLSession {
+    /**
+     Like `bytes(for:delegate:)`, but hands over the response body in the pieces it arrives in, rather than a byte at a time.
+
+     Returns once the response arrives. Cancelling the calling task before then, or abandoning the stream afterwards, cancels the request.
+
+     `willRedirect` works the same as in `data(for:willRedirect:)`.
+     */
+    func chunks(
+        for request: URLRequest,
+        willRedirect: @escaping (_ response: HTTPURLResponse, _ newRequest: URLRequest) async -> URLRequest? = { $1 }
+    ) async throws -> (AsyncThrowingStream<Data, Swift.Error>, URLResponse) {
+        let task = dataTask(with: request)
+        let delegate = ChunkDelegate(task, willRedirect: willRedirect)
+        task.delegate = delegate
+        let response = try await withTaskCancellationHandler {
+            try await withCheckedThrowingContinuation { continuation in
+                delegate.start(responseContinuation: continuation)
+            }
+        } onCancel: {
+            task.cancel()
+        }
+        return (delegate.chunks, response)
+    }
+
+    private final class ChunkDelegate: NSObject, URLSessionDataDelegate, @unchecked Sendable {
+        let chunks: AsyncThrowingStream<Data, Swift.Error>
+        private let continuation: AsyncThrowingStream<Data, Swift.Error>.Continuation
+        /// The task holds on to its delegate, so don't hold on to it.
+        private weak var task: URLSessionDataTask?
+        private let lock = NSLock()
+        private var responseContinuation: CheckedContinuation<URLResponse, Swift.Error>?
+        private let willRedirect: (_ response: HTTPURLResponse, _ newRequest: URLRequest) async -> URLRequest?
+
+        init(
+            _ task: URLSessionDataTask,
+            willRedirect: @escaping (_ response: HTTPURLResponse, _ newRequest: URLRequest) async -> URLRequest?
+        ) {
+            var continuation: AsyncThrowingStream<Data, Swift.Error>.Continuation!
+            chunks = AsyncThrowingStream { continuation = $0 }
+            self.continuation = continuation
+            self.task = task
+            self.willRedirect = willRedirect
+            super.init()
+
+            continuation.onTermination = { [weak task] termination in
+                if case .cancelled = termination {
+                    task?.cancel()
+                }
+            }
+        }
+
+        func start(responseContinuation: CheckedContinuation<URLResponse, Swift.Error>) {
+            lock.lock()
+            self.responseContinuation = responseContinuation
+            lock.unlock()
+            task?.resume()
+        }
+
+        /// Returns the continuation waiting on the response, at most once.
+        private func takeResponseContinuation() -> CheckedContinuation<URLResponse, Swift.Error>? {
+            lock.lock()
+            defer { lock.unlock() }
+            let taken = responseContinuation
+            responseContinuation = nil
+            return taken
+        }
+
+        func urlSession(
+            _ session: URLSession,
+            task: URLSessionTask,
+            willPerformHTTPRedirection response: HTTPURLResponse,
+            newRequest request: URLRequest
+        ) async -> URLRequest? {
+            await willRedirect(response, request)
+        }
+
+        func urlSession(
+            _ session: URLSession,
+            dataTask: URLSessionDataTask,
+            didReceive response: URLResponse,
+            completionHandler: @escaping (URLSession.ResponseDisposition) -> Void
+        ) {
+            takeResponseContinuation()?.resume(returning: response)
+            completionHandler(.allow)
+        }
+
+        func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive data: Data) {
+            continuation.yield(data)
+        }
+
+        func urlSession(_ session: URLSession, task: URLSessionTask, didCompleteWithError error: Swift.Error?) {
+            if let error {
+                takeResponseContinuation()?.resume(throwing: error)
+                continuation.finish(throwing: error)
+            } else {
+                takeResponseContinuation()?.resume(throwing: URLError(.badServerResponse))
+                continuation.finish()
+            }
+        }
+    }
+}
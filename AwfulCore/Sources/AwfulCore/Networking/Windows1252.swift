@@ -2,21 +2,27 @@
 //
 //  Copyright 2023 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
 
+import Foundation
+
 /// Turns the pair value into a string, then turns everything in key and value outside win1252 into HTML entities.
 func win1252Escaped(
     _ pair: KeyValuePairs<String, Any>.Element
 ) -> KeyValuePairs<String, String>.Element {
     func escape(_ s: String) -> String {
-        let escaped = s.unicodeScalars.lazy.flatMap { (c: Unicode.Scalar) -> String.UnicodeScalarView in
+        // Usually there's nothing to escape.
+        guard !s.unicodeScalars.allSatisfy(\.isWin1252) else { return s }
+
+        var escaped = String.UnicodeScalarView()
+        for c in s.unicodeScalars {
             if c.isWin1252 {
-                return String.UnicodeScalarView([c])
+                escaped.append(c)
             } else {
-                return "&#\(c.value);".unicodeScalars
+                escaped.append(contentsOf: "&#\(c.value);".unicodeScalars)
             }
         }
-        return String(String.UnicodeScalarView(escaped))
+        return String(escaped)
     }
-    return (key: escape(pair.key), value: escape("\(pair.value)"))
+    return (key: escape(pair.key), value: escape(pair.value as? String ?? "\(pair.value)"))
 }
 
 extension Unicode.Scalar {
@@ -29,4 +35,98 @@ extension Unicode.Scalar {
             return false
         }
     }
+
+    /// The scalar's byte in win1252, or `nil` when `isWin1252` is `false`.
+    var win1252Byte: UInt8? {
+        switch value {
+        case 0...0x7f, 0x81, 0x8d, 0x8f, 0x90, 0x9d, 0xa0...0xff: return UInt8(value)
+        case 0x152: return 0x8c
+        case 0x153: return 0x9c
+        case 0x160: return 0x8a
+        case 0x161: return 0x9a
+        case 0x178: return 0x9f
+        case 0x17d: return 0x8e
+        case 0x17e: return 0x9e
+        case 0x192: return 0x83
+        case 0x2c6: return 0x88
+        case 0x2dc: return 0x98
+        case 0x2013: return 0x96
+        case 0x2014: return 0x97
+        case 0x2018: return 0x91
+        case 0x2019: return 0x92
+        case 0x201a: return 0x82
+        case 0x201c: return 0x93
+        case 0x201d: return 0x94
+        case 0x201e: return 0x84
+        case 0x2020: return 0x86
+        case 0x2021: return 0x87
+        case 0x2022: return 0x95
+        case 0x2026: return 0x85
+        case 0x2030: return 0x89
+        case 0x2039: return 0x8b
+        case 0x203a: return 0x9b
+        case 0x20ac: return 0x80
+        case 0x2122: return 0x99
+        default: return nil
+        }
+    }
+}
+
+extension Data {
+    /**
+     Appends the string in win1252, with anything outside win1252 as an HTML entity. Same result as `win1252Escaped(_:)` then `data(using: .windowsCP1252)`, but without the intermediate strings.
+     */
+    mutating func appendWin1252Escaped(_ string: String) {
+        var string = string
+        string.makeContiguousUTF8()
+        let appended: Void? = string.utf8.withContiguousStorageIfAvailable { utf8 in
+            var i = 0
+            while i < utf8.count {
+                // ASCII is the same in UTF-8 and win1252, and it's most of what we send, so copy it over a run at a time.
+                let runStart = i
+                while i < utf8.count, utf8[i] < 0x80 {
+                    i += 1
+                }
+                if i > runStart {
+                    append(UnsafeBufferPointer(rebasing: utf8[runStart..<i]))
+                }
+                guard i < utf8.count else { break }
+
+                // Swift strings are valid UTF-8, so the lead byte tells us how many continuation bytes follow.
+                let lead = utf8[i]
+                let length = lead < 0xe0 ? 2 : lead < 0xf0 ? 3 : 4
+                var value = UInt32(lead) & (0x7f >> length)
+                for continuation in utf8[(i + 1)..<(i + length)] {
+                    value = value << 6 | UInt32(continuation & 0x3f)
+                }
+                i += length
+
+                appendWin1252Escaped(value)
+            }
+        }
+        if appended == nil {
+            for scalar in string.unicodeScalars {
+                appendWin1252Escaped(scalar.value)
+            }
+        }
+    }
+
+    private mutating func appendWin1252Escaped(_ scalarValue: UInt32) {
+        if let byte = Unicode.Scalar(scalarValue)?.win1252Byte {
+            append(byte)
+            return
+        }
+
+        // "&#1234;"
+        append(contentsOf: [UInt8(ascii: "&"), UInt8(ascii: "#")])
+        var divisor: UInt32 = 1
+        while divisor <= scalarValue / 10 {
+            divisor *= 10
+        }
+        while divisor > 0 {
+            append(UInt8(ascii: "0") + UInt8(scalarValue / divisor % 10))
+            divisor /= 10
+        }
+        append(UInt8(ascii: ";"))
+    }
 }
@@ -15,47 +15,37 @@ extension ForumBreadcrumb {
         if id.rawValue != group.groupID { group.groupID = id.rawValue }
         if name != group.name { group.name = name }
     }
+}
 
-    func upsert(
-        into context: NSManagedObjectContext
-    ) throws -> ForumGroup {
-        let group = ForumGroup.findOrCreate(in: context, matching: .init("\(\ForumGroup.groupID) = \(id.rawValue)")) {
-            $0.groupID = id.rawValue
+extension ForumBreadcrumbsScrapeResult {
+    func gatherUpsertIdentifiers(into identifiers: inout UpsertIdentifiers) {
+        if let group = forums.first {
+            identifiers.forumGroups.insert(group.id.rawValue)
         }
-        update(group)
-        return group
+        identifiers.forums.formUnion(forums.dropFirst().map { $0.id.rawValue })
     }
-}
 
-extension ForumBreadcrumbsScrapeResult {
     func upsert(
         into context: NSManagedObjectContext
     ) throws -> (group: ForumGroup?, forums: [Forum]) {
-        let group = try forums.first.map {
-            try $0.upsert(into: context) as ForumGroup
-        }
-        let rawForums = self.forums.dropFirst()
-
-        var unorderedForums: [ForumID: Forum] = [:]
-        let knownForums = Forum.fetch(in: context) {
-            let rawForumIDs = rawForums.map { $0.id.rawValue }
-            $0.predicate = .init("\(\Forum.forumID) in \(rawForumIDs)")
-            $0.returnsObjectsAsFaults = false
-        }
-        for forum in knownForums {
-            let id = ForumID(forum.forumID)
-            unorderedForums[id] = forum
-        }
+        var identifiers = UpsertIdentifiers()
+        gatherUpsertIdentifiers(into: &identifiers)
+        return try upsert(using: UpsertBatches(in: context, identifiers: identifiers))
+    }
 
-        for rawForum in rawForums where unorderedForums[rawForum.id] == nil {
-            let forum = Forum.insert(into: context)
-            forum.forumID = rawForum.id.rawValue
-            unorderedForums[rawForum.id] = forum
+    /// - Parameter batches: Must include the identifiers from `gatherUpsertIdentifiers(into:)`.
+    func upsert(
+        using batches: UpsertBatches
+    ) throws -> (group: ForumGroup?, forums: [Forum]) {
+        let group = forums.first.map { raw -> ForumGroup in
+            let group = batches.forumGroups[raw.id.rawValue]
+            raw.update(group)
+            return group
         }
 
-        let forums = rawForums.compactMap { (raw) -> Forum? in
-            let forum = unorderedForums[raw.id]
-            if let forum = forum { raw.update(forum) }
+        let forums = self.forums.dropFirst().map { raw -> Forum in
+            let forum = batches.forums[raw.id.rawValue]
+            raw.update(forum)
             return forum
         }
 
@@ -67,7 +57,7 @@ extension ForumBreadcrumbsScrapeResult {
         for forum in forums {
             if group != forum.group { forum.group = group }
 
-            if forum.group?.groupID == ForumGroupID.archives.rawValue {
+            if forum.group?.groupID == ForumGroupID.archives.rawValue, forum.canPost {
                 forum.canPost = false
             }
         }
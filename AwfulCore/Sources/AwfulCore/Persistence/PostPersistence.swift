@@ -5,14 +5,15 @@
 import CoreData
 
 internal extension PostScrapeResult {
-    func update(_ post: Post) {
+    /// - Parameter bodyDigest: The digest of `body`, if it's already known.
+    func update(_ post: Post, bodyDigest: Data? = nil) {
         if let user = post.author {
             author.update(user)
 
             if authorCanReceivePrivateMessages != user.canReceivePrivateMessages { user.canReceivePrivateMessages = authorCanReceivePrivateMessages }
         }
 
-        if !body.isEmpty, body != post.innerHTML { post.innerHTML = body }
+        if !body.isEmpty { post.setInnerHTML(body, digest: bodyDigest ?? PostBodyStore.digest(of: body)) }
         if id.rawValue != post.postID { post.postID = id.rawValue }
         if isEditable != post.editable { post.editable = isEditable }
         if isIgnored != post.ignored { post.ignored = isIgnored }
@@ -22,34 +23,47 @@ internal extension PostScrapeResult {
 }
 
 internal extension PostsPageScrapeResult {
-    func upsert(into context: NSManagedObjectContext) throws -> [Post] {
+    func gatherUpsertIdentifiers(into identifiers: inout UpsertIdentifiers) {
+        breadcrumbs?.gatherUpsertIdentifiers(into: &identifiers)
+        if let forumID {
+            identifiers.forums.insert(forumID.rawValue)
+        }
+        if let threadID {
+            identifiers.threads.insert(threadID.rawValue)
+        }
+        posts.gatherUpsertIdentifiers(into: &identifiers)
+    }
+
+    /// - Parameter alreadySaved: Body digests of posts that were saved ahead of the rest of the page (see `Array<PostScrapeResult>.upsert(into:threadID:isSingleUserFilterEnabled:)`). Posts whose body still has the same digest aren't updated again.
+    func upsert(
+        into context: NSManagedObjectContext,
+        skippingBodyDigests alreadySaved: [PostID: Data] = [:]
+    ) throws -> [Post] {
+        var identifiers = UpsertIdentifiers()
+        gatherUpsertIdentifiers(into: &identifiers)
+        let batches = UpsertBatches(in: context, identifiers: identifiers)
+
         let forum: Forum? = {
             if
                 let breadcrumbs = breadcrumbs,
-                let forums = try? breadcrumbs.upsert(into: context).forums,
+                let forums = try? breadcrumbs.upsert(using: batches).forums,
                 let last = forums.last,
                 last.forumID == forumID?.rawValue
             {
                 return last
             }
             else if let forumID = forumID {
-                return Forum.findOrCreate(
-                    in: context,
-                    matching: .init("\(\Forum.forumID) = \(forumID.rawValue)"),
-                    configure: { $0.forumID = forumID.rawValue })
+                return batches.forums[forumID.rawValue]
             }
             else {
                 return nil
             }
         }()
 
-        let users = try upsertUsers(into: context)
+        let users = posts.upsertAuthors(using: batches)
 
         let thread = threadID.map { id -> AwfulThread in
-            let thread = AwfulThread.findOrCreate(
-                in: context,
-                matching: .init("\(\AwfulThread.threadID) = \(id.rawValue)"),
-                configure: { $0.threadID = id.rawValue })
+            let thread = batches.threads[id.rawValue]
 
             if let forum = forum, thread.forum != forum { thread.forum = forum }
             if id.rawValue != thread.threadID { thread.threadID = id.rawValue }
@@ -90,22 +104,16 @@ internal extension PostsPageScrapeResult {
             return thread
         }
 
-        let existingPosts = Dictionary(
-            Post.fetch(in: context) { request in
-                let postIDs = self.posts.map { $0.id.rawValue }
-                request.predicate = .init("\(\Post.postID) in \(postIDs)")
-                request.returnsObjectsAsFaults = false
-            }.map { (PostID(rawValue: $0.postID)!, $0) },
-            uniquingKeysWith: { $1 }
-        )
-
         let posts = self.posts.map { raw -> Post in
-            let post = existingPosts[raw.id] ?? Post.insert(into: context)
+            let post = batches.posts[raw.id.rawValue]
 
             if let thread = thread, thread != post.thread { post.thread = thread }
             if let user = users[raw.author.userID], user != post.author { post.author = user }
 
-            raw.update(post)
+            let digest = PostBodyStore.digest(of: raw.body)
+            if alreadySaved[raw.id] != digest || post.bodyDigest != digest {
+                raw.update(post, bodyDigest: digest)
+            }
 
             return post
         }
@@ -147,27 +155,75 @@ internal extension PostsPageScrapeResult {
 
         return posts
     }
+}
 
-    private func upsertUsers(
-        into context: NSManagedObjectContext
-    ) throws -> [UserID: User] {
-        let authors = posts.map { $0.author }
-
-        var users = Dictionary(
-            grouping: User.fetch(in: context) { request in
-                let userIDs = Set(posts.map { $0.author.userID.rawValue })
-                request.predicate = .init("\(\User.userID) IN \(userIDs)")
-                request.returnsObjectsAsFaults = false
-            },
-            by: { UserID(rawValue: $0.userID)! }
-        ).mapValues(merge)
-
-        for author in authors {
-            let user = users[author.userID] ?? User.insert(into: context)
+internal extension Array where Element == PostScrapeResult {
+    func gatherUpsertIdentifiers(into identifiers: inout UpsertIdentifiers) {
+        for raw in self {
+            identifiers.posts.insert(raw.id.rawValue)
+            identifiers.users.insert(raw.author.userID.rawValue)
+        }
+    }
+
+    /**
+     Saves posts that were scraped ahead of the rest of their page, so they can be shown sooner.
+
+     Only what can be learned from the posts themselves gets saved. Once the whole page is scraped, `PostsPageScrapeResult.upsert(into:)` takes care of the rest.
+     */
+    func upsert(
+        into context: NSManagedObjectContext,
+        threadID: String,
+        isSingleUserFilterEnabled: Bool
+    ) throws -> [Post] {
+        var identifiers = UpsertIdentifiers()
+        gatherUpsertIdentifiers(into: &identifiers)
+        identifiers.threads.insert(threadID)
+        let batches = UpsertBatches(in: context, identifiers: identifiers)
+
+        let users = upsertAuthors(using: batches)
+
+        let thread = batches.threads[threadID]
+
+        let posts = self.map { raw -> Post in
+            let post = batches.posts[raw.id.rawValue]
+
+            if thread != post.thread { post.thread = thread }
+            if let user = users[raw.author.userID], user != post.author { post.author = user }
+
+            raw.update(post)
+
+            return post
+        }
+
+        // Same derivation as the whole page, except we can't fall back to the page number.
+        if
+            let hasIndexInThread = firstIndex(where: { $0.indexInThread != nil }),
+            let indexInThread = self[hasIndexInThread].indexInThread
+        {
+            for (i, post) in posts.enumerated() {
+                let calculatedIndex = indexInThread + i - hasIndexInThread
+                if isSingleUserFilterEnabled {
+                    if calculatedIndex != Int(post.filteredThreadIndex) { post.filteredThreadIndex = Int32(calculatedIndex) }
+                }
+                else {
+                    if calculatedIndex != Int(post.threadIndex) { post.threadIndex = Int32(calculatedIndex) }
+                }
+            }
+        }
+
+        return posts
+    }
+
+    /// - Parameter batches: Must include the identifiers from `gatherUpsertIdentifiers(into:)`.
+    func upsertAuthors(
+        using batches: UpsertBatches
+    ) -> [UserID: User] {
+        var users: [UserID: User] = [:]
+        for author in map({ $0.author }) {
+            let user = batches.users[author.userID.rawValue]
             author.update(user)
             users[author.userID] = user
         }
-
         return users
     }
 }
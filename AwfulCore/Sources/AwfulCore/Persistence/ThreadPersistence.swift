@@ -5,51 +5,42 @@
 import CoreData
 
 internal extension ThreadListScrapeResult {
+    func gatherUpsertIdentifiers(into identifiers: inout UpsertIdentifiers) {
+        breadcrumbs?.gatherUpsertIdentifiers(into: &identifiers)
+        identifiers.threads.formUnion(threads.map { $0.id.rawValue })
+        identifiers.users.formUnion(threads.compactMap { $0.author?.rawValue })
+        identifiers.threadTags += threads.compactMap { $0.icon }
+            + threads.compactMap { $0.secondaryIcon }
+            + filterableIcons
+    }
+
     func upsert(
         into context: NSManagedObjectContext
     ) throws -> [AwfulThread] {
-        let (group: _, forums: forums) = try breadcrumbs?.upsert(into: context) ?? (nil, [])
+        var identifiers = UpsertIdentifiers()
+        gatherUpsertIdentifiers(into: &identifiers)
+        let batches = UpsertBatches(in: context, identifiers: identifiers)
+
+        let (group: _, forums: forums) = try breadcrumbs?.upsert(using: batches) ?? (nil, [])
         let forum = forums.last
 
-        let icons = self.threads.compactMap { $0.icon }
-            + self.threads.compactMap { $0.secondaryIcon }
-            + self.filterableIcons
-        let iconHelper = PostIconPersistenceHelper(context: context, icons: icons)
-        iconHelper.performFetch()
-        
-        forum?.threadTags = NSMutableOrderedSet(array: filterableIcons.map { iconHelper.upsert($0) })
-
-        var users = Dictionary(
-            User.fetch(in: context, configure: { request in
-                let userIDs = self.threads.compactMap { $0.author?.rawValue }
-                request.predicate = .init("\(\User.userID) IN \(userIDs)")
-                request.returnsObjectsAsFaults = false
-            }).map { (UserID(rawValue: $0.userID)!, $0) },
-            uniquingKeysWith: { $1 }
-        )
-        let existingThreads = Dictionary(
-            AwfulThread.fetch(in: context) { request in
-                let threadIDs = self.threads.map { $0.id.rawValue }
-                request.predicate = .init("\(\AwfulThread.threadID) IN \(threadIDs)")
-                request.returnsObjectsAsFaults = false
-            }.map { (ThreadID(rawValue: $0.threadID)!, $0) },
-            uniquingKeysWith: { $1 }
-        )
+        let iconHelper = batches.threadTags
+        if let forum {
+            let threadTags = filterableIcons.map { iconHelper.upsert($0) }
+            if (forum.threadTags.array as? [ThreadTag]) != threadTags {
+                forum.threadTags = NSMutableOrderedSet(array: threadTags)
+            }
+        }
 
         var threads: [AwfulThread] = []
         var stickyIndex = -self.threads.count
         for raw in self.threads {
-            let thread = existingThreads[raw.id] ?? AwfulThread.insert(into: context)
+            let thread = batches.threads[raw.id.rawValue]
 
             raw.update(thread)
 
             if let authorID = raw.author {
-                let author = users[authorID] ?? {
-                    let author = User.insert(into: context)
-                    author.userID = authorID.rawValue
-                    users[authorID] = author
-                    return author
-                }()
+                let author = batches.users[authorID.rawValue]
 
                 if !raw.authorUsername.isEmpty, raw.authorUsername != author.username { author.username = raw.authorUsername }
 
@@ -13,20 +13,37 @@ class UpsertBatch<T: NSManagedObject & Managed> {
     private let idKeyPath: WritableKeyPath<T, String>
     private var objects: [String: T]
 
+    /**
+     - Parameter mergeDuplicates: Called when more than one existing object has the same identifier. Returns the one to keep.
+     */
     init(
         in context: NSManagedObjectContext,
         identifiedBy keyPath: WritableKeyPath<T, String>,
-        identifiers: [String]
+        identifiers: some Collection<String>,
+        mergeDuplicates: ([T]) -> T = { $0[0] }
     ) {
         self.context = context
         idKeyPath = keyPath
 
-        objects = .init(uniqueKeysWithValues:
-            T.fetch(in: context) {
+        // Nothing to find, so don't bother asking.
+        guard !identifiers.isEmpty else {
+            objects = [:]
+            return
+        }
+
+        let identifiers = Array(Set(identifiers))
+        objects = Dictionary(
+            grouping: T.fetch(in: context) {
                 $0.predicate = .init("\(keyPath) IN \(identifiers)")
                 $0.returnsObjectsAsFaults = false
-            }.map { ($0[keyPath: keyPath], $0) }
-        )
+            },
+            by: { $0[keyPath: keyPath] }
+        ).mapValues(mergeDuplicates)
+    }
+
+    /// Returns the existing object, if any, without inserting a new one.
+    func existing(_ id: String) -> T? {
+        return objects[id]
     }
 
     subscript(_ id: String) -> T {
@@ -40,3 +57,49 @@ class UpsertBatch<T: NSManagedObject & Managed> {
         }
     }
 }
+
+/**
+ Every identifier that a scrape result is about to upsert, gathered up front so each entity can be fetched once.
+
+ Scrape results contribute via `gatherUpsertIdentifiers(into:)`.
+ */
+struct UpsertIdentifiers {
+    var forumGroups: Set<String> = []
+    var forums: Set<String> = []
+    var posts: Set<String> = []
+    var threads: Set<String> = []
+    var threadTags: [PostIcon] = []
+    var users: Set<String> = []
+}
+
+/**
+ One `UpsertBatch` per entity (plus thread tags), each made with a single fetch. Entities with no identifiers are not fetched at all.
+ */
+final class UpsertBatches {
+    let forumGroups: UpsertBatch<ForumGroup>
+    let forums: UpsertBatch<Forum>
+    let posts: UpsertBatch<Post>
+    let threads: UpsertBatch<AwfulThread>
+    let threadTags: PostIconPersistenceHelper
+    let users: UpsertBatch<User>
+
+    init(in context: NSManagedObjectContext, identifiers: UpsertIdentifiers) {
+        forumGroups = .init(in: context, identifiedBy: \.groupID, identifiers: identifiers.forumGroups)
+        forums = .init(in: context, identifiedBy: \.forumID, identifiers: identifiers.forums)
+        posts = .init(in: context, identifiedBy: \.postID, identifiers: identifiers.posts)
+        threads = .init(in: context, identifiedBy: \.threadID, identifiers: identifiers.threads)
+        threadTags = .init(context: context, icons: identifiers.threadTags)
+        if !identifiers.threadTags.isEmpty {
+            threadTags.performFetch()
+        }
+        users = .init(in: context, identifiedBy: \.userID, identifiers: identifiers.users, mergeDuplicates: merge)
+    }
+}
+
+extension NSManagedObjectContext {
+    /// Saves only if something actually changed, so refreshing unchanged data doesn't touch the store.
+    func saveIfChanged() throws {
+        guard hasChanges else { return }
+        try save()
+    }
+}
@@ -5,7 +5,7 @@
 import AwfulModelTypes
 import HTMLReader
 
-public struct ForumBreadcrumbsScrapeResult: ScrapeResult {
+public struct ForumBreadcrumbsScrapeResult: Equatable, ScrapeResult {
     public let forums: [ForumBreadcrumb]
 
     public init(_ html: HTMLNode, url: URL?) throws {
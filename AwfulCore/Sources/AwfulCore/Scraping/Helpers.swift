@@ -72,6 +72,24 @@ extension HTMLElement {
 }
 
 
+extension Array {
+    /**
+     Like `map(_:)`, but calls `transform` for several elements at once. Results are in the same order as the elements, and if any calls throw, the error from the earliest element is rethrown.
+
+     `transform` must be safe to call from multiple threads.
+     */
+    func concurrentMap<T>(_ transform: (Element) throws -> T) throws -> [T] {
+        var results = [Result<T, Error>?](repeating: nil, count: count)
+        results.withUnsafeMutableBufferPointer { buffer in
+            DispatchQueue.concurrentPerform(iterations: count) { i in
+                buffer[i] = Result { try transform(self[i]) }
+            }
+        }
+        return try results.map { try $0!.get() }
+    }
+}
+
+
 extension CharacterSet {
     static var asciiWhitespace: CharacterSet {
         .init(charactersIn: "\t\n\u{000C}\r ")
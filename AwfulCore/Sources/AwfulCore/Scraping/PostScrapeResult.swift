@@ -5,7 +5,7 @@
 import Foundation
 import HTMLReader
 
-public struct PostScrapeResult {
+public struct PostScrapeResult: Equatable {
     public let author: AuthorSidebarScrapeResult
     public let authorCanReceivePrivateMessages: Bool
     public let authorIsOriginalPoster: Bool
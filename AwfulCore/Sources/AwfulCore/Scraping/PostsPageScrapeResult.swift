@@ -5,7 +5,7 @@
 import AwfulModelTypes
 import HTMLReader
 
-public struct PostsPageScrapeResult: ScrapeResult {
+public struct PostsPageScrapeResult: Equatable, ScrapeResult {
     public let advertisement: RawHTML
     public let breadcrumbs: ForumBreadcrumbsScrapeResult?
     public let forumID: ForumID?
@@ -21,8 +21,41 @@ public struct PostsPageScrapeResult: ScrapeResult {
     public let threadTitle: String
 
     public init(_ html: HTMLNode, url: URL?) throws {
+        try self.init(html, url: url, scrapesPostsConcurrently: false)
+    }
+
+    /**
+     - Parameter scrapesPostsConcurrently: When `true`, each post is scraped on whichever core is free. Posts come out in page order either way, and if any posts fail to scrape, it's the first one's error that gets thrown. Don't change `html` until this returns.
+     */
+    public init(_ html: HTMLNode, url: URL?, scrapesPostsConcurrently: Bool) throws {
         let body = try html.requiredNode(matchingSelector: "body")
 
+        let postElements = body.nodes(matchingParsedSelector: .cached("table.post"))
+        let posts = try scrapesPostsConcurrently
+            ? postElements.concurrentMap { try PostScrapeResult($0, url: url) }
+            : postElements.map { try PostScrapeResult($0, url: url) }
+
+        self.init(
+            body: body,
+            posts: posts,
+            isSingleUserFilterEnabled: Self.hasSingleUserFilter(in: body),
+            threadIsClosed: Self.hasClosedThreadButton(in: body),
+            url: url
+        )
+    }
+
+    /**
+     Assembles a result from posts that were scraped separately from the rest of the page.
+
+     - Parameter body: The page's `body` element. Any posts it contains are ignored in favor of `posts`.
+     */
+    init(
+        body: HTMLElement,
+        posts: [PostScrapeResult],
+        isSingleUserFilterEnabled: Bool,
+        threadIsClosed: Bool,
+        url: URL?
+    ) {
         advertisement = body
             .firstNode(matchingParsedSelector: .cached("#ad_banner_user a"))?
             .serializedFragment
@@ -32,15 +65,12 @@ public struct PostsPageScrapeResult: ScrapeResult {
 
         forumID = (body["data-forum"] as String?).map { ForumID($0) }
 
-        isSingleUserFilterEnabled = body.firstNode(matchingParsedSelector: .cached("table.post a.user_jump[title *= 'Remove']")) != nil
+        self.isSingleUserFilterEnabled = isSingleUserFilterEnabled
 
         let pageNavData = scrapePageNavigationData(body)
         pageNumber = pageNavData?.currentPage
         pageCount = pageNavData?.totalPages
 
-        let posts = try body
-            .nodes(matchingParsedSelector: .cached("table.post"))
-            .map { (element: HTMLElement) -> PostScrapeResult in try PostScrapeResult(element, url: url) }
         self.posts = posts
 
         /*
@@ -79,7 +109,7 @@ public struct PostsPageScrapeResult: ScrapeResult {
                 }
         }
 
-        threadIsClosed = body.firstNode(matchingParsedSelector: .cached("ul.postbuttons a[href *= 'newreply'] img[src *= 'closed']")) != nil
+        self.threadIsClosed = threadIsClosed
 
         threadTitle = body
             .firstNode(matchingParsedSelector: .cached("div.breadcrumbs a[href *= 'threadid']"))?
@@ -88,6 +118,24 @@ public struct PostsPageScrapeResult: ScrapeResult {
     }
 }
 
+extension PostsPageScrapeResult {
+    static func hasSingleUserFilter(in html: HTMLNode) -> Bool {
+        html.firstNode(matchingParsedSelector: .cached("table.post a.user_jump[title *= 'Remove']")) != nil
+    }
+
+    static func hasClosedThreadButton(in html: HTMLNode) -> Bool {
+        html.firstNode(matchingParsedSelector: .cached("ul.postbuttons a[href *= 'newreply'] img[src *= 'closed']")) != nil
+    }
+}
+
+extension PostsPageScrapeResult: StreamingScrapeResult {
+    public init(data: Data, contentTypeHeader: String?, url: URL?) throws {
+        let scraper = PostsPageStreamingScraper(contentTypeHeader: contentTypeHeader, url: url)
+        try scraper.consume(data)
+        self = try scraper.finish()
+    }
+}
+
 private func parsePti(_ fragment: String) -> Int? {
     let scanner = Scanner(scraping: fragment)
     if scanner.scanString("pti") == nil { return nil }
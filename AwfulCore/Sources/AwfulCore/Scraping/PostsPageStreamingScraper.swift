@@ -0,0 +1,391 @@
+//  PostsPageStreamingScraper.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import Foundation
+import HTMLReader
+
+/**
+ Scrapes a posts page (i.e. `showthread.php`) straight from its response bytes, one post at a time.
+
+ `PostsPageScrapeResult.init(_:url:)` wants an `HTMLDocument` of the whole page, which for an image-heavy 40-post page is a big tree that sticks around until the last post is scraped. Instead, this scraper tokenizes just enough of the raw bytes to find where each `table.post` starts and ends, then parses and scrapes that one post and throws its tree away. Everything that isn't a post gets stitched back together and parsed once at the end for the page-level bits like breadcrumbs and page count.
+
+ Bytes can arrive in chunks of any size. `didScrapePost` is called as soon as each post's closing `</table>` shows up.
+
+ Only ASCII-compatible encodings are supported, which is fine because the Forums send windows-1252.
+ */
+public final class PostsPageStreamingScraper {
+    private let didScrapePost: (PostScrapeResult) -> Void
+    private var encoding: String.Encoding?
+    private let url: URL?
+
+    /// Bytes not yet handed off to either `pageBytes` or a post.
+    private var buffer: [UInt8] = []
+    /// Index into `buffer` of the next byte to tokenize.
+    private var cursor = 0
+    /// Index into `buffer` of the first byte that's neither been tokenized as part of a post nor moved to `pageBytes`.
+    private var pageCursor = 0
+    /// Index into `buffer` of the start of the `table.post` we're currently in.
+    private var postStart: Int?
+    private var tableDepth = 0
+
+    private var pageBytes: [UInt8] = []
+    private var posts: [PostScrapeResult] = []
+    private var postsEnableSingleUserFilter = false
+    private var postsHaveClosedThreadButton = false
+
+    /// The page with all of its posts removed. Available after calling `finish()`.
+    public private(set) var pageWithoutPosts: HTMLDocument?
+
+    public init(
+        contentTypeHeader: String?,
+        url: URL?,
+        didScrapePost: @escaping (PostScrapeResult) -> Void = { _ in }
+    ) {
+        encoding = contentTypeHeader.flatMap(stringEncoding(contentTypeHeader:))
+        self.url = url
+        self.didScrapePost = didScrapePost
+    }
+
+    /// Tokenizes some more of the page, scraping any posts that are now complete.
+    public func consume(_ bytes: some Sequence<UInt8>) throws {
+        buffer.append(contentsOf: bytes)
+        try tokenize()
+
+        let keepFrom = postStart ?? cursor
+        pageBytes.append(contentsOf: buffer[pageCursor..<keepFrom])
+        buffer.removeSubrange(..<keepFrom)
+        cursor -= keepFrom
+        postStart = postStart.map { $0 - keepFrom }
+        pageCursor = 0
+    }
+
+    /// Scrapes whatever's left of the page. Call once, after consuming all of the response body.
+    public func finish() throws -> PostsPageScrapeResult {
+        if let postStart {
+            // The HTML parser closes any elements left open at the end of the document, so a truncated post is still a post.
+            pageBytes.append(contentsOf: buffer[pageCursor..<postStart])
+            try scrapePost(buffer[postStart...])
+        } else {
+            pageBytes.append(contentsOf: buffer[pageCursor...])
+        }
+        buffer = []
+        cursor = 0
+        pageCursor = 0
+        postStart = nil
+
+        let page = HTMLDocument(string: decode(pageBytes))
+        pageBytes = []
+        pageWithoutPosts = page
+
+        let body = try page.requiredNode(matchingSelector: "body")
+        return PostsPageScrapeResult(
+            body: body,
+            posts: posts,
+            isSingleUserFilterEnabled: postsEnableSingleUserFilter || PostsPageScrapeResult.hasSingleUserFilter(in: body),
+            threadIsClosed: postsHaveClosedThreadButton || PostsPageScrapeResult.hasClosedThreadButton(in: body),
+            url: url
+        )
+    }
+
+    private func tokenize() throws {
+        while let lessThan = buffer[cursor...].firstIndex(of: .lessThan) {
+            guard let next = try tokenizeMarkup(at: lessThan) else {
+                // Need more bytes to see the whole tag.
+                cursor = lessThan
+                return
+            }
+            cursor = next
+        }
+        cursor = buffer.endIndex
+    }
+
+    /// Returns the index just past the markup starting at `start`, or `nil` if the markup continues past the end of `buffer`.
+    private func tokenizeMarkup(at start: Int) throws -> Int? {
+        let afterLessThan = start + 1
+        guard afterLessThan < buffer.endIndex else { return nil }
+
+        switch buffer[afterLessThan] {
+        case .exclamationMark:
+            switch hasPrefix(commentOpener, at: start) {
+            case nil:
+                return nil
+            case .some(true):
+                // Starting the search for `-->` from the opening `--` also catches `<!-->` and `<!--->`.
+                return find(commentCloser, from: afterLessThan + 1).map { $0 + commentCloser.count }
+            case .some(false):
+                return find([.greaterThan], from: afterLessThan).map { $0 + 1 }
+            }
+
+        case .questionMark:
+            return find([.greaterThan], from: afterLessThan).map { $0 + 1 }
+
+        case .solidus:
+            guard let nameEnd = tagNameEnd(from: afterLessThan + 1),
+                  let greaterThan = find([.greaterThan], from: nameEnd)
+            else { return nil }
+            let end = greaterThan + 1
+
+            if postStart != nil, asciiCaseInsensitiveEquals(buffer[(afterLessThan + 1)..<nameEnd], table) {
+                tableDepth -= 1
+                if tableDepth == 0 {
+                    try endPost(at: end)
+                }
+            }
+            return end
+
+        case let byte where byte.isASCIILetter:
+            guard let nameEnd = tagNameEnd(from: afterLessThan),
+                  let end = startTagEnd(from: nameEnd)
+            else { return nil }
+            let name = buffer[afterLessThan..<nameEnd]
+
+            if asciiCaseInsensitiveEquals(name, table) {
+                if postStart != nil {
+                    tableDepth += 1
+                } else if classAttribute(in: buffer[nameEnd..<end]).contains("post") {
+                    postStart = start
+                    tableDepth = 1
+                }
+            } else if let rawText = rawTextElements.first(where: { asciiCaseInsensitiveEquals(name, $0) }) {
+                // Nothing in here is markup, so skip ahead to the end tag (which gets tokenized as usual).
+                return findEndTag(rawText, from: end)
+            }
+            return end
+
+        default:
+            // Just a less-than sign hanging out in some text.
+            return afterLessThan
+        }
+    }
+
+    private func endPost(at end: Int) throws {
+        guard let postStart else { return }
+        pageBytes.append(contentsOf: buffer[pageCursor..<postStart])
+        pageCursor = end
+        self.postStart = nil
+
+        try scrapePost(buffer[postStart..<end])
+    }
+
+    private func scrapePost(_ bytes: ArraySlice<UInt8>) throws {
+        let html = HTMLDocument(string: decode(bytes))
+        let post = try PostScrapeResult(html, url: url)
+
+        if !postsEnableSingleUserFilter, PostsPageScrapeResult.hasSingleUserFilter(in: html) {
+            postsEnableSingleUserFilter = true
+        }
+        if !postsHaveClosedThreadButton, PostsPageScrapeResult.hasClosedThreadButton(in: html) {
+            postsHaveClosedThreadButton = true
+        }
+
+        posts.append(post)
+        didScrapePost(post)
+    }
+
+    private func decode(_ bytes: some Collection<UInt8>) -> String {
+        if encoding == nil {
+            // Any `<meta charset>` is in the `<head>`, which shows up well before the first post.
+            encoding = stringEncoding(prescanning: pageBytes) ?? .windowsCP1252
+        }
+        return String(bytes: bytes, encoding: encoding!)
+            // windows-1252 leaves a few bytes undefined, and Foundation gives up when it sees one.
+            ?? String(bytes: bytes, encoding: .isoLatin1)!
+    }
+
+    // MARK: Byte wrangling
+
+    /// `true` or `false` if `buffer` does or doesn't have `prefix` at `start`, or `nil` if `buffer` ends before we can tell.
+    private func hasPrefix(_ prefix: [UInt8], at start: Int) -> Bool? {
+        for (offset, byte) in prefix.enumerated() {
+            let i = start + offset
+            guard i < buffer.endIndex else { return nil }
+            if buffer[i] != byte { return false }
+        }
+        return true
+    }
+
+    private func find(_ needle: [UInt8], from start: Int) -> Int? {
+        var i = start
+        while let candidate = buffer[i...].firstIndex(of: needle[0]) {
+            guard let found = hasPrefix(needle, at: candidate) else { return nil }
+            if found { return candidate }
+            i = candidate + 1
+        }
+        return nil
+    }
+
+    private func tagNameEnd(from start: Int) -> Int? {
+        buffer[start...].firstIndex { $0.isASCIIWhitespace || $0 == .solidus || $0 == .greaterThan }
+    }
+
+    /// Returns the index just past the `>` that ends a start tag, skipping over any `>` in quoted attribute values.
+    private func startTagEnd(from start: Int) -> Int? {
+        var quote: UInt8?
+        var i = start
+        while i < buffer.endIndex {
+            let byte = buffer[i]
+            if let q = quote {
+                if byte == q { quote = nil }
+            } else if byte == .greaterThan {
+                return i + 1
+            } else if byte == .equals {
+                guard let valueStart = buffer[(i + 1)...].firstIndex(where: { !$0.isASCIIWhitespace }) else { return nil }
+                if buffer[valueStart] == .quotationMark || buffer[valueStart] == .apostrophe {
+                    quote = buffer[valueStart]
+                    i = valueStart
+                }
+            }
+            i += 1
+        }
+        return nil
+    }
+
+    /// Returns the index of the `<` that starts the end tag for `name`.
+    private func findEndTag(_ name: [UInt8], from start: Int) -> Int? {
+        var i = start
+        while let candidate = find([.lessThan, .solidus], from: i) {
+            let nameStart = candidate + 2
+            let nameEnd = nameStart + name.count
+            guard nameEnd < buffer.endIndex else { return nil }
+            if asciiCaseInsensitiveEquals(buffer[nameStart..<nameEnd], name) {
+                let next = buffer[nameEnd]
+                if next.isASCIIWhitespace || next == .solidus || next == .greaterThan {
+                    return candidate
+                }
+            }
+            i = candidate + 2
+        }
+        return nil
+    }
+
+    /// Returns the class names found in the first `class` attribute of a start tag.
+    private func classAttribute(in attributes: ArraySlice<UInt8>) -> Set<String> {
+        var i = attributes.startIndex
+        let end = attributes.endIndex
+        func skipWhitespace() {
+            while i < end, attributes[i].isASCIIWhitespace { i += 1 }
+        }
+
+        while i < end {
+            while i < end, attributes[i].isASCIIWhitespace || attributes[i] == .solidus { i += 1 }
+            let nameStart = i
+            while i < end, !attributes[i].isASCIIWhitespace, ![UInt8.equals, .greaterThan, .solidus].contains(attributes[i]) { i += 1 }
+            let name = attributes[nameStart..<i]
+            guard !name.isEmpty else { break }
+
+            skipWhitespace()
+            var value: ArraySlice<UInt8> = []
+            if i < end, attributes[i] == .equals {
+                i += 1
+                skipWhitespace()
+                if i < end, attributes[i] == .quotationMark || attributes[i] == .apostrophe {
+                    let quote = attributes[i]
+                    let valueStart = i + 1
+                    i = attributes[valueStart...].firstIndex(of: quote) ?? end
+                    value = attributes[valueStart..<i]
+                    i = min(i + 1, end)
+                } else {
+                    let valueStart = i
+                    while i < end, !attributes[i].isASCIIWhitespace, attributes[i] != .greaterThan { i += 1 }
+                    value = attributes[valueStart..<i]
+                }
+            }
+
+            if asciiCaseInsensitiveEquals(name, classAttributeName) {
+                return Set(value
+                    .split(whereSeparator: { $0.isASCIIWhitespace })
+                    .map { String(decoding: $0, as: UTF8.self) })
+            }
+        }
+        return []
+    }
+}
+
+private let classAttributeName = Array("class".utf8)
+private let commentCloser = Array("-->".utf8)
+private let commentOpener = Array("<!--".utf8)
+private let table = Array("table".utf8)
+
+/// Elements whose contents are tokenized as text, so a `<table>` inside them doesn't count.
+private let rawTextElements = ["iframe", "noembed", "noframes", "script", "style", "textarea", "title", "xmp"].map { Array($0.utf8) }
+
+private func asciiCaseInsensitiveEquals(_ lhs: some Collection<UInt8>, _ rhs: some Collection<UInt8>) -> Bool {
+    lhs.count == rhs.count && zip(lhs, rhs).allSatisfy { $0.asciiLowercased == $1.asciiLowercased }
+}
+
+private extension UInt8 {
+    static let apostrophe = UInt8(ascii: "'")
+    static let equals = UInt8(ascii: "=")
+    static let exclamationMark = UInt8(ascii: "!")
+    static let greaterThan = UInt8(ascii: ">")
+    static let lessThan = UInt8(ascii: "<")
+    static let questionMark = UInt8(ascii: "?")
+    static let quotationMark = UInt8(ascii: "\"")
+    static let solidus = UInt8(ascii: "/")
+
+    var asciiLowercased: UInt8 {
+        isASCIIUppercaseLetter ? self | 0x20 : self
+    }
+
+    var isASCIILetter: Bool {
+        isASCIIUppercaseLetter || (UInt8(ascii: "a")...UInt8(ascii: "z")).contains(self)
+    }
+
+    var isASCIIUppercaseLetter: Bool {
+        (UInt8(ascii: "A")...UInt8(ascii: "Z")).contains(self)
+    }
+
+    var isASCIIWhitespace: Bool {
+        self == 0x09 || self == 0x0A || self == 0x0C || self == 0x0D || self == 0x20
+    }
+}
+
+// MARK: - Encoding sniffing
+
+/// Finds the character encoding named in a `Content-Type` header like `text/html; charset=windows-1252`.
+func stringEncoding(contentTypeHeader: String) -> String.Encoding? {
+    let scanner = Scanner(scraping: contentTypeHeader.lowercased())
+    guard scanner.scanUpToAndPastString("charset=") else { return nil }
+    _ = scanner.scanString("\"")
+    guard let label = scanner.scanUpToCharacters(from: CharacterSet(charactersIn: "\"; ")) else { return nil }
+    return stringEncoding(label: label)
+}
+
+/// Looks for a byte order mark or a `<meta>` charset in the first kilobyte of a document.
+func stringEncoding(prescanning bytes: some Collection<UInt8>) -> String.Encoding? {
+    if bytes.starts(with: [0xEF, 0xBB, 0xBF]) {
+        return .utf8
+    }
+    let head = String(decoding: bytes.prefix(1024), as: UTF8.self).lowercased()
+    let scanner = Scanner(scraping: head)
+    while scanner.scanUpToAndPastString("<meta") {
+        guard let tag = scanner.scanUpToString(">") else { continue }
+        let tagScanner = Scanner(scraping: tag)
+        guard tagScanner.scanUpToAndPastString("charset=") else { continue }
+        _ = tagScanner.scanCharacters(from: CharacterSet(charactersIn: "\"' "))
+        if let label = tagScanner.scanUpToCharacters(from: CharacterSet(charactersIn: "\"'; /")),
+           let encoding = stringEncoding(label: label)
+        {
+            return encoding
+        }
+    }
+    return nil
+}
+
+private func stringEncoding(label: String) -> String.Encoding? {
+    switch label.lowercased() {
+    case "utf-8", "utf8", "unicode-1-1-utf-8":
+        return .utf8
+    case "ascii", "cp1252", "iso-8859-1", "latin1", "us-ascii", "windows-1252", "x-cp1252":
+        // The HTML spec treats all of these as windows-1252.
+        return .windowsCP1252
+    case let label where label.hasPrefix("utf-16") || label.hasPrefix("utf-32"):
+        // Not ASCII-compatible, and no sensible server sends it anyway.
+        return nil
+    case let label:
+        let encoding = CFStringConvertIANACharSetNameToEncoding(label as CFString)
+        guard encoding != kCFStringEncodingInvalidId else { return nil }
+        return String.Encoding(rawValue: CFStringConvertEncodingToNSStringEncoding(encoding))
+    }
+}
@@ -11,6 +11,15 @@ public protocol ScrapeResult {
     init(_ html: HTMLNode, url: URL?) throws
 }
 
+/**
+ A scraper that can work straight from a response body, without first parsing the whole page into an `HTMLDocument`.
+
+ Results must be identical to parsing the same bytes into an `HTMLDocument` and calling `init(_:url:)`.
+ */
+public protocol StreamingScrapeResult: ScrapeResult {
+    init(data: Data, contentTypeHeader: String?, url: URL?) throws
+}
+
 
 // MARK: - Types common to several scrapers
 
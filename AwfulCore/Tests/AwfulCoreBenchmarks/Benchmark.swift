@@ -0,0 +1,152 @@
+//  Benchmark.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import Foundation
+import XCTest
+
+#if canImport(Darwin)
+import Darwin
+#endif
+
+/**
+ Times some work, compares it with `Baseline.json`, and fails the test if it got too much slower.
+
+ Environment variables:
+
+ - `AWFUL_BENCHMARK_ITERATIONS`: How many timed runs to take the median of. Default is 10.
+ - `AWFUL_BENCHMARK_TOLERANCE`: How much slower than the baseline is too slow, as a fraction (e.g. `0.25` for 25%). Overrides the tolerance in `Baseline.json`.
+ - `AWFUL_BENCHMARK_RECORD`: If set, results are written to `Baseline.json` instead of compared with it.
+ - `AWFUL_BENCHMARK_OUTPUT`: A path to write this run's results to, as JSON.
+ - `CI`: If set (as it is on GitHub Actions), a benchmark with no baseline fails instead of passing with a note, so a regression gate can't quietly stop gating.
+
+ Timings from debug builds aren't worth much, so run these with `swift test -c release --filter AwfulCoreBenchmarks` (from the `AwfulCore` directory) on the same machine that recorded the baseline.
+ */
+struct Benchmark {
+    let name: String
+
+    /// Bytes of input per iteration, for throughput.
+    let bytes: Int
+
+    /// Posts, threads, or whatever else the work produces per iteration.
+    let items: Int
+
+    struct Result: Codable, Equatable {
+        var bytes: Int
+        var items: Int
+        var medianSeconds: Double
+        var megabytesPerSecond: Double
+        var nanosecondsPerItem: Double
+        /// How many more malloc blocks were in use after an iteration than before, i.e. what the result keeps alive. This isn't how many allocations the iteration made, as anything freed by the end doesn't count. `nil` where malloc statistics aren't available.
+        var liveMallocBlocksPerIteration: Int?
+    }
+
+    /**
+     - Parameter work: Does one iteration and returns its result, which is kept alive until malloc blocks are counted.
+     */
+    func run(file: StaticString = #filePath, line: UInt = #line, _ work: () throws -> Any) rethrows {
+        // Warm up caches (e.g. parsed selectors) so they don't count against the first iteration.
+        _ = try work()
+
+        var durations: [UInt64] = []
+        for _ in 0..<Self.iterations {
+            let start = DispatchTime.now().uptimeNanoseconds
+            _ = try work()
+            durations.append(DispatchTime.now().uptimeNanoseconds - start)
+        }
+        durations.sort()
+        let medianSeconds = Double(durations[durations.count / 2]) / 1e9
+
+        let blocksBefore = Self.mallocBlocksInUse()
+        let kept = try work()
+        let blocksAfter = Self.mallocBlocksInUse()
+        withExtendedLifetime(kept) {}
+
+        let result = Result(
+            bytes: bytes,
+            items: items,
+            medianSeconds: medianSeconds,
+            megabytesPerSecond: Double(bytes) / 1_000_000 / medianSeconds,
+            nanosecondsPerItem: medianSeconds * 1e9 / Double(max(items, 1)),
+            liveMallocBlocksPerIteration: blocksBefore.flatMap { before in blocksAfter.map { $0 - before } }
+        )
+        Self.report(name, result, file: file, line: line)
+    }
+
+    // MARK: Baseline
+
+    private struct Baseline: Codable {
+        var tolerance: Double
+        var results: [String: Result]
+    }
+
+    private static let iterations = ProcessInfo.processInfo.environment["AWFUL_BENCHMARK_ITERATIONS"].flatMap(Int.init) ?? 10
+
+    private static let baselineURL = URL(fileURLWithPath: #filePath)
+        .deletingLastPathComponent()
+        .appendingPathComponent("Baseline.json")
+
+    private static let lock = NSLock()
+    private static var baseline = loadBaseline()
+    private static var thisRun: [String: Result] = [:]
+
+    private static func loadBaseline() -> Baseline {
+        guard let data = try? Data(contentsOf: baselineURL),
+              let baseline = try? JSONDecoder().decode(Baseline.self, from: data)
+        else { return Baseline(tolerance: 0.25, results: [:]) }
+        return baseline
+    }
+
+    private static func report(_ name: String, _ result: Result, file: StaticString, line: UInt) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        thisRun[name] = result
+        print("benchmark \(name): \(milliseconds(result.medianSeconds)) ms, \(Int(result.megabytesPerSecond.rounded())) MB/s, \(Int(result.nanosecondsPerItem.rounded())) ns/item, \(result.liveMallocBlocksPerIteration.map(String.init) ?? "?") live malloc blocks")
+
+        let environment = ProcessInfo.processInfo.environment
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+
+        if let path = environment["AWFUL_BENCHMARK_OUTPUT"], let data = try? encoder.encode(thisRun) {
+            try? data.write(to: URL(fileURLWithPath: path))
+        }
+
+        if environment["AWFUL_BENCHMARK_RECORD"] != nil {
+            baseline.results[name] = result
+            if let data = try? encoder.encode(baseline) {
+                try? data.write(to: baselineURL)
+            }
+            return
+        }
+
+        guard let expected = baseline.results[name] else {
+            let message = "benchmark \(name): no baseline, set AWFUL_BENCHMARK_RECORD to record one"
+            if environment["CI"] != nil {
+                XCTFail(message, file: file, line: line)
+            } else {
+                print(message)
+            }
+            return
+        }
+        let tolerance = environment["AWFUL_BENCHMARK_TOLERANCE"].flatMap(Double.init) ?? baseline.tolerance
+        let limit = expected.medianSeconds * (1 + tolerance)
+        if result.medianSeconds > limit {
+            XCTFail("\(name) regressed: \(milliseconds(result.medianSeconds)) ms vs. baseline \(milliseconds(expected.medianSeconds)) ms (tolerance \(Int(tolerance * 100))%)", file: file, line: line)
+        }
+    }
+
+    private static func milliseconds(_ seconds: Double) -> String {
+        String(format: "%.3f", seconds * 1000)
+    }
+
+    private static func mallocBlocksInUse() -> Int? {
+        #if canImport(Darwin)
+        var stats = malloc_statistics_t()
+        malloc_zone_statistics(nil, &stats)
+        return Int(stats.blocks_in_use)
+        #else
+        return nil
+        #endif
+    }
+}
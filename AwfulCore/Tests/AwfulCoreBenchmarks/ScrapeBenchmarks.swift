@@ -0,0 +1,168 @@
+//  ScrapeBenchmarks.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+import AwfulCore
+import AwfulScraping
+import HTMLReader
+import XCTest
+
+/**
+ Parse and scrape throughput for every scraper over the fixtures in `AwfulCoreTests`. See `Benchmark` for running them and for updating `Baseline.json`.
+
+ Each scraper gets two benchmarks: "parse" turns the fixtures' bytes into `HTMLDocument`s, and "scrape" runs the scraper over already-parsed documents.
+ */
+final class ScrapeBenchmarks: XCTestCase {
+
+    func testAnnouncementList() throws {
+        try benchmark(AnnouncementListScrapeResult.self, fixtures: ["announcement", "announcement-two"])
+    }
+
+    func testBanned() throws {
+        try benchmark(BannedScrapeResult.self, fixtures: ["banned"])
+    }
+
+    func testDatabaseUnavailable() throws {
+        try benchmark(DatabaseUnavailableScrapeResult.self, fixtures: ["database-unavailable"])
+    }
+
+    func testIgnoreListChange() throws {
+        try benchmark(IgnoreListChangeScrapeResult.self, fixtures: ["ignore-staff", "ignore-success"])
+    }
+
+    func testLepersColony() throws {
+        try benchmark(LepersColonyScrapeResult.self, fixtures: ["banlist"])
+    }
+
+    func testPostIconList() throws {
+        try benchmark(PostIconListScrapeResult.self, fixtures: ["newthread", "newthread-at", "newthread-samart"])
+    }
+
+    func testPostsPage() throws {
+        let fixtures = ["showthread", "showthread2", "showthread3", "showthread-asktell", "showthread-fyad", "showthread-fyad2", "showthread-last", "showthread-oneuser"]
+        try benchmark(PostsPageScrapeResult.self, fixtures: fixtures, items: { $0.posts.count })
+    }
+
+    func testPostsPageStreaming() throws {
+        let fixtures = ["showthread", "showthread2", "showthread3", "showthread-asktell", "showthread-fyad", "showthread-fyad2", "showthread-last", "showthread-oneuser"]
+        let pages = try fixtures.map(fixtureData(named:))
+        let posts = try pages.reduce(0) { try $0 + PostsPageScrapeResult(data: $1, contentTypeHeader: contentType, url: url).posts.count }
+        try Benchmark(name: "PostsPageScrapeResult streaming", bytes: pages.reduce(0) { $0 + $1.count }, items: posts).run {
+            try pages.map { try PostsPageScrapeResult(data: $0, contentTypeHeader: contentType, url: url) }
+        }
+    }
+
+    func testPrivateMessageFolder() throws {
+        try benchmark(PrivateMessageFolderScrapeResult.self, fixtures: ["private-list"])
+    }
+
+    func testPrivateMessage() throws {
+        try benchmark(PrivateMessageScrapeResult.self, fixtures: ["private-one"])
+    }
+
+    func testProfile() throws {
+        try benchmark(ProfileScrapeResult.self, fixtures: ["profile", "profile2", "profile3", "profile4", "profile5", "profile6"])
+    }
+
+    func testShowPost() throws {
+        try benchmark(ShowPostScrapeResult.self, fixtures: ["showpost"])
+    }
+
+    func testStandardError() throws {
+        try benchmark(StandardErrorScrapeResult.self, fixtures: ["error-must-register", "error-requires-archives", "error-requires-plat", "newreply-closed"])
+    }
+
+    func testThreadList() throws {
+        let fixtures = ["bookmarkthreads", "forumdisplay", "forumdisplay-goldmine", "forumdisplay-sad", "forumdisplay2", "forumdisplay3", "forumdisplay4"]
+        try benchmark(ThreadListScrapeResult.self, fixtures: fixtures, items: { $0.threads.count })
+    }
+
+    func testIndexJSON() throws {
+        let data = try fixtureData(named: "index", extension: "json")
+        try Benchmark(name: "IndexScrapeResult", bytes: data.count, items: 1).run {
+            try JSONDecoder().decode(IndexScrapeResult.self, from: data)
+        }
+    }
+
+    // MARK: Scaled-up pages
+
+    /// A full page of 40 posts, made from a page that has fewer.
+    func testPostsPageScaledTo40Posts() throws {
+        let page = try scaledFixture(named: "showthread-last", repeating: "table.post", count: 40)
+        try benchmark(PostsPageScrapeResult.self, name: "PostsPageScrapeResult 40 posts", pages: [page], items: { $0.posts.count })
+    }
+
+    /// Far more threads than the Forums will send in one page, to make any per-thread costs obvious.
+    func testThreadListScaledTo400Threads() throws {
+        let page = try scaledFixture(named: "forumdisplay", repeating: "tr.thread", count: 400)
+        try benchmark(ThreadListScrapeResult.self, name: "ThreadListScrapeResult 400 threads", pages: [page], items: { $0.threads.count })
+    }
+
+    // MARK: Helpers
+
+    private let contentType = "text/html; charset=windows-1252"
+    private let url = URL(string: "https://forums.somethingawful.com/?perpage=40")
+
+    private func benchmark<T: ScrapeResult>(
+        _: T.Type,
+        fixtures: [String],
+        items: (T) -> Int = { _ in 1 },
+        file: StaticString = #filePath,
+        line: UInt = #line
+    ) throws {
+        try benchmark(T.self, name: "\(T.self)", pages: fixtures.map(fixtureData(named:)), items: items, file: file, line: line)
+    }
+
+    private func benchmark<T: ScrapeResult>(
+        _: T.Type,
+        name: String,
+        pages: [Data],
+        items: (T) -> Int = { _ in 1 },
+        file: StaticString = #filePath,
+        line: UInt = #line
+    ) throws {
+        let bytes = pages.reduce(0) { $0 + $1.count }
+        let documents = pages.map { HTMLDocument(data: $0, contentTypeHeader: contentType) }
+        let itemCount = try documents.reduce(0) { try $0 + items(T($1, url: url)) }
+
+        Benchmark(name: "\(name) parse", bytes: bytes, items: pages.count).run(file: file, line: line) {
+            pages.map { HTMLDocument(data: $0, contentTypeHeader: contentType) }
+        }
+        try Benchmark(name: "\(name) scrape", bytes: bytes, items: itemCount).run(file: file, line: line) {
+            try documents.map { try T($0, url: url) }
+        }
+    }
+
+    private func fixtureData(named name: String) throws -> Data {
+        try fixtureData(named: name, extension: "html")
+    }
+
+    private func fixtureData(named name: String, extension pathExtension: String) throws -> Data {
+        let fixtures = URL(fileURLWithPath: #filePath)
+            .deletingLastPathComponent()
+            .appendingPathComponent("../AwfulCoreTests/Fixtures", isDirectory: true)
+        return try Data(contentsOf: fixtures.appendingPathComponent(name).appendingPathExtension(pathExtension))
+    }
+
+    /// Copies the elements matching `selector` (and puts them next to the originals) until there are `count` of them, then serializes the page.
+    private func scaledFixture(named name: String, repeating selector: String, count: Int) throws -> Data {
+        let document = try HTMLDocument(data: fixtureData(named: name), contentTypeHeader: contentType)
+        let originals = document.nodes(matchingSelector: selector)
+        guard let last = originals.last, let parent = last.parent else {
+            throw CocoaError(.fileReadCorruptFile)
+        }
+
+        let siblings = parent.mutableChildren
+        var insertionIndex = siblings.index(of: last) + 1
+        for i in originals.count..<max(count, originals.count) {
+            let copy = originals[i % originals.count].copy() as! HTMLElement
+            siblings.insert(copy, at: insertionIndex)
+            insertionIndex += 1
+        }
+
+        guard let data = document.serializedFragment.data(using: .windowsCP1252, allowLossyConversion: true) else {
+            throw CocoaError(.fileWriteInapplicableStringEncoding)
+        }
+        return data
+    }
+}
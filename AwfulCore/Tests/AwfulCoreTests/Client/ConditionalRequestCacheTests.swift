@@ -0,0 +1,85 @@
+//  ConditionalRequestCacheTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import AwfulCore
+import XCTest
+
+final class ConditionalRequestCacheTests: XCTestCase {
+    override class func setUp() {
+        super.setUp()
+        testInit()
+    }
+
+    private let url = URL(string: "https://forums.somethingawful.com/bookmarkthreads.php?action=view")!
+
+    private func response(status: Int = 200, headers: [String: String] = [:]) -> HTTPURLResponse {
+        HTTPURLResponse(url: url, statusCode: status, httpVersion: "HTTP/1.1", headerFields: headers)!
+    }
+
+    func testNothingRecordedMeansChanged() {
+        let cache = ConditionalRequestCache()
+        let key = cache.key(for: URLRequest(url: url), session: "123")
+        XCTAssertNil(cache.unchangedEntry(forKey: key, response: response(status: 304), data: Data()))
+    }
+
+    func testSameBodyIsUnchanged() {
+        let cache = ConditionalRequestCache()
+        let key = cache.key(for: URLRequest(url: url), session: "123")
+        cache.record(forKey: key, response: response(), data: Data("hello".utf8), objectIDs: [])
+
+        XCTAssertNotNil(cache.unchangedEntry(forKey: key, response: response(), data: Data("hello".utf8)))
+        XCTAssertNil(cache.unchangedEntry(forKey: key, response: response(), data: Data("hello!".utf8)))
+    }
+
+    func testNotModifiedIsUnchanged() {
+        let cache = ConditionalRequestCache()
+        let key = cache.key(for: URLRequest(url: url), session: nil)
+        cache.record(forKey: key, response: response(headers: ["ETag": "\"abc\""]), data: Data("hello".utf8), objectIDs: [])
+
+        XCTAssertNotNil(cache.unchangedEntry(forKey: key, response: response(status: 304), data: Data()))
+    }
+
+    func testValidatorsAreSentBack() {
+        let cache = ConditionalRequestCache()
+        var request = URLRequest(url: url)
+        let key = cache.key(for: request, session: nil)
+
+        cache.addValidators(to: &request, forKey: key)
+        XCTAssertNil(request.value(forHTTPHeaderField: "If-None-Match"))
+
+        cache.record(forKey: key, response: response(headers: ["ETag": "\"abc\"", "Last-Modified": "Sat, 17 Oct 2026 12:00:00 GMT"]), data: Data(), objectIDs: [])
+        cache.addValidators(to: &request, forKey: key)
+        XCTAssertEqual(request.value(forHTTPHeaderField: "If-None-Match"), "\"abc\"")
+        XCTAssertEqual(request.value(forHTTPHeaderField: "If-Modified-Since"), "Sat, 17 Oct 2026 12:00:00 GMT")
+        XCTAssertEqual(request.cachePolicy, .reloadIgnoringLocalCacheData)
+    }
+
+    func testSessionsDoNotShareEntries() {
+        let cache = ConditionalRequestCache()
+        let request = URLRequest(url: url)
+        cache.record(forKey: cache.key(for: request, session: "123"), response: response(), data: Data("hello".utf8), objectIDs: [])
+
+        XCTAssertNil(cache.unchangedEntry(forKey: cache.key(for: request, session: "456"), response: response(), data: Data("hello".utf8)))
+    }
+
+    func testUpsertingAnotherThreadListInvalidatesTheGroup() {
+        let cache = ConditionalRequestCache()
+        let unfiltered = cache.key(for: URLRequest(url: URL(string: "https://forums.somethingawful.com/forumdisplay.php?forumid=1&pagenumber=1")!), session: nil)
+        let filtered = cache.key(for: URLRequest(url: URL(string: "https://forums.somethingawful.com/forumdisplay.php?forumid=1&pagenumber=1&posticon=2")!), session: nil)
+        let forums = cache.key(for: URLRequest(url: URL(string: "https://forums.somethingawful.com/index.php?json=1")!), session: nil)
+        let page = Data("page one".utf8)
+
+        cache.record(forKey: forums, response: response(), data: page, objectIDs: [])
+        cache.record(forKey: unfiltered, response: response(), data: page, objectIDs: [], group: .threadLists)
+
+        // The filtered page took threads off the unfiltered list, so the unfiltered page needs upserting again even though it's the same.
+        cache.record(forKey: filtered, response: response(), data: Data("filtered".utf8), objectIDs: [], group: .threadLists)
+        XCTAssertNil(cache.unchangedEntry(forKey: unfiltered, response: response(), data: page))
+        XCTAssertNotNil(cache.unchangedEntry(forKey: forums, response: response(), data: page))
+
+        cache.record(forKey: unfiltered, response: response(), data: page, objectIDs: [], group: .threadLists)
+        XCTAssertNotNil(cache.unchangedEntry(forKey: unfiltered, response: response(), data: page))
+        XCTAssertNil(cache.unchangedEntry(forKey: filtered, response: response(), data: Data("filtered".utf8)))
+    }
+}
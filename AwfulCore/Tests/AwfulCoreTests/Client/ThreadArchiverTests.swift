@@ -0,0 +1,145 @@
+//  ThreadArchiverTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+#if DEBUG
+
+@testable import AwfulCore
+import CoreData
+import XCTest
+
+/// Serves the `showthread3` fixture for every page via `FixtureURLProtocol`, so nothing touches the network.
+final class ThreadArchiverTests: XCTestCase {
+    override class func setUp() {
+        super.setUp()
+        testInit()
+    }
+
+    private var context: NSManagedObjectContext!
+    private var journalDirectory: URL!
+    private let threadID = "2803713"
+
+    override func setUp() {
+        super.setUp()
+        context = makeInMemoryStoreContext()
+        ForumsClient.shared.managedObjectContext = context
+        ForumsClient.shared.baseURL = URL(string: "https://forums.somethingawful.com/")
+        FixtureURLProtocol.fixtureBundle = Bundle.module
+        FixtureURLProtocol.enabledFixtures = [.thread]
+        journalDirectory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+    }
+
+    override func tearDown() {
+        FixtureURLProtocol.enabledFixtures = []
+        FixtureURLProtocol.latency = 0
+        ForumsClient.shared.baseURL = nil
+        ForumsClient.shared.managedObjectContext = nil
+        try? FileManager.default.removeItem(at: journalDirectory)
+        super.tearDown()
+    }
+
+    private func makeArchiver(concurrency: Int = 3, interval: TimeInterval = 0, journal: Bool = true) -> ThreadArchiver {
+        ThreadArchiver(configuration: .init(
+            maximumConcurrentPages: concurrency,
+            minimumRequestInterval: interval,
+            journalDirectory: journal ? journalDirectory : nil))
+    }
+
+    func testArchivesRequestedPages() async throws {
+        let postsPerPage = try scrapeHTMLFixture(PostsPageScrapeResult.self, named: "showthread3").posts.count
+        let archiver = makeArchiver()
+
+        let summary = try await archiver.archive(threadID: threadID, pages: 1...6)
+
+        XCTAssertEqual(summary, .init(fetchedPages: 6, skippedPages: 0, postCount: 6 * postsPerPage))
+        XCTAssertEqual(archiver.progress.completedUnitCount, 6)
+        XCTAssertEqual(archiver.progress.totalUnitCount, 6)
+        let savedPosts = await context.perform { Post.count(in: self.context) }
+        XCTAssertEqual(savedPosts, postsPerPage)
+    }
+
+    func testResumesWhereItLeftOff() async throws {
+        _ = try await makeArchiver().archive(threadID: threadID, pages: 1...3)
+
+        let archiver = makeArchiver()
+        let summary = try await archiver.archive(threadID: threadID, pages: 1...6)
+
+        XCTAssertEqual(summary.fetchedPages, 3)
+        XCTAssertEqual(summary.skippedPages, 3)
+        XCTAssertEqual(archiver.progress.completedUnitCount, 6)
+    }
+
+    func testRefetchesPagesWhosePostsWerePruned() async throws {
+        _ = try await makeArchiver().archive(threadID: threadID, pages: 1...3)
+        try await context.perform {
+            Post.fetch(in: self.context) { _ in }.forEach(self.context.delete)
+            try self.context.save()
+        }
+
+        let summary = try await makeArchiver().archive(threadID: threadID, pages: 1...3)
+        XCTAssertEqual(summary.fetchedPages, 3)
+        XCTAssertEqual(summary.skippedPages, 0)
+    }
+
+    func testEveryPageIncludesPagesAddedSinceLastTime() async throws {
+        let fixture = try scrapeHTMLFixture(PostsPageScrapeResult.self, named: "showthread3")
+        let pageCount = try XCTUnwrap(fixture.pageCount)
+        XCTAssertGreaterThan(pageCount, 2)
+
+        // Last time, the thread had two pages and we finished the first.
+        _ = try await makeArchiver(journal: false).archive(threadID: threadID, pages: 1...1)
+        let postIDs = try [XCTUnwrap(fixture.posts.first), XCTUnwrap(fixture.posts.last)].map { "\"\($0.id.rawValue)\"" }
+        try FileManager.default.createDirectory(at: journalDirectory, withIntermediateDirectories: true)
+        try Data(#"{"finishedPages":[{"page":1,"postIDs":[\#(postIDs.joined(separator: ","))]}],"pageCount":2}"#.utf8)
+            .write(to: journalDirectory.appendingPathComponent("\(threadID).json"))
+
+        let archiver = makeArchiver(concurrency: 8)
+        let summary = try await archiver.archive(threadID: threadID)
+
+        XCTAssertEqual(summary.skippedPages, 1)
+        XCTAssertEqual(summary.fetchedPages, pageCount - 1)
+        XCTAssertEqual(archiver.progress.totalUnitCount, Int64(pageCount))
+    }
+
+    func testResetJournalFetchesEverythingAgain() async throws {
+        let archiver = makeArchiver()
+        _ = try await archiver.archive(threadID: threadID, pages: 1...3)
+        await archiver.resetJournal(threadID: threadID)
+
+        let summary = try await archiver.archive(threadID: threadID, pages: 1...3)
+        XCTAssertEqual(summary.fetchedPages, 3)
+    }
+
+    func testSpacesOutRequests() async throws {
+        let start = Date()
+        _ = try await makeArchiver(concurrency: 5, interval: 0.05, journal: false).archive(threadID: threadID, pages: 1...5)
+        XCTAssertGreaterThanOrEqual(Date().timeIntervalSince(start), 0.2)
+    }
+
+    func testConcurrentPagesOverlapLatency() async throws {
+        FixtureURLProtocol.latency = 0.1
+
+        let start = Date()
+        _ = try await makeArchiver(concurrency: 8, journal: false).archive(threadID: threadID, pages: 1...8)
+        // One at a time would take at least 0.8s.
+        XCTAssertLessThan(Date().timeIntervalSince(start), 0.8)
+    }
+
+    func testPerformanceArchiving() {
+        let archiver = makeArchiver(concurrency: 4, journal: false)
+        measure {
+            let done = expectation(description: "archived")
+            Task {
+                defer { done.fulfill() }
+                do {
+                    _ = try await archiver.archive(threadID: threadID, pages: 1...20)
+                } catch {
+                    XCTFail("archiving failed: \(error)")
+                }
+            }
+            wait(for: [done], timeout: 60)
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,102 @@
+//  Windows1252Tests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import AwfulCore
+import XCTest
+
+final class Windows1252Tests: XCTestCase {
+    override class func setUp() {
+        super.setUp()
+        testInit()
+    }
+
+    func testWin1252ByteAgreesWithIsWin1252() {
+        for value in UInt32(0)...0x2200 {
+            guard let scalar = Unicode.Scalar(value) else { continue }
+            XCTAssertEqual(scalar.win1252Byte != nil, scalar.isWin1252, "U+\(String(value, radix: 16))")
+            // Foundation's mapping for the five bytes that win1252 leaves undefined is anyone's guess.
+            if let byte = scalar.win1252Byte, value >= 0xa0 {
+                XCTAssertEqual(String(scalar).data(using: .windowsCP1252), Data([byte]), "U+\(String(value, radix: 16))")
+            }
+        }
+    }
+
+    func testEscapedBytesMatchEscapingThenEncoding() {
+        let examples = [
+            "",
+            "plain ascii [quote]with bbcode[/quote]",
+            "café “smart quotes” – €5 — ™",
+            "emoji 🤡 and 👍🏽 and a flag 🇨🇦",
+            "日本語のテキスト",
+            "Ω ≈ ∞, ŝ, Œ, \u{0080}\u{009f}",
+            "&#9731; already looks like an entity",
+        ]
+        for example in examples {
+            XCTAssertEqual(escapedBytes(example), escapedThenEncoded(example), example)
+        }
+    }
+
+    func testRandomStringsMatchEscapingThenEncoding() {
+        var generator = SystemRandomNumberGenerator()
+        let pools: [ClosedRange<UInt32>] = [0x20...0x7e, 0xa0...0x17f, 0x2000...0x20ff, 0x3040...0x30ff, 0x1f300...0x1f64f]
+        for _ in 0..<500 {
+            let length = Int.random(in: 0..<200, using: &generator)
+            var scalars = String.UnicodeScalarView()
+            for _ in 0..<length {
+                let pool = pools.randomElement(using: &generator)!
+                if let scalar = Unicode.Scalar(UInt32.random(in: pool, using: &generator)) {
+                    scalars.append(scalar)
+                }
+            }
+            let string = String(scalars)
+            XCTAssertEqual(escapedBytes(string), escapedThenEncoded(string), string)
+        }
+    }
+
+    func testMultipartFormDataMatchesEscapingThenEncoding() throws {
+        let parameters: KeyValuePairs<String, Any> = [
+            "action": "postreply",
+            "threadid": 3507451,
+            "message": "I ♥ “quotes” and 🤡\r\n[quote]ok[/quote]",
+            "parseurl": "yes",
+        ]
+
+        var expected = URLRequest(url: URL(string: "https://example.com/newreply.php")!)
+        try expected.setMultipartFormData(parameters.lazy.map(win1252Escaped(_:)), encoding: .windowsCP1252, boundary: "boundary")
+        var actual = URLRequest(url: URL(string: "https://example.com/newreply.php")!)
+        actual.setWin1252MultipartFormData(parameters, boundary: "boundary")
+
+        XCTAssertEqual(actual.httpBody, expected.httpBody)
+        XCTAssertEqual(actual.value(forHTTPHeaderField: "Content-Type"), expected.value(forHTTPHeaderField: "Content-Type"))
+    }
+
+    func testPerformanceEscapingThenEncoding() {
+        let message = longMessage()
+        measure {
+            _ = escapedThenEncoded(message)
+        }
+    }
+
+    func testPerformanceEscapedBytes() {
+        let message = longMessage()
+        measure {
+            _ = escapedBytes(message)
+        }
+    }
+
+    private func escapedBytes(_ string: String) -> Data {
+        var data = Data()
+        data.appendWin1252Escaped(string)
+        return data
+    }
+
+    private func escapedThenEncoded(_ string: String) -> Data? {
+        win1252Escaped((key: "", value: string)).value.data(using: .windowsCP1252)
+    }
+
+    /// A quote-heavy reply of about 50 KB.
+    private func longMessage() -> String {
+        String(repeating: "[quote=\"someone\" post=\"123456\"]\nThis is what they said, with “curly quotes” and the odd 🤡.\n[/quote]\n\nAnd here's what I think about it, at some length.\n\n", count: 300)
+    }
+}
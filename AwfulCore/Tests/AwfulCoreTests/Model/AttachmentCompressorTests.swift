@@ -0,0 +1,78 @@
+//  AttachmentCompressorTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import AwfulCore
+import UIKit
+import XCTest
+
+final class AttachmentCompressorTests: XCTestCase {
+    override class func setUp() {
+        super.setUp()
+        testInit()
+    }
+
+    func testLargePhotoFitsInAFewEncodes() throws {
+        let image = makeNoisyImage(width: 6000, height: 4000, opaque: true)
+        let compressor = AttachmentCompressor(maxFileSize: ForumAttachment.maxFileSize, maxDimension: ForumAttachment.maxDimension)
+
+        let result = try XCTUnwrap(compressor.compress(image))
+        XCTAssertFalse(result.isPNG)
+        XCTAssertLessThanOrEqual(result.data.count, ForumAttachment.maxFileSize)
+        XCTAssertLessThanOrEqual(max(result.image.size.width, result.image.size.height), CGFloat(ForumAttachment.maxDimension))
+        XCTAssertLessThanOrEqual(result.fullEncodes, 4)
+    }
+
+    func testTransparentImageStaysPNG() throws {
+        let image = makeNoisyImage(width: 1500, height: 1000, opaque: false)
+        let compressor = AttachmentCompressor(maxFileSize: 500_000, maxDimension: ForumAttachment.maxDimension)
+
+        let result = try XCTUnwrap(compressor.compress(image))
+        XCTAssertTrue(result.isPNG)
+        XCTAssertTrue(result.image.hasAlpha)
+        XCTAssertLessThanOrEqual(result.data.count, 500_000)
+        XCTAssertLessThan(result.image.size.width, 1500)
+        XCTAssertLessThanOrEqual(result.fullEncodes, 4)
+    }
+
+    func testSmallImageIsEncodedOnce() throws {
+        let image = makeNoisyImage(width: 300, height: 200, opaque: true)
+        let compressor = AttachmentCompressor(maxFileSize: ForumAttachment.maxFileSize, maxDimension: ForumAttachment.maxDimension)
+
+        let result = try XCTUnwrap(compressor.compress(image))
+        XCTAssertEqual(result.image.size, CGSize(width: 300, height: 200))
+        XCTAssertEqual(result.fullEncodes, 1)
+    }
+
+    func testResizedAttachmentUploadsCompressedData() throws {
+        let attachment = ForumAttachment(image: makeNoisyImage(width: 5000, height: 3000, opaque: true))
+        XCTAssertNotNil(attachment.validationError)
+
+        let resized = try XCTUnwrap(attachment.resized())
+        XCTAssertNil(resized.validationError)
+        let (data, _, mimeType) = try resized.imageData()
+        XCTAssertEqual(mimeType, "image/jpeg")
+        XCTAssertLessThanOrEqual(data.count, ForumAttachment.maxFileSize)
+    }
+
+    private func makeNoisyImage(width: Int, height: Int, opaque: Bool) -> UIImage {
+        let context = CGContext(
+            data: nil,
+            width: width,
+            height: height,
+            bitsPerComponent: 8,
+            bytesPerRow: 0,
+            space: CGColorSpaceCreateDeviceRGB(),
+            bitmapInfo: (opaque ? CGImageAlphaInfo.noneSkipLast : .premultipliedLast).rawValue)!
+        // Noise doesn't compress well, which is the point. A quick xorshift keeps filling tens of megapixels cheap.
+        var state: UInt32 = 2463534242
+        let words = context.data!.assumingMemoryBound(to: UInt32.self)
+        for i in 0 ..< context.bytesPerRow * height / 4 {
+            state ^= state << 13
+            state ^= state >> 17
+            state ^= state << 5
+            words[i] = state
+        }
+        return UIImage(cgImage: context.makeImage()!)
+    }
+}
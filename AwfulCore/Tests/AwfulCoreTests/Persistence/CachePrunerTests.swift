@@ -0,0 +1,139 @@
+//  CachePrunerTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import AwfulCore
+import CoreData
+import XCTest
+
+final class CachePrunerTests: XCTestCase {
+
+    private var context: NSManagedObjectContext!
+    private var storeDirectoryURL: URL!
+
+    override class func setUp() {
+        super.setUp()
+        testInit()
+    }
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+
+        // Batch deletes need a SQLite store.
+        storeDirectoryURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+        try FileManager.default.createDirectory(at: storeDirectoryURL, withIntermediateDirectories: true)
+        let psc = NSPersistentStoreCoordinator(managedObjectModel: DataStore.model)
+        try psc.addPersistentStore(ofType: NSSQLiteStoreType, configurationName: nil, at: storeDirectoryURL.appendingPathComponent("AwfulCache.sqlite"))
+        context = NSManagedObjectContext(concurrencyType: .mainQueueConcurrencyType)
+        context.persistentStoreCoordinator = psc
+    }
+
+    override func tearDownWithError() throws {
+        context = nil
+        try FileManager.default.removeItem(at: storeDirectoryURL)
+
+        try super.tearDownWithError()
+    }
+
+    private let eightDaysAgo = Date(timeIntervalSinceNow: -8 * 24 * 60 * 60)
+
+    /// Inserts a thread with posts modified at the given dates, saves, then forgets about it all so nothing looks like it's in use.
+    private func insertThread(_ threadID: String, modified threadDate: Date, postDates: [Date]) throws {
+        let thread = AwfulThread.insert(into: context)
+        thread.threadID = threadID
+        thread.lastModifiedDate = threadDate as NSDate
+        for (i, date) in postDates.enumerated() {
+            let post = Post.insert(into: context)
+            post.postID = "\(threadID)-\(i)"
+            post.thread = thread
+            post.lastModifiedDate = date
+        }
+        try context.save()
+        context.reset()
+    }
+
+    private func prune(policy: CachePruner.Policy = .default, batchSize: Int = 500) -> CachePruner {
+        let pruner = CachePruner(managedObjectContext: context, policy: policy, batchSize: batchSize)
+        pruner.start()
+        return pruner
+    }
+
+    func testDeletesExpiredObjects() throws {
+        try insertThread("old", modified: eightDaysAgo, postDates: Array(repeating: eightDaysAgo, count: 7))
+        try insertThread("new", modified: Date(), postDates: [Date(), eightDaysAgo])
+
+        let pruner = prune(batchSize: 3)
+
+        XCTAssertEqual(AwfulThread.fetch(in: context) { _ in }.map { $0.threadID }, ["new"])
+        XCTAssertEqual(Post.fetch(in: context) { _ in }.map { $0.postID }, ["new-0"])
+        XCTAssertEqual(pruner.progress.completedUnitCount, pruner.progress.totalUnitCount)
+    }
+
+    func testKeepsObjectsInUse() throws {
+        try insertThread("old", modified: eightDaysAgo, postDates: [eightDaysAgo, eightDaysAgo])
+        let inUse = Post.fetch(in: context) { $0.predicate = .init("\(\Post.postID) == \("old-1")") }
+
+        _ = prune()
+
+        XCTAssertEqual(inUse.count, 1)
+        context.refreshAllObjects()
+        XCTAssertEqual(Post.fetch(in: context) { _ in }.map { $0.postID }, ["old-1"])
+    }
+
+    func testMaximumPostCountKeepsMostRecentlyModified() throws {
+        let postDates = (0..<10).map { Date(timeIntervalSinceNow: TimeInterval(-$0 * 60)) }
+        try insertThread("busy", modified: Date(), postDates: postDates)
+
+        _ = prune(policy: .init(maximumPostCount: 4), batchSize: 4)
+
+        let remaining = Post.fetch(in: context) { _ in }.map { $0.postID }
+        XCTAssertEqual(Set(remaining), ["busy-0", "busy-1", "busy-2", "busy-3"])
+    }
+
+    func testStoreSizeIncludesPostBodies() throws {
+        let storeURL = storeDirectoryURL.appendingPathComponent("AwfulCache.sqlite")
+        try insertThread("new", modified: Date(), postDates: [Date()])
+
+        let body = (0..<2000).map { "<p>post \($0)</p>" }.joined()
+        let post = try XCTUnwrap(Post.fetch(in: context) { _ in }.first)
+        post.innerHTML = body
+        try context.save()
+
+        let packURL = PostBodyStore.packURL(forStoreURL: storeURL)
+        let packSize = try XCTUnwrap(FileManager.default.attributesOfItem(atPath: packURL.path)[.size] as? Int)
+        let sqliteSize = ["", "-wal", "-shm"].reduce(0) { total, suffix in
+            total + ((try? FileManager.default.attributesOfItem(atPath: storeURL.path + suffix))?[.size] as? Int ?? 0)
+        }
+        XCTAssertGreaterThan(packSize, 0)
+        XCTAssertEqual(CachePruner.sizeOfStore(at: storeURL), sqliteSize + packSize)
+    }
+
+    func testOversizedStoreIsMarkedForVacuumWithoutASave() throws {
+        let storeURL = storeDirectoryURL.appendingPathComponent("AwfulCache.sqlite")
+        try insertThread("busy", modified: Date(), postDates: Array(repeating: Date(), count: 10))
+
+        let pruner = CachePruner(managedObjectContext: context, policy: .init(maximumStoreSize: 1))
+        pruner.storeURL = storeURL
+        pruner.start()
+
+        let metadata = try NSPersistentStoreCoordinator.metadataForPersistentStore(ofType: NSSQLiteStoreType, at: storeURL)
+        XCTAssertEqual(metadata[DataStore.MetadataKey.needsVacuum] as? Bool, true)
+    }
+
+    func testMergesDeletionsIntoContext() throws {
+        try insertThread("old", modified: eightDaysAgo, postDates: [eightDaysAgo])
+        let objectIDs = Post.fetch(in: context) { _ in }.map { $0.objectID }
+        context.reset()
+
+        var deleted: [NSManagedObjectID] = []
+        let observer = NotificationCenter.default.addObserver(forName: .cachePrunerDidDeleteObjects, object: nil, queue: nil) {
+            deleted += $0.userInfo?[NSDeletedObjectsKey] as? [NSManagedObjectID] ?? []
+        }
+        defer { NotificationCenter.default.removeObserver(observer) }
+
+        _ = prune()
+
+        XCTAssert(Set(objectIDs).isSubset(of: deleted))
+        XCTAssertEqual(Post.count(in: context), 0)
+    }
+}
@@ -0,0 +1,131 @@
+//  PostBodyStoreTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import AwfulCore
+import CoreData
+import XCTest
+
+final class PostBodyStoreTests: XCTestCase {
+    override class func setUp() {
+        super.setUp()
+        testInit()
+    }
+
+    private var directory: URL!
+
+    override func setUp() {
+        super.setUp()
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+        try! FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: directory)
+        super.tearDown()
+    }
+
+    private var packURL: URL { directory.appendingPathComponent("test.postbodies") }
+
+    func testRoundTrip() throws {
+        let store = PostBodyStore(fileURL: packURL)
+        let digest = try store.insert("<p>hello “there”</p>")
+        XCTAssertEqual(store.body(forDigest: digest), "<p>hello “there”</p>")
+        XCTAssertNil(store.body(forDigest: PostBodyStore.digest(of: "nope")))
+    }
+
+    func testIdenticalBodiesAreSavedOnce() throws {
+        let store = PostBodyStore(fileURL: packURL)
+        try store.insert("<p>hello</p>")
+        let size = try packSize()
+        try store.insert("<p>hello</p>")
+
+        XCTAssertEqual(store.count, 1)
+        XCTAssertEqual(try packSize(), size)
+    }
+
+    func testReopening() throws {
+        let digest = try PostBodyStore(fileURL: packURL).insert("<p>hello</p>")
+        XCTAssertEqual(PostBodyStore(fileURL: packURL).body(forDigest: digest), "<p>hello</p>")
+    }
+
+    func testIncompleteRecordIsDiscarded() throws {
+        let first = try PostBodyStore(fileURL: packURL).insert("<p>first</p>")
+        let size = try packSize()
+        let second = try PostBodyStore(fileURL: packURL).insert(String(repeating: "<p>second</p>", count: 100))
+
+        let handle = try FileHandle(forWritingTo: packURL)
+        try handle.truncate(atOffset: UInt64(size + 10))
+        try handle.close()
+
+        let store = PostBodyStore(fileURL: packURL)
+        XCTAssertEqual(store.body(forDigest: first), "<p>first</p>")
+        XCTAssertNil(store.body(forDigest: second))
+        XCTAssertEqual(try packSize(), size)
+
+        let third = try store.insert("<p>third</p>")
+        XCTAssertEqual(PostBodyStore(fileURL: packURL).body(forDigest: third), "<p>third</p>")
+    }
+
+    func testCompaction() throws {
+        let store = PostBodyStore(fileURL: packURL)
+        let keep = try store.insert("<p>keep</p>")
+        try store.insert(String(repeating: "<p>drop</p>", count: 1000))
+        let size = try packSize()
+
+        store.beginCompaction()
+        let late = try store.insert("<p>inserted while compacting</p>")
+        try store.compact(retaining: [keep])
+
+        XCTAssertEqual(store.count, 2)
+        XCTAssertLessThan(try packSize(), size)
+        XCTAssertEqual(store.body(forDigest: keep), "<p>keep</p>")
+        XCTAssertEqual(PostBodyStore(fileURL: packURL).body(forDigest: late), "<p>inserted while compacting</p>")
+    }
+
+    func testFailedWriteThrows() throws {
+        let store = PostBodyStore(fileURL: packURL)
+        try FileManager.default.createDirectory(at: packURL, withIntermediateDirectories: true)
+
+        XCTAssertThrowsError(try store.insert("<p>nowhere to go</p>"))
+        XCTAssertFalse(store.contains(PostBodyStore.digest(of: "<p>nowhere to go</p>")))
+    }
+
+    func testPostKeepsOnlyDigest() throws {
+        let context = makeInMemoryStoreContext()
+        let post = Post.insert(into: context)
+        post.postID = "123"
+        post.innerHTML = "<p>hello</p>"
+        try context.save()
+
+        XCTAssertEqual(post.bodyDigest, PostBodyStore.digest(of: "<p>hello</p>"))
+        XCTAssertNil(post.legacyInnerHTML)
+        XCTAssertEqual(post.innerHTML, "<p>hello</p>")
+    }
+
+    func testLegacyBodyIsReplaced() throws {
+        let context = makeInMemoryStoreContext()
+        let post = Post.insert(into: context)
+        post.postID = "123"
+        post.legacyInnerHTML = "<p>from before</p>"
+        XCTAssertEqual(post.innerHTML, "<p>from before</p>")
+
+        post.innerHTML = "<p>edited</p>"
+        XCTAssertNil(post.legacyInnerHTML)
+        XCTAssertEqual(post.innerHTML, "<p>edited</p>")
+    }
+
+    func testPerformanceInsertingPage() throws {
+        let bodies = try scrapeHTMLFixture(PostsPageScrapeResult.self, named: "showthread").posts.map(\.body)
+        measure {
+            let store = PostBodyStore(fileURL: nil)
+            for body in bodies {
+                try! store.insert(body)
+            }
+        }
+    }
+
+    private func packSize() throws -> Int {
+        try FileManager.default.attributesOfItem(atPath: packURL.path)[.size] as? Int ?? 0
+    }
+}
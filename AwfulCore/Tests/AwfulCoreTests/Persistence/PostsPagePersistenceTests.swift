@@ -0,0 +1,73 @@
+//  PostsPagePersistenceTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import AwfulCore
+import CoreData
+import XCTest
+
+final class PostsPagePersistenceTests: XCTestCase {
+
+    private var context: NSManagedObjectContext!
+
+    override class func setUp() {
+        super.setUp()
+        testInit()
+    }
+
+    override func setUp() {
+        super.setUp()
+
+        context = makeInMemoryStoreContext()
+    }
+
+    override func tearDown() {
+        context = nil
+
+        super.tearDown()
+    }
+
+    func testEarlyBatchesThenWholePage() throws {
+        let result = try scrapeHTMLFixture(PostsPageScrapeResult.self, named: "showthread")
+        let threadID = try XCTUnwrap(result.threadID?.rawValue)
+
+        let firstBatch = try Array(result.posts.prefix(10)).upsert(into: context, threadID: threadID, isSingleUserFilterEnabled: false)
+        let secondBatch = try Array(result.posts.dropFirst(10)).upsert(into: context, threadID: threadID, isSingleUserFilterEnabled: false)
+        XCTAssertEqual(firstBatch.map { $0.postID }, result.posts.prefix(10).map { $0.id.rawValue })
+        XCTAssertEqual(firstBatch.first?.threadIndex, 161)
+        XCTAssertEqual(secondBatch.last?.threadIndex, 200)
+        XCTAssertEqual(secondBatch.last?.thread?.threadID, threadID)
+
+        let posts = try result.upsert(into: context)
+        XCTAssertEqual(posts, firstBatch + secondBatch)
+        XCTAssertEqual(Post.count(in: context), 40)
+        XCTAssertEqual(AwfulThread.count(in: context), 1)
+    }
+
+    func testWholePageSkipsPostsAlreadySavedWithTheSameBody() throws {
+        let result = try scrapeHTMLFixture(PostsPageScrapeResult.self, named: "showthread")
+        let threadID = try XCTUnwrap(result.threadID?.rawValue)
+        let batch = try Array(result.posts.prefix(2)).upsert(into: context, threadID: threadID, isSingleUserFilterEnabled: false)
+        let savedDigests = [
+            result.posts[0].id: try XCTUnwrap(batch[0].bodyDigest),
+            result.posts[1].id: PostBodyStore.digest(of: "<p>an older edit</p>"),
+        ]
+        let editable = batch.map { $0.editable }
+        for post in batch {
+            post.editable.toggle()
+        }
+
+        let posts = try result.upsert(into: context, skippingBodyDigests: savedDigests)
+        XCTAssertNotEqual(posts[0].editable, editable[0], "already saved, so not updated again")
+        XCTAssertEqual(posts[1].editable, editable[1], "body changed since it was saved, so updated")
+    }
+
+    func testUnchangedRescrapeChangesNothing() throws {
+        let result = try scrapeHTMLFixture(PostsPageScrapeResult.self, named: "showthread")
+        _ = try result.upsert(into: context)
+        try context.save()
+
+        _ = try result.upsert(into: context)
+        XCTAssertFalse(context.hasChanges)
+    }
+}
@@ -46,4 +46,12 @@ final class ThreadListPersistenceTests: XCTestCase {
         let threads = fetchThreads()
         XCTAssertEqual(threads.count, 18)
     }
+
+    func testUnchangedRescrapeChangesNothing() throws {
+        try scrapeThreadList(named: "forumdisplay-sad")
+        try context.save()
+
+        try scrapeThreadList(named: "forumdisplay-sad")
+        XCTAssertFalse(context.hasChanges)
+    }
 }
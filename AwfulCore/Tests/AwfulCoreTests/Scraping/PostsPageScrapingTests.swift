@@ -116,4 +116,39 @@ final class PostsPageScrapingTests: XCTestCase {
         XCTAssertEqual(result.pageCount, 1)
         XCTAssertEqual(result.pageNumber, 1)
     }
+
+    private let showthreadFixtures = ["showthread", "showthread2", "showthread3", "showthread-asktell", "showthread-fyad", "showthread-fyad2", "showthread-last", "showthread-oneuser"]
+
+    func testConcurrentScrapeMatchesSerial() throws {
+        let url = URL(string: "https://example.com/?perpage=40")
+        for name in showthreadFixtures {
+            let document = try htmlFixture(named: name)
+            let serial = try PostsPageScrapeResult(document, url: url, scrapesPostsConcurrently: false)
+            let concurrent = try PostsPageScrapeResult(document, url: url, scrapesPostsConcurrently: true)
+            XCTAssertEqual(serial, concurrent, name)
+        }
+    }
+
+    func testPerformanceSerialScrape() throws {
+        try measureScraping(concurrently: false)
+    }
+
+    func testPerformanceConcurrentScrape() throws {
+        try measureScraping(concurrently: true)
+    }
+
+    private func measureScraping(concurrently: Bool) throws {
+        let documents = try showthreadFixtures.map { try htmlFixture(named: $0) }
+        let url = URL(string: "https://example.com/?perpage=40")
+        let expectedPostCount = documents.reduce(0) { $0 + ((try? PostsPageScrapeResult($1, url: url))?.posts.count ?? 0) }
+        XCTAssertGreaterThan(expectedPostCount, 0)
+        var postCount = 0
+        measure {
+            postCount = 0
+            for document in documents {
+                postCount += (try? PostsPageScrapeResult(document, url: url, scrapesPostsConcurrently: concurrently))?.posts.count ?? 0
+            }
+        }
+        XCTAssertEqual(postCount, expectedPostCount)
+    }
 }
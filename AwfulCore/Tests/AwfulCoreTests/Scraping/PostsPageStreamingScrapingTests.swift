@@ -0,0 +1,80 @@
+//  PostsPageStreamingScrapingTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import AwfulCore
+import XCTest
+
+final class PostsPageStreamingScrapingTests: XCTestCase {
+
+    override class func setUp() {
+        super.setUp()
+        testInit()
+    }
+
+    private let fixtureNames = [
+        "showthread",
+        "showthread-asktell",
+        "showthread-fyad",
+        "showthread-fyad2",
+        "showthread-last",
+        "showthread-oneuser",
+        "showthread2",
+        "showthread3",
+    ]
+
+    private let url = URL(string: "https://example.com/?perpage=40")
+
+    func testMatchesDocumentScrapeOnEveryFixture() throws {
+        for name in fixtureNames {
+            let parsed = try scrapeHTMLFixture(PostsPageScrapeResult.self, named: name)
+            let streamed = try PostsPageScrapeResult(data: fixtureData(named: name), contentTypeHeader: "text/html; charset=windows-1252", url: url)
+            XCTAssertEqual(streamed, parsed, name)
+        }
+    }
+
+    func testTinyChunks() throws {
+        for name in fixtureNames {
+            let parsed = try scrapeHTMLFixture(PostsPageScrapeResult.self, named: name)
+
+            var emitted: [PostScrapeResult] = []
+            let scraper = PostsPageStreamingScraper(contentTypeHeader: nil, url: url, didScrapePost: { emitted.append($0) })
+            let data = try fixtureData(named: name)
+            for start in stride(from: 0, to: data.count, by: 7) {
+                try scraper.consume(data[start..<min(start + 7, data.count)])
+            }
+            let streamed = try scraper.finish()
+
+            XCTAssertEqual(streamed, parsed, name)
+            XCTAssertEqual(emitted, parsed.posts, name)
+        }
+    }
+
+    func testPostsEmittedBeforeFinish() throws {
+        var emittedCount = 0
+        let scraper = PostsPageStreamingScraper(contentTypeHeader: nil, url: url, didScrapePost: { _ in emittedCount += 1 })
+        let data = try fixtureData(named: "showthread")
+        try scraper.consume(data.prefix(data.count / 2))
+        XCTAssertGreaterThan(emittedCount, 0)
+        XCTAssertLessThan(emittedCount, 40)
+    }
+
+    func testTablesInsideCommentsAndScripts() throws {
+        let html = """
+            <body>
+            <!-- <table class="post" id="post1"> -->
+            <script>document.write("<table class='post'>")</script>
+            <table class="post" id="post2"><tr><td class="userinfo userid-3"><dl><dt class="author">Someone</dt></dl>
+            <td class="postbody"><table><tr><td>nested</td></tr></table> a > b</td></tr></table>
+            </body>
+            """
+        let result = try PostsPageScrapeResult(data: Data(html.utf8), contentTypeHeader: "text/html; charset=utf-8", url: nil)
+        XCTAssertEqual(result.posts.map { $0.id.rawValue }, ["2"])
+        XCTAssert(result.posts[0].body.contains("nested"))
+    }
+
+    private func fixtureData(named basename: String) throws -> Data {
+        let url = Bundle.module.url(forResource: basename, withExtension: "html", subdirectory: "Fixtures")!
+        return try Data(contentsOf: url)
+    }
+}
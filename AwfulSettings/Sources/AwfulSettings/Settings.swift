@@ -41,6 +41,9 @@ public enum Settings {
     /// Render using dark mode. See also: `autoDarkTheme`.
     public static let darkMode = Setting(key: "dark_theme", default: false)
 
+    /// Shrink big images in posts to the width of the screen before showing them, to save memory.
+    public static let downsampleImages = Setting(key: "downsample_images", default: false)
+
     /// Which app to use for opening URLs.
     public static let defaultBrowser = Setting(key: "default_browser", default: DefaultBrowser.default)
 
@@ -142,6 +145,9 @@ public enum Settings {
 
     /// Use the new SwiftUI smilie picker with search functionality.
     public static let useNewSmiliePicker = Setting(key: "use_new_smilie_picker", default: true)
+
+    /// On long pages, empty out posts far from the screen to save memory. They fill back in as they scroll closer.
+    public static let virtualizePosts = Setting(key: "virtualize_posts", default: false)
 }
 
 /// A theme included with Awful.
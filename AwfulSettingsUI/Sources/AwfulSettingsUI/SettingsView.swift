@@ -17,6 +17,7 @@ public struct SettingsView: View {
     @AppStorage(Settings.darkMode) private var darkModeManuallyEnabled
     @AppStorage(Settings.defaultBrowser) private var defaultBrowser
     @AppStorage(Settings.jumpToPostEndOnDoubleTap) private var doubleTapPostToJump
+    @AppStorage(Settings.downsampleImages) private var downsampleImages
     @AppStorage(Settings.embedBlueskyPosts) private var embedBlueskyPosts
     @AppStorage(Settings.embedTweets) private var embedTweets
     @AppStorage(Settings.embedVideos) private var embedVideos
@@ -38,6 +39,7 @@ public struct SettingsView: View {
     @AppStorage(Settings.forumThreadsSortedUnread) private var sortFirstUnreadThreads
     @AppStorage(Settings.automaticTimg) private var timgLargeImages
     @AppStorage(Settings.useNewSmiliePicker) private var useNewSmiliePicker
+    @AppStorage(Settings.virtualizePosts) private var virtualizePosts
     @AppStorage("imgur_upload_mode") private var imgurUploadMode: String = "Off"
 
     @ObservedObject var appIconDataSource: AppIconDataSource
@@ -148,6 +150,8 @@ public struct SettingsView: View {
             Section {
                 Toggle("Show Avatars", bundle: .module, isOn: $showAvatars)
                 Toggle("Load Images", bundle: .module, isOn: $loadImages)
+                Toggle("Shrink Large Images", bundle: .module, isOn: $downsampleImages)
+                    .disabled(!loadImages)
                 Stepper("Scale Text \(fontScale.formatted())%", bundle: .module, value: $fontScale, in: 50...200, step: 10)
                 Toggle("Always Preview New Posts", bundle: .module, isOn: $alwaysPreviewNewPosts)
                 Toggle("Always Animate GIFs", bundle: .module, isOn: $alwaysAnimateGIFs)
@@ -161,6 +165,7 @@ public struct SettingsView: View {
                     Toggle("Enable Custom Title Post Layout", bundle: .module, isOn: $customTitlePostLayout)
                 }
                 Toggle("Hide Post Metadata from Screen Reader", bundle: .module, isOn: $hidePostMetadataForReader)
+                Toggle("Unload Offscreen Posts", bundle: .module, isOn: $virtualizePosts)
             } header: {
                 Text("Posts", bundle: .module)
                     .header()
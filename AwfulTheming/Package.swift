@@ -35,5 +35,6 @@ let package = Package(
                 .plugin(name: "LessStylesheet", package: "LessStylesheet"),
             ]
         ),
+        .testTarget(name: "AwfulThemingTests", dependencies: ["AwfulTheming"]),
     ]
 )
@@ -27,6 +27,9 @@ public class Theme {
     public let name: String
     fileprivate let dictionary: [String: Any]
     fileprivate var parent: Theme?
+
+    private let compiledLock = NSLock()
+    private var _compiled: Compiled?
     
     fileprivate init(name: String, dictionary: [String: Any]) {
         self.name = name
@@ -61,6 +64,50 @@ private func flatten<K, V>(_ dictionary: [K: V]) -> [K: V] {
     }
 }
 
+// MARK: Compiled
+
+extension Theme {
+
+    /// A theme's attributes merged with those of all its ancestors, with colors already parsed, so that lookups need not walk the parent chain nor parse anything.
+    fileprivate struct Compiled {
+        let attributes: [String: Any]
+        let colors: [String: UIColor]
+
+        init(_ theme: Theme) {
+            var attributes = theme.parent?.compiled.attributes ?? [:]
+            attributes.merge(theme.dictionary, uniquingKeysWith: { $1 })
+            self.attributes = attributes
+
+            // Unrecognized colors are left out, so they still blow up when looked up (and only then).
+            var colors: [String: UIColor] = [:]
+            for case let (key, value as String) in attributes where key.hasSuffix("Color") {
+                if let hexColor = UIColor(hex: value) {
+                    colors[key] = hexColor
+                } else if let patternImage = UIImage(named: value) {
+                    colors[key] = UIColor(patternImage: patternImage)
+                }
+            }
+            self.colors = colors
+        }
+    }
+
+    /// Built on first use. Bundled themes never change, so neither does this; a different theme has its own.
+    fileprivate var compiled: Compiled {
+        compiledLock.lock()
+        defer { compiledLock.unlock() }
+        if let compiled = _compiled {
+            return compiled
+        }
+        let compiled = Compiled(self)
+        _compiled = compiled
+        return compiled
+    }
+}
+
+/// Stylesheets by name, read from disk at most once.
+private var loadedStylesheets: [String: String] = [:]
+private let loadedStylesheetsLock = NSLock()
+
 // MARK: Dictionary accessors
 
 extension Theme {
@@ -87,9 +134,7 @@ extension Theme {
     
     /// The desired appearance for the keyboard. If unspecified by the theme and its ancestors, returns .Default.
     public var keyboardAppearance: UIKeyboardAppearance {
-        let appearance = dictionary["keyboardAppearance"] as? String
-            ?? parent?["keyboardAppearance"]
-            ?? "default"
+        let appearance = compiled.attributes["keyboardAppearance"] as? String ?? "default"
 
         switch appearance {
         case "Dark", "dark":
@@ -105,7 +150,7 @@ extension Theme {
     
     /// The desired scroll indicator style for scrollbars. Must be specified by the theme or one of its ancestors.
     public var scrollIndicatorStyle: UIScrollView.IndicatorStyle {
-        guard let style = dictionary["scrollIndicatorStyle"] as? String ?? parent?["scrollIndicatorStyle"] else { return .default }
+        guard let style = compiled.attributes["scrollIndicatorStyle"] as? String else { return .default }
 
         switch style {
         case "Dark", "dark":
@@ -118,19 +163,17 @@ extension Theme {
     }
 
     public subscript(bool key: String) -> Bool? {
-        return dictionary[key] as? Bool ?? parent?[bool: key]
+        return compiled.attributes[key] as? Bool
     }
 
     /// The named color (the "Color" suffix is optional).
     public subscript(uicolor colorName: String) -> UIColor? {
         let key = colorName.hasSuffix("Color") ? colorName : "\(colorName)Color"
-        guard let value = dictionary[key] as? String else { return parent?[key] }
+        let compiled = self.compiled
+        guard let value = compiled.attributes[key] as? String else { return nil }
 
-        if let hexColor = UIColor(hex: value) {
-            return hexColor
-        }
-        else if let patternImage = UIImage(named: value) {
-            return UIColor(patternImage: patternImage)
+        if let color = compiled.colors[key] {
+            return color
         }
         else {
             fatalError("Unrecognized theme attribute color: \(value) (in theme \(name), for key \(colorName)")
@@ -152,12 +195,12 @@ extension Theme {
     }
 
     public subscript(double key: String) -> Double? {
-        return dictionary[key] as? Double ?? parent?[double: key]
+        return compiled.attributes[key] as? Double
     }
 
     /// The named theme attribute as a string.
     public subscript(string key: String) -> String? {
-        guard let value = dictionary[key] as? String ?? parent?[key] else { return nil }
+        guard let value = compiled.attributes[key] as? String else { return nil }
         if key.hasSuffix("CSS") {
             let css: String?
             do {
@@ -175,12 +218,19 @@ extension Theme {
         }
     }
 
-    /// Returns the contents of `name.css`.
+    /// Returns the contents of `name.css`, which is only read the first time it's asked for.
     public func stylesheet(named name: String) throws -> String? {
+        loadedStylesheetsLock.lock()
+        defer { loadedStylesheetsLock.unlock() }
+        if let css = loadedStylesheets[name] {
+            return css
+        }
         guard let url = Bundle.module.url(forResource: name, withExtension: ".css") else {
             return nil
         }
-        return try String(contentsOf: url, encoding: .utf8)
+        let css = try String(contentsOf: url, encoding: .utf8)
+        loadedStylesheets[name] = css
+        return css
     }
 
     /**
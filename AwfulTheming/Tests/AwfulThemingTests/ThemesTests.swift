@@ -0,0 +1,56 @@
+//  ThemesTests.swift
+//
+//  Copyright 2026 Awful Contributors. CC BY-NC-SA 3.0 US https://github.com/Awful/Awful.app
+
+@testable import AwfulTheming
+import XCTest
+
+final class ThemesTests: XCTestCase {
+    func testInheritsFromParent() throws {
+        let defaultTheme = try XCTUnwrap(Theme.theme(named: "default"))
+        let gasChamber = try XCTUnwrap(Theme.theme(named: "Gas Chamber"))
+
+        XCTAssertEqual(gasChamber[uicolor: "background"], defaultTheme[uicolor: "background"])
+        XCTAssertEqual(gasChamber.keyboardAppearance, defaultTheme.keyboardAppearance)
+        XCTAssertNotEqual(gasChamber[uicolor: "listBackground"], defaultTheme[uicolor: "listBackground"])
+    }
+
+    func testInheritsFromGrandparent() throws {
+        let dark = try XCTUnwrap(Theme.theme(named: "dark"))
+        let amber = try XCTUnwrap(Theme.theme(named: "YOSPOS (amber)"))
+        XCTAssertEqual(amber.scrollIndicatorStyle, dark.scrollIndicatorStyle)
+    }
+
+    func testColorSuffixIsOptional() throws {
+        let theme = try XCTUnwrap(Theme.theme(named: "default"))
+        XCTAssertNotNil(theme[uicolor: "background"])
+        XCTAssertEqual(theme[uicolor: "background"], theme[uicolor: "backgroundColor"])
+        XCTAssertNil(theme[uicolor: "doesNotExist"])
+    }
+
+    func testEveryThemeHasPostsViewCSS() {
+        for theme in Theme.allThemes {
+            let css = theme[string: "postsViewCSS"]
+            XCTAssertFalse(css?.isEmpty ?? true, theme.name)
+            XCTAssertEqual(theme[string: "postsViewCSS"], css, theme.name)
+        }
+    }
+
+    /// Each iteration does 100,000 lookups, so lookups per second is 100,000 divided by the average time.
+    func testLookupPerformance() throws {
+        let theme = try XCTUnwrap(Theme.theme(named: "YOSPOS (amber)"))
+        let colorKeys = ["background", "listBackground", "listText", "postsLoadingViewTint", "tint"]
+        measure {
+            for _ in 0..<10_000 {
+                for key in colorKeys {
+                    _ = theme[uicolor: key]
+                }
+                _ = theme[string: "postsViewCSS"]
+                _ = theme[bool: "showRootTabBarLabel"]
+                _ = theme[double: "postTitleFontSizeAdjustmentPhone"]
+                _ = theme.keyboardAppearance
+                _ = theme.scrollIndicatorStyle
+            }
+        }
+    }
+}
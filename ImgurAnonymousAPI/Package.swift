@@ -16,5 +16,8 @@ let package = Package(
         .target(
             name: "ImgurAnonymousAPI",
             dependencies: []),
+        .testTarget(
+            name: "ImgurAnonymousAPITests",
+            dependencies: ["ImgurAnonymousAPI"]),
     ]
 )
@@ -37,6 +37,7 @@ public final class ImgurUploader {
         self.authProvider = authProvider
         queue = OperationQueue()
         queue.name = "com.nolanw.ImgurAnonymousAPI"
+        uploadBodies = StreamedUploadBodies()
 
         urlSession = URLSession(configuration: {
             let config = URLSessionConfiguration.ephemeral
@@ -54,7 +55,7 @@ public final class ImgurUploader {
             }
             config.httpAdditionalHeaders = additionalHeaders
             return config
-        }())
+        }(), delegate: uploadBodies, delegateQueue: nil)
     }
 
     /**
@@ -88,6 +89,27 @@ public final class ImgurUploader {
      */
     public static var logger: ((_ level: LogLevel, _ message: () -> String) -> Void)?
 
+    /**
+     A group of uploads with its own limit on how many images are sent to Imgur at once, apart from any other uploads. Images beyond the limit are still saved and resized, so they're ready to go as soon as an earlier upload in the batch finishes.
+
+     Pass the same batch to each `upload` that should share the limit.
+     */
+    public final class UploadBatch {
+        fileprivate let queue: OperationQueue
+
+        public init(maximumConcurrentUploads: Int = OperationQueue.defaultMaxConcurrentOperationCount) {
+            queue = OperationQueue()
+            queue.name = "com.nolanw.ImgurAnonymousAPI.batch"
+            queue.maxConcurrentOperationCount = maximumConcurrentUploads
+        }
+
+        /// Changes affect uploads in the batch that haven't started sending yet.
+        public var maximumConcurrentUploads: Int {
+            get { return queue.maxConcurrentOperationCount }
+            set { queue.maxConcurrentOperationCount = newValue }
+        }
+    }
+
     public enum LogLevel: Comparable {
         
         /// Messages not particularly interesting unless you suspect an `ImgurAnonymousAPI` instance is misbehaving.
@@ -125,6 +147,7 @@ public final class ImgurUploader {
     
     private let queue: OperationQueue
     private let urlSession: URLSession
+    private let uploadBodies: StreamedUploadBodies
     private let authProvider: ImgurAuthProvider
 
     // MARK: - Photos.framework support
@@ -139,15 +162,17 @@ public final class ImgurUploader {
      This upload uses Imgur API rate limit credits. Authenticated uploads have higher rate limits than anonymous ones.
      
      - Parameter asset: A Photos asset with at least one photo representation.
+     - Parameter batch: If not `nil`, the image is only sent once the batch allows it.
+     - Parameter willSend: A closure to call, on an arbitrary queue, once the image is saved and resized and is about to be sent to Imgur.
      - Parameter completion: A closure to call when the upload completes. The closure is always called on the main queue.
-     - Returns: A cancellable `Progress` instance.
+     - Returns: A cancellable `Progress` instance that follows the image data as it's sent to Imgur.
      
      - Warning: Calling this method will show your user a photo library authorization alert (or crash if your app is missing an `Info.plist` value for the key `NSPhotoLibraryUsageDescription`).
      */
     @available(macOS 10.13, tvOS 10.0, *)
     @discardableResult
-    public func upload(_ asset: PHAsset, completion: @escaping (_ result: Result<UploadResponse>) -> Void) -> Progress {
-        return upload(imageSaveOperation: SavePHAsset(asset), completion: completion)
+    public func upload(_ asset: PHAsset, batch: UploadBatch? = nil, willSend: (() -> Void)? = nil, completion: @escaping (_ result: Result<UploadResponse>) -> Void) -> Progress {
+        return upload(imageSaveOperation: SavePHAsset(asset), batch: batch, willSend: willSend, completion: completion)
     }
     
     #endif
@@ -166,12 +191,14 @@ public final class ImgurUploader {
      This upload uses Imgur API rate limit credits. Authenticated uploads have higher rate limits than anonymous ones.
      
      - Parameter image: An image instance (animated or not).
+     - Parameter batch: If not `nil`, the image is only sent once the batch allows it.
+     - Parameter willSend: A closure to call, on an arbitrary queue, once the image is saved and resized and is about to be sent to Imgur.
      - Parameter completion: A closure to call when the upload completes. The closure is always called on the main queue.
-     - Returns: A cancellable `Progress` instance.
+     - Returns: A cancellable `Progress` instance that follows the image data as it's sent to Imgur.
      */
     @discardableResult
-    public func upload(_ image: UIImage, completion: @escaping (_ result: Result<UploadResponse>) -> Void) -> Progress {
-        return upload(imageSaveOperation: SaveUIImage(image), completion: completion)
+    public func upload(_ image: UIImage, batch: UploadBatch? = nil, willSend: (() -> Void)? = nil, completion: @escaping (_ result: Result<UploadResponse>) -> Void) -> Progress {
+        return upload(imageSaveOperation: SaveUIImage(image), batch: batch, willSend: willSend, completion: completion)
     }
     
     #endif
@@ -193,7 +220,7 @@ public final class ImgurUploader {
      
      - Parameter info: An info dictionary as passed to `UIImagePickerControllerDelegate.imagePickerController(_:didFinishPickingMediaWithInfo:)`.
      - Parameter completion: A closure to call when the upload completes. The closure is always called on the main queue.
-     - Returns: A cancellable `Progress` instance.
+     - Returns: A cancellable `Progress` instance that follows the image data as it's sent to Imgur.
      */
     @discardableResult
     public func upload(_ info: [UIImagePickerController.InfoKey: Any], completion: @escaping (_ result: Result<UploadResponse>) -> Void) -> Progress {
@@ -232,7 +259,7 @@ public final class ImgurUploader {
 
     // MARK: - Generic uploading and support
 
-    private func upload(imageSaveOperation: Operation, completion: @escaping (_ result: Result<UploadResponse>) -> Void) -> Progress {
+    private func upload(imageSaveOperation: Operation, batch: UploadBatch?, willSend: (() -> Void)?, completion: @escaping (_ result: Result<UploadResponse>) -> Void) -> Progress {
         let tempFolder = MakeTemporaryFolder()
 
         imageSaveOperation.addDependency(tempFolder)
@@ -241,27 +268,32 @@ public final class ImgurUploader {
         resize.addDependency(imageSaveOperation)
         resize.addDependency(tempFolder)
 
-        let writeFormData = WriteMultipartFormData()
-        writeFormData.addDependency(resize)
-        writeFormData.addDependency(tempFolder)
+        let prepareFormData = PrepareMultipartFormData()
+        prepareFormData.addDependency(resize)
+
+        let progress = Progress(totalUnitCount: 10)
 
-        let upload = UploadImageAsFormData(urlSession: urlSession, request: {
+        let upload = UploadImageAsFormData(urlSession: urlSession, bodies: uploadBodies, progress: progress, pendingUnitCount: 9, willSend: willSend, request: {
             var request = URLRequest(url: URL(string: "https://api.imgur.com/3/image")!)
             request.httpMethod = "POST"
             return request
         }())
-        upload.addDependency(writeFormData)
+        upload.addDependency(prepareFormData)
 
         let deleteTempFolder = DeleteTemporaryFolder()
         deleteTempFolder.addDependency(tempFolder)
         deleteTempFolder.addDependency(upload)
 
-        let ops = [tempFolder, imageSaveOperation, resize, writeFormData, upload, deleteTempFolder]
+        let ops = [tempFolder, imageSaveOperation, resize, prepareFormData, upload, deleteTempFolder]
 
         log(.debug, "starting upload of \(imageSaveOperation)")
-        queue.addOperations(ops, waitUntilFinished: false)
+        if let batch = batch {
+            queue.addOperations(ops.filter { $0 !== upload }, waitUntilFinished: false)
+            batch.queue.addOperation(upload)
+        } else {
+            queue.addOperations(ops, waitUntilFinished: false)
+        }
 
-        let progress = Progress(totalUnitCount: 1)
         progress.cancellationHandler = {
             log(.debug, "cancelling upload of \(imageSaveOperation)")
             for op in ops where !(op is DeleteTemporaryFolder) {
@@ -272,7 +304,7 @@ public final class ImgurUploader {
         let completionOp = BlockOperation {
             let result = upload.result!
             log(.debug, "finishing upload of \(imageSaveOperation) with \(result)")
-            progress.completedUnitCount = 1
+            progress.completedUnitCount = progress.totalUnitCount
             completion(result)
         }
         completionOp.addDependency(ops.last!)
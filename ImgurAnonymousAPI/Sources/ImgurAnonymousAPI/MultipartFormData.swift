@@ -0,0 +1,170 @@
+// Public domain. https://github.com/nolanw/ImgurAnonymousAPI
+
+import Foundation
+import ImageIO
+
+#if canImport(CoreServices)
+    import CoreServices
+#else
+    import MobileCoreServices
+#endif
+
+/**
+ A `multipart/form-data` request body made of some in-memory bytes, an image file, and some more in-memory bytes.
+
+ Rather than writing the whole body out to another file before uploading, the body is streamed: `makeInputStream()` feeds the pieces, in order, into a bound pair of streams as the upload task reads them. The image file is read in chunks, so memory use stays low no matter how big the image is.
+ */
+internal struct MultipartFormDataBody {
+    let boundary: String
+    let head: Data
+    let fileURL: URL
+    let tail: Data
+
+    /// The size of the whole body, in bytes.
+    let contentLength: Int
+
+    /// How many bytes to read from the image file (and buffer between the bound streams) at a time.
+    static let chunkSize = 64 * 1024
+
+    /// Returns a fresh stream of the whole body, starting from the top. `StreamedUploadBodies` calls this again whenever the body needs to be sent again.
+    func makeInputStream() -> InputStream {
+        var input: InputStream?
+        var output: OutputStream?
+        Stream.getBoundStreams(withBufferSize: Self.chunkSize, inputStream: &input, outputStream: &output)
+
+        let pump = Thread { [head, fileURL, tail, output = output!] in
+            pumpPieces(head: head, fileURL: fileURL, tail: tail, into: output)
+        }
+        pump.name = "com.nolanw.ImgurAnonymousAPI multipart body"
+        pump.qualityOfService = .userInitiated
+        pump.start()
+
+        return input!
+    }
+}
+
+internal enum MultipartFormDataError: CustomNSError {
+    case missingImageFileSize(underlyingError: Error?)
+
+    var errorUserInfo: [String: Any] {
+        switch self {
+        case .missingImageFileSize(underlyingError: let underlyingError):
+            var userInfo: [String: Any] = [
+                NSLocalizedDescriptionKey: "Upload request",
+                NSLocalizedFailureReasonErrorKey: "Could not read image file"]
+            userInfo[NSUnderlyingErrorKey] = underlyingError
+            return userInfo
+        }
+    }
+}
+
+/// Figures out the `multipart/form-data` body for uploading the image file.
+internal final class PrepareMultipartFormData: AsynchronousOperation<MultipartFormDataBody>, @unchecked Sendable {
+    override func execute() throws {
+        let imageFile = try firstDependencyValue(ofType: ImageFile.self)
+
+        let uti = CGImageSourceCreateWithURL(imageFile.url as CFURL, nil)
+            .flatMap { CGImageSourceGetType($0) }
+        let mimeType = uti
+            .flatMap { UTTypeCopyPreferredTagWithClass($0, kUTTagClassMIMEType)?.takeRetainedValue() as String? }
+            ?? "application/octet-stream"
+
+        let fileSize: Int
+        do {
+            guard let size = try imageFile.url.resourceValues(forKeys: [.fileSizeKey]).fileSize else {
+                throw MultipartFormDataError.missingImageFileSize(underlyingError: nil)
+            }
+            fileSize = size
+        } catch let error as MultipartFormDataError {
+            throw error
+        } catch {
+            throw MultipartFormDataError.missingImageFileSize(underlyingError: error)
+        }
+
+        let boundary = makeBoundary()
+        let head = makeTopData(boundary: boundary, mimeType: mimeType)
+        let tail = makeBottomData(boundary: boundary)
+
+        finish(.success(MultipartFormDataBody(
+            boundary: boundary,
+            head: head,
+            fileURL: imageFile.url,
+            tail: tail,
+            contentLength: head.count + fileSize + tail.count)))
+    }
+}
+
+private func makeBoundary() -> String {
+    let randos = (0..<16).compactMap { _ in return boundaryDigits.randomElement() }
+    return String(randos)
+}
+
+private let boundaryDigits = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789"
+
+private func makeTopData(boundary: String, mimeType: String) -> Data {
+    return [
+        "--\(boundary)",
+        "Content-Disposition: form-data; name=\"image\"; filename=\"image\"",
+        "Content-Type: \(mimeType)",
+        "\r\n",
+        ]
+        .joined(separator: "\r\n")
+        .data(using: .utf8)!
+}
+
+private func makeBottomData(boundary: String) -> Data {
+    return "\r\n--\(boundary)--".data(using: .utf8)!
+}
+
+/**
+ Writes the pieces of a body to `output`, blocking whenever the bound input stream hasn't caught up. Runs on its own thread.
+
+ Gives up quietly if the reader goes away (e.g. the upload was cancelled) or the file can't be read. The upload then fails, as its body comes up short of its `Content-Length`.
+ */
+private func pumpPieces(head: Data, fileURL: URL, tail: Data, into output: OutputStream) {
+    output.open()
+    defer { output.close() }
+
+    guard write(head, to: output) else { return }
+
+    guard let file = InputStream(url: fileURL) else {
+        log(.error, "could not open \(fileURL) for streaming")
+        return
+    }
+    file.open()
+    defer { file.close() }
+
+    var buffer = [UInt8](repeating: 0, count: MultipartFormDataBody.chunkSize)
+    while true {
+        let count = file.read(&buffer, maxLength: buffer.count)
+        if count < 0 {
+            log(.error, "could not read \(fileURL): \(file.streamError as Any)")
+            return
+        }
+        if count == 0 {
+            break
+        }
+        let written = buffer.withUnsafeBytes { write(UnsafeRawBufferPointer(rebasing: $0[..<count]), to: output) }
+        guard written else { return }
+    }
+
+    _ = write(tail, to: output)
+}
+
+private func write(_ data: Data, to output: OutputStream) -> Bool {
+    return data.withUnsafeBytes { write($0, to: output) }
+}
+
+private func write(_ bytes: UnsafeRawBufferPointer, to output: OutputStream) -> Bool {
+    guard let base = bytes.bindMemory(to: UInt8.self).baseAddress else { return true }
+    var offset = 0
+    while offset < bytes.count {
+        let written = output.write(base + offset, maxLength: bytes.count - offset)
+        if written <= 0 {
+            // The reader closed, or something went wrong.
+            return false
+        }
+        offset += written
+    }
+    return true
+}
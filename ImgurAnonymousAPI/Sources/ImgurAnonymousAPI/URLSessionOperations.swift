@@ -113,28 +113,45 @@ internal final class FetchURL<T: Decodable>: AsynchronousOperation<T>, @unchecke
 /// Sends a multipart/form-data upload request, then parses the response's body and headers.
 internal final class UploadImageAsFormData: AsynchronousOperation<ImgurUploader.UploadResponse>, @unchecked Sendable {
     private let request: URLRequest
-    private var task: URLSessionUploadTask?
+    private var task: URLSessionDataTask?
     private let urlSession: URLSession
+    private let bodies: StreamedUploadBodies
+    private let progress: Progress?
+    private let pendingUnitCount: Int64
+    private let willSend: (() -> Void)?
 
     private struct ResponseData: Decodable {
         let id: String
         let link: URL
     }
 
-    init(urlSession: URLSession, request: URLRequest) {
+    /**
+     - Parameter bodies: Must be `urlSession`'s delegate, so the body can be sent again if need be.
+     - Parameter progress: If not `nil`, the upload task's progress becomes its child once the upload starts.
+     - Parameter willSend: Called just before the upload task starts.
+     */
+    init(urlSession: URLSession, bodies: StreamedUploadBodies, progress: Progress? = nil, pendingUnitCount: Int64 = 0, willSend: (() -> Void)? = nil, request: URLRequest) {
         self.request = request
         self.urlSession = urlSession
+        self.bodies = bodies
+        self.progress = progress
+        self.pendingUnitCount = pendingUnitCount
+        self.willSend = willSend
     }
 
     override func execute() throws {
-        let formDataFile = try firstDependencyValue(ofType: FormDataFile.self)
+        let body = try firstDependencyValue(ofType: MultipartFormDataBody.self)
 
+        // The body is streamed, so URLSession can't work out its length; tell it, rather than falling back to a chunked upload.
         var request = self.request
-        request.setValue("multipart/form-data; boundary=\(formDataFile.boundary)", forHTTPHeaderField: "Content-Type")
-        if let byteSize = (try? formDataFile.url.resourceValues(forKeys: [.fileSizeKey]))?.fileSize {
-            request.setValue("\(byteSize)", forHTTPHeaderField: "Content-Length")
-        }
-        task = urlSession.uploadTask(with: request, fromFile: formDataFile.url) { data, response, error in
+        request.setValue("multipart/form-data; boundary=\(body.boundary)", forHTTPHeaderField: "Content-Type")
+        request.setValue("\(body.contentLength)", forHTTPHeaderField: "Content-Length")
+        request.httpBodyStream = body.makeInputStream()
+        task = urlSession.dataTask(with: request) { data, response, error in
+            if let task = self.task {
+                self.bodies.remove(forTaskIdentifier: task.taskIdentifier)
+            }
+
             if let error = error {
                 return self.finish(.failure(error))
             }
@@ -177,7 +194,13 @@ internal final class UploadImageAsFormData: AsynchronousOperation<ImgurUploader.
                 rateLimit: ImgurUploader.RateLimit(headers))))
         }
 
+        if let task = task {
+            bodies.set(body, forTaskIdentifier: task.taskIdentifier)
+            progress?.addChild(task.progress, withPendingUnitCount: pendingUnitCount)
+        }
+
         log(.debug, "starting \(self) with url \(request.url as Any)")
+        willSend?()
         task?.resume()
     }
 
@@ -187,6 +210,39 @@ internal final class UploadImageAsFormData: AsynchronousOperation<ImgurUploader.
     }
 }
 
+/**
+ A URL session delegate that hands over a fresh stream of an upload's body whenever the session needs to send it again, e.g. after a redirect, an authentication challenge, or a connection dropped partway through the body.
+
+ A streamed body can only be read once, so without this those uploads would fail.
+ */
+internal final class StreamedUploadBodies: NSObject, URLSessionTaskDelegate {
+    private let lock = NSLock()
+    private var bodies: [Int: MultipartFormDataBody] = [:]
+
+    func set(_ body: MultipartFormDataBody, forTaskIdentifier taskIdentifier: Int) {
+        lock.lock()
+        defer { lock.unlock() }
+        bodies[taskIdentifier] = body
+    }
+
+    func remove(forTaskIdentifier taskIdentifier: Int) {
+        lock.lock()
+        defer { lock.unlock() }
+        bodies[taskIdentifier] = nil
+    }
+
+    func urlSession(_ session: URLSession, task: URLSessionTask, needNewBodyStream completionHandler: @escaping (InputStream?) -> Void) {
+        lock.lock()
+        let body = bodies[task.taskIdentifier]
+        lock.unlock()
+
+        if body == nil {
+            log(.error, "no body to resend for \(task)")
+        }
+        completionHandler(body?.makeInputStream())
+    }
+}
+
 private extension ImgurUploader.PostLimit {
     init?(_ headers: [String: Any]) {
         guard
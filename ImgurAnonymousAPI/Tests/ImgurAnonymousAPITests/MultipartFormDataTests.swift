@@ -0,0 +1,79 @@
+// Public domain. https://github.com/nolanw/ImgurAnonymousAPI
+
+@testable import ImgurAnonymousAPI
+import XCTest
+
+final class MultipartFormDataTests: XCTestCase {
+    private var fileURL: URL!
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+        fileURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: fileURL)
+        try super.tearDownWithError()
+    }
+
+    /// Spans a few chunks, and doesn't end on a chunk boundary.
+    private func makeBody() throws -> (body: MultipartFormDataBody, expected: Data) {
+        let image = Data((0 ..< MultipartFormDataBody.chunkSize * 3 + 123).map { UInt8(truncatingIfNeeded: $0 * 7) })
+        try image.write(to: fileURL)
+        let head = Data("--boundary\r\nContent-Type: image/png\r\n\r\n".utf8)
+        let tail = Data("\r\n--boundary--".utf8)
+        let body = MultipartFormDataBody(boundary: "boundary", head: head, fileURL: fileURL, tail: tail, contentLength: head.count + image.count + tail.count)
+        return (body, head + image + tail)
+    }
+
+    func testStreamedBodyIsHeadThenFileThenTail() throws {
+        let (body, expected) = try makeBody()
+        let streamed = readAll(body.makeInputStream())
+        XCTAssertEqual(streamed.count, body.contentLength)
+        XCTAssertEqual(streamed, expected)
+    }
+
+    func testEachStreamStartsFromTheTop() throws {
+        let (body, expected) = try makeBody()
+
+        // Abandon one partway through, as URLSession does before asking for a new stream.
+        let first = body.makeInputStream()
+        first.open()
+        var buffer = [UInt8](repeating: 0, count: 1000)
+        XCTAssertGreaterThan(first.read(&buffer, maxLength: buffer.count), 0)
+        first.close()
+
+        XCTAssertEqual(readAll(body.makeInputStream()), expected)
+    }
+
+    func testSessionDelegateResendsRegisteredBody() throws {
+        let (body, expected) = try makeBody()
+        let bodies = StreamedUploadBodies()
+        let session = URLSession(configuration: .ephemeral)
+        defer { session.invalidateAndCancel() }
+        let task = session.dataTask(with: URL(string: "https://example.com")!)
+
+        bodies.set(body, forTaskIdentifier: task.taskIdentifier)
+        var resent: InputStream?
+        bodies.urlSession(session, task: task, needNewBodyStream: { resent = $0 })
+        XCTAssertEqual(try readAll(XCTUnwrap(resent)), expected)
+
+        bodies.remove(forTaskIdentifier: task.taskIdentifier)
+        var afterRemoval: InputStream?
+        bodies.urlSession(session, task: task, needNewBodyStream: { afterRemoval = $0 })
+        XCTAssertNil(afterRemoval)
+    }
+
+    private func readAll(_ stream: InputStream) -> Data {
+        stream.open()
+        defer { stream.close() }
+        var data = Data()
+        var buffer = [UInt8](repeating: 0, count: 4096)
+        while true {
+            let count = stream.read(&buffer, maxLength: buffer.count)
+            if count <= 0 { break }
+            data.append(buffer, count: count)
+        }
+        return data
+    }
+}
@@ -26,6 +26,16 @@
 @property (readonly, strong, nonatomic) SmilieDataStore *dataStore;
 @property (readonly, strong, nonatomic) NSURLSession *URLSession;
 
+/**
+ * How many images to download at once. Smilies that share an image URL share a download. Default is 4.
+ */
+@property (assign, nonatomic) NSUInteger maxConcurrentDownloads;
+
+/**
+ * How many downloaded images to save at a time. Saving as we go (and when cancelled) means an interrupted refresh picks up where it left off, as the next operation only downloads images that are still missing. Default is 50.
+ */
+@property (assign, nonatomic) NSUInteger saveBatchSize;
+
 @end
 
 /**
@@ -101,7 +101,13 @@
 
 @property (strong, nonatomic) NSManagedObjectContext *context;
 @property (strong, nonatomic) NSURLSession *URLSession;
-@property (strong, nonatomic) NSMutableArray *tasks;
+@property (strong, nonatomic) NSMutableSet *tasks;
+
+// The rest are only touched on the context's queue.
+@property (strong, nonatomic) NSMutableArray *pendingURLs;
+@property (strong, nonatomic) NSDictionary *smilieIDsByURL;
+@property (assign, nonatomic) NSUInteger downloadingCount;
+@property (assign, nonatomic) NSUInteger unsavedCount;
 
 @end
 
@@ -115,6 +121,8 @@
     if ((self = [super init])) {
         _dataStore = dataStore;
         _URLSession = URLSession;
+        _maxConcurrentDownloads = 4;
+        _saveBatchSize = 50;
     }
     return self;
 }
@@ -155,12 +163,14 @@
     return _context;
 }
 
-- (NSMutableArray *)tasks
+- (NSMutableSet *)tasks
 {
-    if (!_tasks) {
-        _tasks = [NSMutableArray new];
+    @synchronized (self) {
+        if (!_tasks) {
+            _tasks = [NSMutableSet new];
+        }
+        return _tasks;
     }
-    return _tasks;
 }
 
 - (void)start
@@ -185,56 +195,94 @@
             NSLog(@"%s error fetching: %@", __PRETTY_FUNCTION__, error);
         }
         
-        [self downloadImageDataForSmilies:results];
+        // Smilies can share an image, so download each URL once.
+        NSMutableDictionary *smilieIDsByURL = [NSMutableDictionary new];
+        for (Smilie *smilie in results) {
+            NSURL *URL = [NSURL URLWithString:smilie.imageURL];
+            if (!URL) continue;
+            NSMutableArray *objectIDs = smilieIDsByURL[URL];
+            if (!objectIDs) {
+                objectIDs = [NSMutableArray new];
+                smilieIDsByURL[URL] = objectIDs;
+            }
+            [objectIDs addObject:smilie.objectID];
+        }
+        self.smilieIDsByURL = smilieIDsByURL;
+        self.pendingURLs = [smilieIDsByURL.allKeys mutableCopy];
+        
+        NSUInteger concurrency = MAX(self.maxConcurrentDownloads, 1);
+        for (NSUInteger i = 0; i < concurrency; i++) {
+            [self startNextDownload];
+        }
     }];
 }
 
-- (void)downloadImageDataForSmilies:(NSArray *)smilies
+// Call on the context's queue.
+- (void)startNextDownload
 {
     if (self.cancelled) {
         return;
     }
     
-    if (smilies.count == 0) {
-        [self finish];
+    NSURL *URL = self.pendingURLs.lastObject;
+    if (!URL) {
+        if (self.downloadingCount == 0) {
+            [self saveThen:^{
+                [self finish];
+            }];
+        }
         return;
     }
+    [self.pendingURLs removeLastObject];
     
-    for (Smilie *smilie in smilies) {
-        NSURL *URL = [NSURL URLWithString:smilie.imageURL];
-        __block NSURLSessionDataTask *task = [self.URLSession dataTaskWithURL:URL completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
-            if (error) {
-                NSLog(@"%s image download error: %@", __PRETTY_FUNCTION__, error);
-                [self taskDidComplete:task];
+    self.downloadingCount++;
+    __block NSURLSessionDataTask *task = [self.URLSession dataTaskWithURL:URL completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        @synchronized (self) {
+            [self.tasks removeObject:task];
+        }
+        
+        [self.context performBlock:^{
+            self.downloadingCount--;
+            if (self.cancelled) {
                 return;
             }
             
-            if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
-                NSHTTPURLResponse *HTTPResponse = (NSHTTPURLResponse *)response;
-                NSInteger statusCode = HTTPResponse.statusCode;
-                if (statusCode < 200 || statusCode >= 300) {
-                    NSLog(@"%s image download bad response: %@", __PRETTY_FUNCTION__, HTTPResponse);
-                    [self taskDidComplete:task];
-                    return;
-                }
-            }
-            
-            [smilie.managedObjectContext performBlock:^{
-                if (self.cancelled) {
-                    return;
-                }
-                
-                smilie.imageData = data;
-                UpdateSmilieImageDataDerivedAttributes(smilie);
-                
-                // The session's delegateQueue will be a serial queue, so let's (ab)use it to thread-safe calls to -taskDidComplete:.
-                [self.URLSession.delegateQueue addOperationWithBlock:^{
-                    [self taskDidComplete:task];
-                }];
-            }];
+            [self didDownloadData:data response:response error:error fromURL:URL];
+            [self startNextDownload];
         }];
+    }];
+    @synchronized (self) {
         [self.tasks addObject:task];
-        [task resume];
+    }
+    [task resume];
+}
+
+// Call on the context's queue.
+- (void)didDownloadData:(NSData *)data response:(NSURLResponse *)response error:(NSError *)error fromURL:(NSURL *)URL
+{
+    if (error) {
+        NSLog(@"%s image download error: %@", __PRETTY_FUNCTION__, error);
+        return;
+    }
+    
+    if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
+        NSHTTPURLResponse *HTTPResponse = (NSHTTPURLResponse *)response;
+        NSInteger statusCode = HTTPResponse.statusCode;
+        if (statusCode < 200 || statusCode >= 300) {
+            NSLog(@"%s image download bad response: %@", __PRETTY_FUNCTION__, HTTPResponse);
+            return;
+        }
+    }
+    
+    for (NSManagedObjectID *objectID in self.smilieIDsByURL[URL]) {
+        Smilie *smilie = (Smilie *)[self.context objectWithID:objectID];
+        smilie.imageData = data;
+        UpdateSmilieImageDataDerivedAttributes(smilie);
+    }
+    
+    self.unsavedCount++;
+    if (self.unsavedCount >= self.saveBatchSize) {
+        [self saveThen:nil];
     }
 }
 
@@ -242,9 +290,14 @@ void UpdateSmilieImageDataDerivedAttributes(Smilie *smilie)
 {
     CGFloat width = 0, height = 0;
     CGImageSourceRef imageSource = CGImageSourceCreateWithData((CFDataRef)smilie.imageData, nil);
+    if (!imageSource) return;
     smilie.imageUTI = (NSString *)CGImageSourceGetType(imageSource);
     
     CFDictionaryRef imageProperties = CGImageSourceCopyPropertiesAtIndex(imageSource, 0, nil);
+    if (!imageProperties) {
+        CFRelease(imageSource);
+        return;
+    }
     CFNumberRef boxedWidth = CFDictionaryGetValue(imageProperties, kCGImagePropertyPixelWidth);
     if (boxedWidth) CFNumberGetValue(boxedWidth, kCFNumberCGFloatType, &width);
     CFNumberRef boxedHeight = CFDictionaryGetValue(imageProperties, kCGImagePropertyPixelHeight);
@@ -262,42 +315,62 @@ void UpdateSmilieImageDataDerivedAttributes(Smilie *smilie)
     CFRelease(imageSource);
 }
 
-- (void)taskDidComplete:(NSURLSessionDataTask *)task
+/**
+ Saves to the store, then calls completion (if any) once the parent context (on the main queue) has saved too. Call on the context's queue.
+ 
+ Saving every so often, rather than once per image, keeps the main queue free for the keyboard.
+ */
+- (void)saveThen:(void (^)(void))completion
 {
-    if (self.cancelled) {
+    self.unsavedCount = 0;
+    if (!self.context.hasChanges) {
+        if (completion) completion();
         return;
     }
     
-    [self.tasks removeObject:task];
-    
-    if (self.tasks.count == 0) {
-        [self.context performBlock:^{
-            if (self.context.hasChanges) {
-                NSError *error;
-                if (![self.context save:&error]) {
-                    NSLog(@"%s error saving: %@", __PRETTY_FUNCTION__, error);
-                } else {
-                    if (![self.dataStore.managedObjectContext save:&error]) {
-                        NSLog(@"%s error saving parent: %@", __PRETTY_FUNCTION__, error);
-                    }
-                }
-            }
-            [self finish];
-        }];
+    NSError *error;
+    if (![self.context save:&error]) {
+        NSLog(@"%s error saving: %@", __PRETTY_FUNCTION__, error);
+        if (completion) completion();
+        return;
     }
+    
+    NSManagedObjectContext *parentContext = self.dataStore.managedObjectContext;
+    [parentContext performBlock:^{
+        NSError *error;
+        if (![parentContext save:&error]) {
+            NSLog(@"%s error saving parent: %@", __PRETTY_FUNCTION__, error);
+        }
+        if (completion) completion();
+    }];
 }
 
 - (void)finish
 {
+    if (self.finished) return;
     self.executing = NO;
     self.finished = YES;
 }
 
 - (void)cancel
 {
-    [self.tasks makeObjectsPerformSelector:@selector(cancel)];
-    [self finish];
+    NSArray *tasks;
+    @synchronized (self) {
+        tasks = self.tasks.allObjects;
+    }
+    [tasks makeObjectsPerformSelector:@selector(cancel)];
     [super cancel];
+    
+    if (self.executing) {
+        // Keep whatever we've downloaded so far for next time.
+        [self.context performBlock:^{
+            [self saveThen:^{
+                [self finish];
+            }];
+        }];
+    } else {
+        [self finish];
+    }
 }
 
 @end
@@ -411,6 +484,22 @@ void UpdateSmilieImageDataDerivedAttributes(Smilie *smilie)
     if (self.cancelled) return;
     
     [self.context performBlockAndWait:^{
+        // Fetch every smilie once up front, rather than once per scraped smilie. Leave them as faults so we don't pull every image into memory just to check some strings.
+        NSMutableDictionary *existingSmiliesByText = [NSMutableDictionary new];
+        {{
+            NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:[Smilie entityName]];
+            NSError *error;
+            NSArray *results = [self.context executeFetchRequest:fetchRequest error:&error];
+            if (!results) {
+                NSLog(@"%s error fetching existing smilies: %@", __PRETTY_FUNCTION__, error);
+            }
+            for (Smilie *smilie in results) {
+                if (smilie.text && !existingSmiliesByText[smilie.text]) {
+                    existingSmiliesByText[smilie.text] = smilie;
+                }
+            }
+        }}
+        
         // First, update section names for all existing smilies
         [headers enumerateObjectsUsingBlock:^(HTMLElement *header, NSUInteger i, BOOL *stop) {
             if (self.cancelled) return;
@@ -422,14 +511,8 @@ void UpdateSmilieImageDataDerivedAttributes(Smilie *smilie)
                 NSString *text = [item firstNodeMatchingSelector:@".text"].textContent;
                 
                 // Update existing smilie's section if it has changed
-                NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:[Smilie entityName]];
-                fetchRequest.predicate = [NSPredicate predicateWithFormat:@"text = %@", text];
-                fetchRequest.fetchLimit = 1;
-                NSError *error;
-                NSArray *existingSmilies = [self.context executeFetchRequest:fetchRequest error:&error];
-                
-                if (existingSmilies.count > 0) {
-                    Smilie *existingSmilie = existingSmilies.firstObject;
+                Smilie *existingSmilie = text ? existingSmiliesByText[text] : nil;
+                if (existingSmilie) {
                     HTMLElement *img = [item firstNodeMatchingSelector:@"img"];
                     NSString *imageURL = img[@"src"];
                     NSString *summary = img[@"title"];
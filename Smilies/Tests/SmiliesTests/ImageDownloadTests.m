@@ -10,6 +10,9 @@
 
 @interface FixtureWebArchiveURLProtocol : NSURLProtocol
 
++ (NSUInteger)requestCount;
++ (void)resetRequestCount;
+
 @end
 
 @implementation ImageDownloadTests
@@ -59,6 +62,42 @@
     XCTAssertNotNil(realColbert.imageData);
 }
 
+- (void)testSharedImageURLDownloadsOnce
+{
+    SmilieDataStore *dataStore = [TestDataStore new];
+    NSMutableArray *smilies = [NSMutableArray new];
+    for (NSString *text in @[@"!one!", @"!two!", @"!three!"]) {
+        Smilie *smilie = [Smilie newInManagedObjectContext:dataStore.managedObjectContext];
+        smilie.text = text;
+        smilie.imageURL = @"https://i.somethingawful.com/forumsystem/emoticons/emot-backtowork.gif";
+        [smilies addObject:smilie];
+    }
+    Smilie *other = [Smilie newInManagedObjectContext:dataStore.managedObjectContext];
+    other.text = @"!other!";
+    other.imageURL = @"https://i.somethingawful.com/forumsystem/emoticons/emot-crossarms.gif";
+    [smilies addObject:other];
+    NSError *error;
+    if (![dataStore.managedObjectContext save:&error]) {
+        NSAssert(NO, @"error saving new smilies: %@", error);
+    }
+    
+    [FixtureWebArchiveURLProtocol resetRequestCount];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"downloading image data"];
+    SmilieDownloadMissingImageDataOperation *operation = [[SmilieDownloadMissingImageDataOperation alloc] initWithDataStore:dataStore URLSession:nil];
+    operation.maxConcurrentDownloads = 2;
+    operation.saveBatchSize = 1;
+    operation.completionBlock = ^{
+        [expectation fulfill];
+    };
+    [operation start];
+    [self waitForExpectationsWithTimeout:1 handler:nil];
+    
+    XCTAssertEqual([FixtureWebArchiveURLProtocol requestCount], 2U);
+    for (Smilie *smilie in smilies) {
+        XCTAssertNotNil(smilie.imageData, @"%@", smilie.text);
+    }
+}
+
 @end
 
 @interface FixtureWebArchiveURLProtocol ()
@@ -79,6 +118,22 @@
     return webArchive;
 }
 
+static NSUInteger gRequestCount;
+
++ (NSUInteger)requestCount
+{
+    @synchronized (self) {
+        return gRequestCount;
+    }
+}
+
++ (void)resetRequestCount
+{
+    @synchronized (self) {
+        gRequestCount = 0;
+    }
+}
+
 + (BOOL)canInitWithRequest:(NSURLRequest *)request
 {
     return YES;
@@ -91,6 +146,9 @@
 
 - (void)startLoading
 {
+    @synchronized ([self class]) {
+        gRequestCount++;
+    }
     NSData *data = [[[self class] webArchive] dataForSubresourceWithURL:self.request.URL];
     NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL
                                                               statusCode:(data ? 200 : 404)